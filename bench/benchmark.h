@@ -0,0 +1,266 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_BENCHMARK_H
+#define DUPLICATION_CHECKER_BENCHMARK_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <iostream>
+#include <ostream>
+#include <streambuf>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Time functions several times and report results in JSON.
+     * Each function returns a value depending on the work done so that
+     * compiler cannot remove it, value is reported as checksum
+     */
+    class benchmark
+    {
+      public:
+
+        inline explicit
+        benchmark(unsigned int p_nb_repetitions);
+
+        /**
+         * Describe conditions of measures, reported in JSON
+         */
+        inline
+        void
+        add_parameter(const std::string & p_name
+                     ,uint64_t p_value
+                     );
+
+        inline
+        void
+        add_parameter(const std::string & p_name
+                     ,const std::string & p_value
+                     );
+
+        /**
+         * Time p_func which performs p_nb_operations operations
+         */
+        inline
+        void
+        run(const std::string & p_name
+           ,uint64_t p_nb_operations
+           ,const std::function<uint64_t()> & p_func
+           );
+
+        inline
+        void
+        write_json(std::ostream & p_stream) const;
+
+      private:
+
+        class result
+        {
+          public:
+
+            std::string m_name;
+            uint64_t m_nb_operations;
+            std::vector<uint64_t> m_durations;
+            uint64_t m_checksum;
+        };
+
+        static inline
+        std::string
+        quote(const std::string & p_string);
+
+        unsigned int m_nb_repetitions;
+
+        /**
+         * Parameter names and JSON values
+         */
+        std::vector<std::pair<std::string, std::string>> m_parameters;
+
+        std::vector<result> m_results;
+    };
+
+    //-------------------------------------------------------------------------
+    benchmark::benchmark(unsigned int p_nb_repetitions)
+    :m_nb_repetitions{std::max(p_nb_repetitions, 1u)}
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    benchmark::add_parameter(const std::string & p_name
+                            ,uint64_t p_value
+                            )
+    {
+        m_parameters.emplace_back(p_name, std::to_string(p_value));
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    benchmark::add_parameter(const std::string & p_name
+                            ,const std::string & p_value
+                            )
+    {
+        m_parameters.emplace_back(p_name, quote(p_value));
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    benchmark::run(const std::string & p_name
+                  ,uint64_t p_nb_operations
+                  ,const std::function<uint64_t()> & p_func
+                  )
+    {
+        result l_result{p_name, p_nb_operations, {}, 0};
+        for(unsigned int l_repetition = 0; l_repetition < m_nb_repetitions; ++l_repetition)
+        {
+            std::chrono::steady_clock::time_point l_start = std::chrono::steady_clock::now();
+            l_result.m_checksum = p_func();
+            l_result.m_durations.emplace_back((uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - l_start).count());
+        }
+        std::sort(l_result.m_durations.begin(), l_result.m_durations.end());
+        std::cerr << p_name << " : " << l_result.m_durations.front() << " ns" << std::endl;
+        m_results.emplace_back(std::move(l_result));
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    benchmark::write_json(std::ostream & p_stream) const
+    {
+        p_stream << "{\n  \"parameters\": {";
+        for(size_t l_index = 0; l_index < m_parameters.size(); ++l_index)
+        {
+            p_stream << (l_index ? "," : "") << "\n    " << quote(m_parameters[l_index].first) << ": " << m_parameters[l_index].second;
+        }
+        p_stream << "\n  },\n  \"results\": [";
+        for(size_t l_index = 0; l_index < m_results.size(); ++l_index)
+        {
+            const result & l_result = m_results[l_index];
+            uint64_t l_min = l_result.m_durations.front();
+            uint64_t l_median = l_result.m_durations[l_result.m_durations.size() / 2];
+            double l_ns_per_op = l_result.m_nb_operations ? (double)l_min / (double)l_result.m_nb_operations : 0;
+            p_stream << (l_index ? "," : "") << "\n    {"
+                     << "\"name\": " << quote(l_result.m_name)
+                     << ", \"operations\": " << l_result.m_nb_operations
+                     << ", \"repetitions\": " << l_result.m_durations.size()
+                     << ", \"min_ns\": " << l_min
+                     << ", \"median_ns\": " << l_median
+                     << ", \"max_ns\": " << l_result.m_durations.back()
+                     << ", \"ns_per_op\": " << l_ns_per_op
+                     << ", \"checksum\": " << l_result.m_checksum
+                     << "}";
+        }
+        p_stream << "\n  ]\n}\n";
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    benchmark::quote(const std::string & p_string)
+    {
+        std::string l_result = "\"";
+        for(auto l_char: p_string)
+        {
+            if('"' == l_char || '\\' == l_char)
+            {
+                l_result += '\\';
+            }
+            l_result += l_char;
+        }
+        return l_result + "\"";
+    }
+
+    /**
+     * Discard everything written in a stream until destruction, restoring
+     * its buffer even if an exception is thrown
+     */
+    class stream_silencer
+    {
+      public:
+
+        inline explicit
+        stream_silencer(std::ostream & p_stream);
+
+        inline
+        ~stream_silencer();
+
+        stream_silencer(const stream_silencer &) = delete;
+        stream_silencer & operator=(const stream_silencer &) = delete;
+
+      private:
+
+        /**
+         * Accept and drop all characters
+         */
+        class null_streambuf: public std::streambuf
+        {
+          protected:
+
+            inline
+            int_type
+            overflow(int_type p_char) override;
+
+            inline
+            std::streamsize
+            xsputn(const char * p_data
+                  ,std::streamsize p_size
+                  ) override;
+        };
+
+        std::ostream & m_stream;
+
+        null_streambuf m_null_buffer;
+
+        std::streambuf * m_previous_buffer;
+    };
+
+    //-------------------------------------------------------------------------
+    stream_silencer::stream_silencer(std::ostream & p_stream)
+    :m_stream(p_stream)
+    ,m_previous_buffer{p_stream.rdbuf(&m_null_buffer)}
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    stream_silencer::~stream_silencer()
+    {
+        m_stream.rdbuf(m_previous_buffer);
+    }
+
+    //-------------------------------------------------------------------------
+    stream_silencer::null_streambuf::int_type
+    stream_silencer::null_streambuf::overflow(int_type p_char)
+    {
+        return traits_type::not_eof(p_char);
+    }
+
+    //-------------------------------------------------------------------------
+    std::streamsize
+    stream_silencer::null_streambuf::xsputn(const char *
+                                           ,std::streamsize p_size
+                                           )
+    {
+        return p_size;
+    }
+
+}
+#endif //DUPLICATION_CHECKER_BENCHMARK_H
+// EOF
@@ -0,0 +1,344 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_CORPUS_GENERATOR_H
+#define DUPLICATION_CHECKER_CORPUS_GENERATOR_H
+
+#include "rule.h"
+#include "sha1.h"
+#include "quicky_exception.h"
+#include <algorithm>
+#include <cstdint>
+#include <fstream>
+#include <random>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Generate a synthetic sorted_sha1sum.log and a config.xml whose rules
+     * refer to directories present in log. Same parameters and seed always
+     * produce same files
+     */
+    class corpus_generator
+    {
+      public:
+
+        /**
+         * @param p_group_sizes distribution of number of files sharing a
+         * SHA1 as comma separated size:weight couples, ex "1:80,2:15,5:5"
+         */
+        inline
+        corpus_generator(uint64_t p_nb_lines
+                        ,const std::string & p_group_sizes
+                        ,uint64_t p_nb_rules
+                        ,uint64_t p_nb_keep_only
+                        ,uint64_t p_nb_ignore_path
+                        ,uint64_t p_seed
+                        );
+
+        /**
+         * Write sorted_sha1sum.log and config.xml in p_dir which must exist
+         */
+        inline
+        void
+        generate(const std::string & p_dir);
+
+        /**
+         * Directories of each group having several files, available once
+         * corpus is generated
+         */
+        inline
+        const std::vector<std::vector<std::string>> &
+        get_duplicated_groups() const;
+
+        inline
+        uint64_t
+        get_nb_groups() const;
+
+      private:
+
+        /**
+         * Pick a directory, a few directories are much more used than others
+         * like in real trees
+         */
+        inline
+        std::string
+        pick_directory();
+
+        inline
+        void
+        write_log(const std::string & p_file_name);
+
+        inline
+        void
+        write_config(const std::string & p_file_name);
+
+        uint64_t m_nb_lines;
+
+        uint64_t m_nb_rules;
+
+        uint64_t m_nb_keep_only;
+
+        uint64_t m_nb_ignore_path;
+
+        std::vector<unsigned int> m_sizes;
+
+        std::discrete_distribution<size_t> m_size_distribution;
+
+        std::mt19937_64 m_random;
+
+        uint64_t m_nb_directories;
+
+        /**
+         * SHA1 text and files of each group
+         */
+        std::vector<std::pair<std::string, std::vector<std::string>>> m_groups;
+
+        std::vector<std::vector<std::string>> m_duplicated_groups;
+    };
+
+    //-------------------------------------------------------------------------
+    corpus_generator::corpus_generator(uint64_t p_nb_lines
+                                      ,const std::string & p_group_sizes
+                                      ,uint64_t p_nb_rules
+                                      ,uint64_t p_nb_keep_only
+                                      ,uint64_t p_nb_ignore_path
+                                      ,uint64_t p_seed
+                                      )
+    :m_nb_lines{p_nb_lines}
+    ,m_nb_rules{p_nb_rules}
+    ,m_nb_keep_only{p_nb_keep_only}
+    ,m_nb_ignore_path{p_nb_ignore_path}
+    ,m_random{p_seed}
+    ,m_nb_directories{std::max<uint64_t>(p_nb_lines / 16, 4)}
+    {
+        std::vector<double> l_weights;
+        size_t l_begin = 0;
+        while(l_begin < p_group_sizes.size())
+        {
+            size_t l_end = p_group_sizes.find(',', l_begin);
+            if(std::string::npos == l_end)
+            {
+                l_end = p_group_sizes.size();
+            }
+            std::string l_couple = p_group_sizes.substr(l_begin, l_end - l_begin);
+            size_t l_colon_pos = l_couple.find(':');
+            unsigned long l_size = 0;
+            double l_weight = 0;
+            try
+            {
+                l_size = std::stoul(l_couple.substr(0, l_colon_pos));
+                l_weight = std::string::npos == l_colon_pos ? 1 : std::stod(l_couple.substr(l_colon_pos + 1));
+            }
+            catch(const std::exception &)
+            {
+                l_size = 0;
+            }
+            if(!l_size || l_weight <= 0)
+            {
+                throw quicky_exception::quicky_logic_exception(R"(Invalid group size ")" + l_couple + R"(", expected size:weight)"
+                                                              ,__LINE__
+                                                              ,__FILE__
+                                                              );
+            }
+            m_sizes.emplace_back((unsigned int)l_size);
+            l_weights.emplace_back(l_weight);
+            l_begin = l_end + 1;
+        }
+        if(m_sizes.empty())
+        {
+            throw quicky_exception::quicky_logic_exception("Empty group size distribution"
+                                                          ,__LINE__
+                                                          ,__FILE__
+                                                          );
+        }
+        m_size_distribution = std::discrete_distribution<size_t>(l_weights.begin(), l_weights.end());
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    corpus_generator::generate(const std::string & p_dir)
+    {
+        m_groups.clear();
+        m_duplicated_groups.clear();
+        uint64_t l_nb_lines = 0;
+        while(l_nb_lines < m_nb_lines)
+        {
+            unsigned int l_size = (unsigned int)std::min<uint64_t>(m_sizes[m_size_distribution(m_random)], m_nb_lines - l_nb_lines);
+            uint64_t l_group_index = m_groups.size();
+            sha1 l_sha1;
+            l_sha1.update((const uint8_t *)&l_group_index, sizeof(l_group_index));
+            uint8_t l_digest[sha1::m_digest_size];
+            l_sha1.finalize(l_digest);
+            std::vector<std::string> l_files;
+            std::vector<std::string> l_directories;
+            for(unsigned int l_index = 0; l_index < l_size; ++l_index)
+            {
+                l_directories.emplace_back(pick_directory());
+                l_files.emplace_back(l_directories.back() + "/file_" + std::to_string(l_group_index) + "_" + std::to_string(l_index) + ".dat");
+            }
+            if(l_size > 1)
+            {
+                m_duplicated_groups.emplace_back(std::move(l_directories));
+            }
+            m_groups.emplace_back(sha1::to_string(l_digest), std::move(l_files));
+            l_nb_lines += l_size;
+        }
+        std::sort(m_groups.begin(), m_groups.end());
+        write_log(p_dir + "/sorted_sha1sum.log");
+        write_config(p_dir + "/config.xml");
+    }
+
+    //-------------------------------------------------------------------------
+    const std::vector<std::vector<std::string>> &
+    corpus_generator::get_duplicated_groups() const
+    {
+        return m_duplicated_groups;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    corpus_generator::get_nb_groups() const
+    {
+        return m_groups.size();
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    corpus_generator::pick_directory()
+    {
+        // Product of two uniform variables favours small directory indexes
+        std::uniform_real_distribution<double> l_distribution(0, 1);
+        uint64_t l_index = (uint64_t)(l_distribution(m_random) * l_distribution(m_random) * (double)m_nb_directories);
+        return "data/dir" + std::to_string(l_index / 32) + "/sub" + std::to_string(l_index % 32);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    corpus_generator::write_log(const std::string & p_file_name)
+    {
+        std::ofstream l_output(p_file_name, std::ios::binary | std::ios::trunc);
+        if(!l_output.is_open())
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error opening output file ")" + p_file_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        std::string l_buffer;
+        for(const auto & l_group: m_groups)
+        {
+            for(const auto & l_file: l_group.second)
+            {
+                l_buffer += l_group.first + "  " + l_file + "\n";
+            }
+            if(l_buffer.size() > 1024 * 1024)
+            {
+                l_output.write(l_buffer.data(), (std::streamsize)l_buffer.size());
+                l_buffer.clear();
+            }
+        }
+        l_output.write(l_buffer.data(), (std::streamsize)l_buffer.size());
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    corpus_generator::write_config(const std::string & p_file_name)
+    {
+        std::ofstream l_output(p_file_name, std::ios::binary | std::ios::trunc);
+        if(!l_output.is_open())
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error opening output file ")" + p_file_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        l_output << R"(<?xml version="1.0" encoding="UTF-8"?>)" << "\n<duplication_checker>\n";
+
+        // Rules target couples of directories really present in groups of
+        // 2 files so that they are hit, remaining ones are random couples
+        std::vector<const std::vector<std::string> *> l_couples;
+        std::vector<const std::vector<std::string> *> l_keep_only_groups;
+        for(const auto & l_group: m_duplicated_groups)
+        {
+            // Keep only rules cannot list a directory twice
+            std::vector<std::string> l_sorted(l_group);
+            std::sort(l_sorted.begin(), l_sorted.end());
+            if(l_sorted.end() != std::adjacent_find(l_sorted.begin(), l_sorted.end()))
+            {
+                continue;
+            }
+            if(2 == l_group.size())
+            {
+                l_couples.emplace_back(&l_group);
+            }
+            else
+            {
+                l_keep_only_groups.emplace_back(&l_group);
+            }
+        }
+        std::shuffle(l_couples.begin(), l_couples.end(), m_random);
+        std::shuffle(l_keep_only_groups.begin(), l_keep_only_groups.end(), m_random);
+
+        l_output << "<rules>\n";
+        const rule::t_rule_cmd l_cmds[] = {rule::t_rule_cmd::IGNORE, rule::t_rule_cmd::RM_FIRST, rule::t_rule_cmd::RM_SECOND, rule::t_rule_cmd::SKIP};
+        for(uint64_t l_index = 0; l_index < m_nb_rules; ++l_index)
+        {
+            std::string l_path_1;
+            std::string l_path_2;
+            if(l_index < l_couples.size())
+            {
+                l_path_1 = (*l_couples[l_index])[0];
+                l_path_2 = (*l_couples[l_index])[1];
+            }
+            else
+            {
+                l_path_1 = pick_directory();
+                l_path_2 = pick_directory() + "/missing";
+            }
+            l_output << R"(<rule cmd=")" << rule::to_string(l_cmds[l_index % 4]) << R"(" file1=")" << l_path_1 << R"(" file2=")" << l_path_2 << R"(" />)" << "\n";
+        }
+
+        // Keep first directory of groups with more than 2 files and remove
+        // others
+        for(uint64_t l_index = 0; l_index < m_nb_keep_only && l_index < l_keep_only_groups.size(); ++l_index)
+        {
+            const std::vector<std::string> & l_group = *l_keep_only_groups[l_index];
+            l_output << "<keep_only>\n<keep_list>\n" << R"(<keep path=")" << l_group[0] << R"(" />)" << "\n</keep_list>\n<remove_list>\n";
+            for(size_t l_path_index = 1; l_path_index < l_group.size(); ++l_path_index)
+            {
+                l_output << R"(<remove path=")" << l_group[l_path_index] << R"(" />)" << "\n";
+            }
+            l_output << "</remove_list>\n</keep_only>\n";
+        }
+        l_output << "</rules>\n";
+
+        l_output << "<path_ignore_list>\n";
+        for(uint64_t l_index = 0; l_index < m_nb_ignore_path; ++l_index)
+        {
+            l_output << R"(<ignore_path str=")" << pick_directory() << R"(/" />)" << "\n";
+        }
+        l_output << "</path_ignore_list>\n</duplication_checker>\n";
+    }
+
+}
+#endif //DUPLICATION_CHECKER_CORPUS_GENERATOR_H
+// EOF
@@ -0,0 +1,279 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#include "parameter_manager.h"
+#include "benchmark.h"
+#include "corpus_generator.h"
+#include "duplication_checker.h"
+#include <sys/stat.h>
+#include <unistd.h>
+#include <fstream>
+#include <memory>
+#include <thread>
+
+int main(int argc,char ** argv)
+{
+    try
+    {
+        // Defining application command line parameters
+        parameter_manager::parameter_manager l_param_manager("duplication_checker_bench.exe", "--", 0);
+        parameter_manager::parameter_if l_work_dir_param("work_dir", true);
+        l_param_manager.add(l_work_dir_param);
+        parameter_manager::parameter_if l_output_param("output", true);
+        l_param_manager.add(l_output_param);
+        parameter_manager::parameter_if l_lines_param("lines", true);
+        l_param_manager.add(l_lines_param);
+        parameter_manager::parameter_if l_group_sizes_param("group_sizes", true);
+        l_param_manager.add(l_group_sizes_param);
+        parameter_manager::parameter_if l_rules_param("rules", true);
+        l_param_manager.add(l_rules_param);
+        parameter_manager::parameter_if l_keep_only_param("keep_only", true);
+        l_param_manager.add(l_keep_only_param);
+        parameter_manager::parameter_if l_ignore_path_param("ignore_path", true);
+        l_param_manager.add(l_ignore_path_param);
+        parameter_manager::parameter_if l_seed_param("seed", true);
+        l_param_manager.add(l_seed_param);
+        parameter_manager::parameter_if l_repetitions_param("repetitions", true);
+        l_param_manager.add(l_repetitions_param);
+        parameter_manager::parameter_if l_nb_threads_param("nb_threads", true);
+        l_param_manager.add(l_nb_threads_param);
+
+        // Treating parameters
+        l_param_manager.treat_parameters(argc,argv);
+
+        std::string l_work_dir = l_work_dir_param.value_set() ? l_work_dir_param.get_value<std::string>() : "bench_corpus";
+        std::string l_output_name = l_output_param.value_set() ? l_output_param.get_value<std::string>() : "bench.json";
+        uint64_t l_nb_lines = l_lines_param.value_set() ? l_lines_param.get_value<uint64_t>() : 1000000;
+        std::string l_group_sizes = l_group_sizes_param.value_set() ? l_group_sizes_param.get_value<std::string>() : "1:80,2:15,3:3,8:2";
+        uint64_t l_nb_rules = l_rules_param.value_set() ? l_rules_param.get_value<uint64_t>() : 10000;
+        uint64_t l_nb_keep_only = l_keep_only_param.value_set() ? l_keep_only_param.get_value<uint64_t>() : 1000;
+        uint64_t l_nb_ignore_path = l_ignore_path_param.value_set() ? l_ignore_path_param.get_value<uint64_t>() : 100;
+        uint64_t l_seed = l_seed_param.value_set() ? l_seed_param.get_value<uint64_t>() : 1;
+        unsigned int l_nb_repetitions = l_repetitions_param.value_set() ? l_repetitions_param.get_value<unsigned int>() : 5;
+        unsigned int l_nb_threads = l_nb_threads_param.value_set() ? l_nb_threads_param.get_value<unsigned int>() : std::thread::hardware_concurrency();
+
+        // Output is opened before moving to work directory so that its path
+        // is relative to directory where benchmark is launched
+        std::ofstream l_output(l_output_name);
+        if(!l_output.is_open())
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error opening output file ")" + l_output_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        mkdir(l_work_dir.c_str(), 0755);
+        if(chdir(l_work_dir.c_str()))
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Cannot use work directory ")" + l_work_dir + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+
+        duplication_checker::corpus_generator l_generator(l_nb_lines, l_group_sizes, l_nb_rules, l_nb_keep_only, l_nb_ignore_path, l_seed);
+        l_generator.generate(".");
+
+        duplication_checker::benchmark l_benchmark(l_nb_repetitions);
+        l_benchmark.add_parameter("lines", l_nb_lines);
+        l_benchmark.add_parameter("groups", l_generator.get_nb_groups());
+        l_benchmark.add_parameter("group_sizes", l_group_sizes);
+        l_benchmark.add_parameter("rules", l_nb_rules);
+        l_benchmark.add_parameter("keep_only", l_nb_keep_only);
+        l_benchmark.add_parameter("ignore_path", l_nb_ignore_path);
+        l_benchmark.add_parameter("seed", l_seed);
+        l_benchmark.add_parameter("nb_threads", l_nb_threads);
+
+        // Configuration parsing
+        duplication_checker::rule_set l_rules;
+        duplication_checker::keep_only_set l_keep_only;
+        duplication_checker::sha1_ignore_list l_sha1_ignore_list;
+        std::set<std::string> l_path_ignore_list;
+        {
+            duplication_checker::config_parser l_parser(l_rules, l_sha1_ignore_list, l_keep_only, l_path_ignore_list);
+            l_parser.parse("config.xml");
+        }
+        l_benchmark.run("config_parser::parse"
+                       ,l_rules.size() + l_keep_only.size() + l_path_ignore_list.size()
+                       ,[&]() -> uint64_t
+                        {
+                            duplication_checker::rule_set l_parsed_rules;
+                            duplication_checker::keep_only_set l_parsed_keep_only;
+                            duplication_checker::sha1_ignore_list l_parsed_sha1_ignore_list;
+                            std::set<std::string> l_parsed_path_ignore_list;
+                            duplication_checker::config_parser l_parser(l_parsed_rules, l_parsed_sha1_ignore_list, l_parsed_keep_only, l_parsed_path_ignore_list);
+                            l_parser.parse("config.xml");
+                            return l_parsed_rules.size() + l_parsed_keep_only.size() + l_parsed_path_ignore_list.size();
+                        }
+                       );
+
+        // Rules are queried with their couple of paths and reversed couple
+        std::vector<const rule *> l_rule_list;
+        std::vector<std::pair<std::string, std::string>> l_rule_queries;
+        for(const auto & l_iter: l_rules)
+        {
+            l_rule_list.emplace_back(&l_iter);
+            l_rule_list.emplace_back(&l_iter);
+            l_rule_queries.emplace_back(l_iter.get_path_1(), l_iter.get_path_2());
+            l_rule_queries.emplace_back(l_iter.get_path_2(), l_iter.get_path_1());
+        }
+        l_benchmark.run("rule::match"
+                       ,l_rule_queries.size()
+                       ,[&]() -> uint64_t
+                        {
+                            uint64_t l_nb_match = 0;
+                            for(size_t l_index = 0; l_index < l_rule_queries.size(); ++l_index)
+                            {
+                                l_nb_match += l_rule_list[l_index]->match(l_rule_queries[l_index].first, l_rule_queries[l_index].second);
+                            }
+                            return l_nb_match;
+                        }
+                       );
+        l_benchmark.run("rule_set::find"
+                       ,l_rule_queries.size()
+                       ,[&]() -> uint64_t
+                        {
+                            uint64_t l_nb_match = 0;
+                            for(const auto & l_iter: l_rule_queries)
+                            {
+                                l_nb_match += nullptr != l_rules.find(l_iter.first, l_iter.second);
+                            }
+                            return l_nb_match;
+                        }
+                       );
+
+        // Keep only rules are queried with their paths and with a list where
+        // a path is replaced
+        std::vector<const duplication_checker::keep_only *> l_keep_only_list;
+        std::vector<std::vector<std::string>> l_keep_only_queries;
+        std::function<void(const std::string &)> l_add_path = [&](const std::string & p_path) -> void
+        {
+            l_keep_only_queries.back().emplace_back(p_path);
+        };
+        for(const auto & l_iter: l_keep_only)
+        {
+            l_keep_only_queries.emplace_back();
+            l_iter.apply_to_keep(l_add_path);
+            l_iter.apply_to_remove(l_add_path);
+            l_keep_only_queries.emplace_back(l_keep_only_queries.back());
+            l_keep_only_queries.back().back() += "/missing";
+            l_keep_only_list.emplace_back(&l_iter);
+            l_keep_only_list.emplace_back(&l_iter);
+        }
+        l_benchmark.run("keep_only::match"
+                       ,l_keep_only_queries.size()
+                       ,[&]() -> uint64_t
+                        {
+                            uint64_t l_nb_match = 0;
+                            for(size_t l_index = 0; l_index < l_keep_only_queries.size(); ++l_index)
+                            {
+                                l_nb_match += l_keep_only_list[l_index]->match(l_keep_only_queries[l_index]);
+                            }
+                            return l_nb_match;
+                        }
+                       );
+        l_benchmark.run("keep_only_set::find"
+                       ,l_generator.get_duplicated_groups().size()
+                       ,[&]() -> uint64_t
+                        {
+                            uint64_t l_nb_match = 0;
+                            for(const auto & l_iter: l_generator.get_duplicated_groups())
+                            {
+                                l_nb_match += nullptr != l_keep_only.find(l_iter);
+                            }
+                            return l_nb_match;
+                        }
+                       );
+
+        // Item construction from lines of log
+        duplication_checker::log_reader l_reader("sorted_sha1sum.log");
+        std::vector<std::pair<duplication_checker::text_view, duplication_checker::text_view>> l_lines;
+        duplication_checker::text_view l_line;
+        while(l_reader.get_line(l_line))
+        {
+            size_t l_space_pos = l_line.find(' ');
+            if(std::string::npos != l_space_pos)
+            {
+                l_lines.emplace_back(l_line.substr(0, l_space_pos), l_line.substr(l_space_pos + 2));
+            }
+        }
+        l_benchmark.run("item"
+                       ,l_lines.size()
+                       ,[&]() -> uint64_t
+                        {
+                            duplication_checker::path_table l_path_table;
+                            std::vector<item> l_items;
+                            l_items.reserve(l_lines.size());
+                            for(const auto & l_iter: l_lines)
+                            {
+                                l_items.emplace_back(l_iter.first, l_iter.second, l_path_table);
+                            }
+                            return l_items.size();
+                        }
+                       );
+
+        // Digests computed on a buffer, operations are bytes
+        std::vector<uint8_t> l_buffer(16 * 1024 * 1024);
+        for(size_t l_index = 0; l_index < l_buffer.size(); ++l_index)
+        {
+            l_buffer[l_index] = (uint8_t)(l_index % 251);
+        }
+        for(auto l_digest_type: {duplication_checker::digest_type::SHA1, duplication_checker::digest_type::BLAKE3})
+        {
+            l_benchmark.run("digest::" + duplication_checker::to_string(l_digest_type)
+                           ,l_buffer.size()
+                           ,[&]() -> uint64_t
+                            {
+                                duplication_checker::digest l_digest(l_digest_type);
+                                l_digest.update(l_buffer.data(), l_buffer.size());
+                                uint8_t l_result[duplication_checker::digest::m_max_size];
+                                l_digest.finalize(l_result);
+                                return l_result[0];
+                            }
+                           );
+        }
+
+        // Complete processing, messages of checker are not displayed
+        l_benchmark.run("duplication_checker::run"
+                       ,l_nb_lines
+                       ,[&]() -> uint64_t
+                        {
+                            {
+                                duplication_checker::stream_silencer l_silencer(std::cout);
+                                duplication_checker::duplication_checker l_checker(".", false, false, (size_t)1024 * 1024 * 1024, l_nb_threads);
+                                l_checker.run();
+                            }
+                            struct stat l_stat;
+                            return stat("clean_cmd.bash", &l_stat) ? 0 : (uint64_t)l_stat.st_size;
+                        }
+                       );
+
+        l_benchmark.write_json(l_output);
+    }
+    catch(const quicky_exception::quicky_logic_exception & e)
+    {
+        std::cout << "ERROR : " << e.what() << " from " << e.get_file() << ":" << e.get_line() << std::endl;
+        return -1;
+    }
+    catch(const quicky_exception::quicky_runtime_exception & e)
+    {
+        std::cout << "ERROR : " << e.what() << " from " << e.get_file() << ":" << e.get_line() << std::endl;
+        return -1;
+    }
+    return 0;
+}
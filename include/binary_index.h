@@ -0,0 +1,559 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_BINARY_INDEX_H
+#define DUPLICATION_CHECKER_BINARY_INDEX_H
+
+#include "digest.h"
+#include "log_reader.h"
+#include "mapped_file.h"
+#include "sha1.h"
+#include "text_view.h"
+#include "quicky_exception.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Binary equivalent of sorted_sha1sum.log which is memory mapped instead
+     * of being parsed.
+     * File layout, integers are in host byte order:
+     * - header: magic, version, restart interval, number of groups, number
+     *   of files, number of groups with several files, size of path blob,
+     *   digest type. Digest type is 0 for SHA1 so that indexes created
+     *   before other digests were supported remain valid
+     * - digests of groups as keys of digest size in sorted order, padded to
+     *   8 bytes
+     * - group table: index of first file of each group followed by number
+     *   of files
+     * - index of groups having several files
+     * - restart table: offset in path blob of every restart interval file
+     * - path blob: paths in index order, front coded. Each path is stored as
+     *   the length of prefix shared with previous path and the remaining
+     *   suffix, lengths are varints. Prefix length is 0 at restart points so
+     *   any path can be decoded from its closest restart point
+     * - end magic
+     * Files are sorted by digest then path, both compared bytewise, like
+     * LC_ALL=C sort orders the log
+     */
+    class binary_index
+    {
+      public:
+
+        /**
+         * Map index, throw if file is not a valid index
+         */
+        inline explicit
+        binary_index(const std::string & p_file_name);
+
+        /**
+         * Create index from a log in sha1sum format which does not need to be
+         * sorted. Digest type is given by log header. Lines whose digest is
+         * not valid for this type are ignored with a warning
+         */
+        static inline
+        void
+        convert(const std::string & p_log_name
+               ,const std::string & p_index_name
+               );
+
+        /**
+         * Write content of index in sorted sha1sum format
+         */
+        inline
+        void
+        dump(const std::string & p_file_name) const;
+
+        inline
+        uint64_t
+        get_nb_groups() const;
+
+        inline
+        uint64_t
+        get_nb_files() const;
+
+        inline
+        uint64_t
+        get_nb_duplicated_groups() const;
+
+        /**
+         * @return index of p_index th group having several files
+         */
+        inline
+        uint64_t
+        get_duplicated_group(uint64_t p_index) const;
+
+        inline
+        digest_type
+        get_digest_type() const;
+
+        /**
+         * @return digest of group, get_digest_size(get_digest_type()) bytes
+         */
+        inline
+        const uint8_t *
+        get_digest(uint64_t p_group) const;
+
+        /**
+         * Decode paths of files of group
+         */
+        inline
+        void
+        get_paths(uint64_t p_group
+                 ,std::vector<std::string> & p_paths
+                 ) const;
+
+        /**
+         * Search group by binary search on sorted digests
+         * @return group index or m_not_found
+         */
+        inline
+        uint64_t
+        find(const uint8_t * p_digest) const;
+
+        static const uint64_t m_not_found = UINT64_MAX;
+
+      private:
+
+        /**
+         * Read 64 bits integer at p_offset of mapping
+         */
+        inline
+        uint64_t
+        read_uint64(size_t p_offset) const;
+
+        /**
+         * Decode p_nb paths starting at file p_first
+         */
+        inline
+        void
+        decode_paths(uint64_t p_first
+                    ,uint64_t p_nb
+                    ,std::vector<std::string> & p_paths
+                    ) const;
+
+        static inline
+        uint64_t
+        read_varint(const uint8_t * & p_pointer);
+
+        static inline
+        void
+        write_varint(std::string & p_output
+                    ,uint64_t p_value
+                    );
+
+        static inline
+        size_t
+        align(size_t p_size);
+
+        mapped_file m_file;
+
+        uint64_t m_restart_interval;
+
+        uint64_t m_nb_groups;
+
+        uint64_t m_nb_files;
+
+        uint64_t m_nb_duplicated_groups;
+
+        digest_type m_digest_type;
+
+        size_t m_digest_size;
+
+        size_t m_digests_offset;
+
+        size_t m_groups_offset;
+
+        size_t m_duplicated_groups_offset;
+
+        size_t m_restarts_offset;
+
+        size_t m_paths_offset;
+
+        static const uint64_t m_magic = 0x3158444e49434423ULL;
+
+        static const uint64_t m_end_magic = 0x444e452d58444923ULL;
+
+        static const uint32_t m_version = 1;
+
+        static const size_t m_header_size = 56;
+
+        static const uint32_t m_default_restart_interval = 16;
+    };
+
+    //-------------------------------------------------------------------------
+    binary_index::binary_index(const std::string & p_file_name)
+    :m_file(p_file_name)
+    ,m_restart_interval{0}
+    ,m_nb_groups{0}
+    ,m_nb_files{0}
+    ,m_nb_duplicated_groups{0}
+    ,m_digest_type{digest_type::SHA1}
+    ,m_digest_size{sha1::m_digest_size}
+    ,m_digests_offset{0}
+    ,m_groups_offset{0}
+    ,m_duplicated_groups_offset{0}
+    ,m_restarts_offset{0}
+    ,m_paths_offset{0}
+    {
+        bool l_valid = m_file.size() >= m_header_size + sizeof(uint64_t) && m_magic == read_uint64(0);
+        if(l_valid)
+        {
+            uint32_t l_version;
+            uint32_t l_restart_interval;
+            memcpy(&l_version, m_file.data() + 8, sizeof(l_version));
+            memcpy(&l_restart_interval, m_file.data() + 12, sizeof(l_restart_interval));
+            m_restart_interval = l_restart_interval;
+            m_nb_groups = read_uint64(16);
+            m_nb_files = read_uint64(24);
+            m_nb_duplicated_groups = read_uint64(32);
+            uint64_t l_paths_size = read_uint64(40);
+            uint64_t l_digest_type = read_uint64(48);
+            l_valid = l_digest_type <= (uint64_t)digest_type::BLAKE3;
+            m_digest_type = (digest_type)l_digest_type;
+            m_digest_size = l_valid ? get_digest_size(m_digest_type) : 0;
+            m_digests_offset = m_header_size;
+            m_groups_offset = m_digests_offset + align((size_t)m_nb_groups * m_digest_size);
+            m_duplicated_groups_offset = m_groups_offset + (size_t)(m_nb_groups + 1) * sizeof(uint64_t);
+            m_restarts_offset = m_duplicated_groups_offset + (size_t)m_nb_duplicated_groups * sizeof(uint64_t);
+            m_paths_offset = m_restarts_offset + (size_t)((m_nb_files + m_restart_interval - 1) / std::max<uint64_t>(m_restart_interval, 1)) * sizeof(uint64_t);
+            l_valid = l_valid &&
+                      m_version == l_version &&
+                      m_restart_interval &&
+                      m_paths_offset + align((size_t)l_paths_size) + sizeof(uint64_t) == m_file.size() &&
+                      m_end_magic == read_uint64(m_file.size() - sizeof(uint64_t));
+        }
+        if(!l_valid)
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(")" + p_file_name + R"(" is not a valid index)"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    binary_index::convert(const std::string & p_log_name
+                         ,const std::string & p_index_name
+                         )
+    {
+        // Lines are kept as views on log
+        log_reader l_reader(p_log_name);
+        std::vector<std::pair<std::string, text_view>> l_files;
+        text_view l_line;
+        uint64_t l_line_number = 0;
+        digest_type l_digest_type = digest_type::SHA1;
+        while(l_reader.get_line(l_line))
+        {
+            ++l_line_number;
+            if(l_line.empty())
+            {
+                continue;
+            }
+            if(1 == l_line_number && digest::parse_header(l_line.to_string(), l_digest_type))
+            {
+                continue;
+            }
+            size_t l_space_pos = l_line.find(' ');
+            std::string l_digest(digest::m_max_size, '\0');
+            if(std::string::npos == l_space_pos || get_digest_size(l_digest_type) != digest::from_string(l_line.data(), l_space_pos, (uint8_t *)&l_digest[0]))
+            {
+                std::cerr << "WARNING : ignore line " << l_line_number << R"( of ")" << p_log_name << R"(" with invalid )" << to_string(l_digest_type) << std::endl;
+                continue;
+            }
+            l_digest.resize(get_digest_size(l_digest_type));
+            l_files.emplace_back(l_digest, l_line.substr(l_space_pos + 2));
+        }
+        // Sorted by digest then path, both compared bytewise, which is the
+        // order of a log sorted with LC_ALL=C sort
+        std::sort(l_files.begin(), l_files.end());
+
+        std::string l_digests;
+        std::vector<uint64_t> l_groups;
+        std::vector<uint64_t> l_duplicated_groups;
+        std::vector<uint64_t> l_restarts;
+        std::string l_paths;
+        const uint32_t l_restart_interval = m_default_restart_interval;
+        text_view l_previous;
+        for(size_t l_index = 0; l_index < l_files.size(); ++l_index)
+        {
+            if(!l_index || l_files[l_index].first != l_files[l_index - 1].first)
+            {
+                if(!l_groups.empty() && l_index - l_groups.back() > 1)
+                {
+                    l_duplicated_groups.emplace_back(l_groups.size() - 1);
+                }
+                l_groups.emplace_back(l_index);
+                l_digests += l_files[l_index].first;
+            }
+            const text_view & l_path = l_files[l_index].second;
+            size_t l_prefix = 0;
+            if(l_index % l_restart_interval)
+            {
+                size_t l_max = std::min(l_path.size(), l_previous.size());
+                while(l_prefix < l_max && l_path.data()[l_prefix] == l_previous.data()[l_prefix])
+                {
+                    ++l_prefix;
+                }
+            }
+            else
+            {
+                l_restarts.emplace_back(l_paths.size());
+            }
+            write_varint(l_paths, l_prefix);
+            write_varint(l_paths, l_path.size() - l_prefix);
+            l_paths.append(l_path.data() + l_prefix, l_path.size() - l_prefix);
+            l_previous = l_path;
+        }
+        if(!l_groups.empty() && l_files.size() - l_groups.back() > 1)
+        {
+            l_duplicated_groups.emplace_back(l_groups.size() - 1);
+        }
+        uint64_t l_nb_groups = l_groups.size();
+        l_groups.emplace_back(l_files.size());
+
+        std::ofstream l_output(p_index_name, std::ios::binary | std::ios::trunc);
+        if(!l_output.is_open())
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error opening output file ")" + p_index_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        uint64_t l_header[7] = {m_magic, 0, l_nb_groups, (uint64_t)l_files.size(), (uint64_t)l_duplicated_groups.size(), (uint64_t)l_paths.size(), (uint64_t)l_digest_type};
+        uint32_t l_version = m_version;
+        memcpy(&l_header[1], &l_version, sizeof(l_version));
+        memcpy((char *)&l_header[1] + sizeof(l_version), &l_restart_interval, sizeof(l_restart_interval));
+        l_output.write((const char *)l_header, m_header_size);
+        l_digests.resize(align(l_digests.size()), '\0');
+        l_output.write(l_digests.data(), (std::streamsize)l_digests.size());
+        l_output.write((const char *)l_groups.data(), (std::streamsize)(l_groups.size() * sizeof(uint64_t)));
+        l_output.write((const char *)l_duplicated_groups.data(), (std::streamsize)(l_duplicated_groups.size() * sizeof(uint64_t)));
+        l_output.write((const char *)l_restarts.data(), (std::streamsize)(l_restarts.size() * sizeof(uint64_t)));
+        l_paths.resize(align(l_paths.size()), '\0');
+        l_output.write(l_paths.data(), (std::streamsize)l_paths.size());
+        uint64_t l_end_magic = m_end_magic;
+        l_output.write((const char *)&l_end_magic, sizeof(l_end_magic));
+        l_output.close();
+        if(l_output.fail())
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error writing index ")" + p_index_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        std::string l_digest_name = to_string(l_digest_type);
+        std::transform(l_digest_name.begin(), l_digest_name.end(), l_digest_name.begin(), ::toupper);
+        std::cout << std::to_string(l_files.size()) + " files and " + std::to_string(l_nb_groups) + " " + l_digest_name + " written in index, " + std::to_string(l_duplicated_groups.size()) + " " + l_digest_name + " with several files" << std::endl;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    binary_index::dump(const std::string & p_file_name) const
+    {
+        std::ofstream l_output(p_file_name);
+        if(!l_output.is_open())
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error opening output file ")" + p_file_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        if(digest_type::SHA1 != m_digest_type)
+        {
+            l_output << digest::get_header(m_digest_type) << "\n";
+        }
+        std::vector<std::string> l_paths;
+        decode_paths(0, m_nb_files, l_paths);
+        for(uint64_t l_group = 0; l_group < m_nb_groups; ++l_group)
+        {
+            std::string l_digest = digest::to_string(get_digest(l_group), m_digest_size);
+            for(uint64_t l_index = read_uint64(m_groups_offset + l_group * sizeof(uint64_t)); l_index < read_uint64(m_groups_offset + (l_group + 1) * sizeof(uint64_t)); ++l_index)
+            {
+                l_output << l_digest << "  " << l_paths[l_index] << "\n";
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    binary_index::get_nb_groups() const
+    {
+        return m_nb_groups;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    binary_index::get_nb_files() const
+    {
+        return m_nb_files;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    binary_index::get_nb_duplicated_groups() const
+    {
+        return m_nb_duplicated_groups;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    binary_index::get_duplicated_group(uint64_t p_index) const
+    {
+        return read_uint64(m_duplicated_groups_offset + p_index * sizeof(uint64_t));
+    }
+
+    //-------------------------------------------------------------------------
+    digest_type
+    binary_index::get_digest_type() const
+    {
+        return m_digest_type;
+    }
+
+    //-------------------------------------------------------------------------
+    const uint8_t *
+    binary_index::get_digest(uint64_t p_group) const
+    {
+        return (const uint8_t *)m_file.data() + m_digests_offset + p_group * m_digest_size;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    binary_index::get_paths(uint64_t p_group
+                           ,std::vector<std::string> & p_paths
+                           ) const
+    {
+        uint64_t l_first = read_uint64(m_groups_offset + p_group * sizeof(uint64_t));
+        uint64_t l_end = read_uint64(m_groups_offset + (p_group + 1) * sizeof(uint64_t));
+        decode_paths(l_first, l_end - l_first, p_paths);
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    binary_index::find(const uint8_t * p_digest) const
+    {
+        uint64_t l_min = 0;
+        uint64_t l_max = m_nb_groups;
+        while(l_min < l_max)
+        {
+            uint64_t l_middle = l_min + (l_max - l_min) / 2;
+            int l_compare = memcmp(get_digest(l_middle), p_digest, m_digest_size);
+            if(!l_compare)
+            {
+                return l_middle;
+            }
+            if(l_compare < 0)
+            {
+                l_min = l_middle + 1;
+            }
+            else
+            {
+                l_max = l_middle;
+            }
+        }
+        return m_not_found;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    binary_index::read_uint64(size_t p_offset) const
+    {
+        uint64_t l_value;
+        memcpy(&l_value, m_file.data() + p_offset, sizeof(l_value));
+        return l_value;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    binary_index::decode_paths(uint64_t p_first
+                              ,uint64_t p_nb
+                              ,std::vector<std::string> & p_paths
+                              ) const
+    {
+        // Strings of p_paths are reused to avoid allocations
+        p_paths.resize((size_t)p_nb);
+        if(!p_nb)
+        {
+            return;
+        }
+        uint64_t l_index = p_first - p_first % m_restart_interval;
+        const uint8_t * l_pointer = (const uint8_t *)m_file.data() + m_paths_offset + read_uint64(m_restarts_offset + (size_t)(l_index / m_restart_interval) * sizeof(uint64_t));
+        std::string l_path;
+        for(; l_index < p_first + p_nb; ++l_index)
+        {
+            uint64_t l_prefix = read_varint(l_pointer);
+            uint64_t l_suffix = read_varint(l_pointer);
+            l_path.resize((size_t)l_prefix);
+            l_path.append((const char *)l_pointer, (size_t)l_suffix);
+            l_pointer += l_suffix;
+            if(l_index >= p_first)
+            {
+                p_paths[(size_t)(l_index - p_first)].assign(l_path);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    binary_index::read_varint(const uint8_t * & p_pointer)
+    {
+        uint64_t l_value = 0;
+        unsigned int l_shift = 0;
+        while(*p_pointer & 0x80)
+        {
+            l_value |= (uint64_t)(*p_pointer & 0x7F) << l_shift;
+            l_shift += 7;
+            ++p_pointer;
+        }
+        l_value |= (uint64_t)*p_pointer << l_shift;
+        ++p_pointer;
+        return l_value;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    binary_index::write_varint(std::string & p_output
+                              ,uint64_t p_value
+                              )
+    {
+        while(p_value >= 0x80)
+        {
+            p_output.push_back((char)(0x80 | (p_value & 0x7F)));
+            p_value >>= 7;
+        }
+        p_output.push_back((char)p_value);
+    }
+
+    //-------------------------------------------------------------------------
+    size_t
+    binary_index::align(size_t p_size)
+    {
+        return (p_size + 7) & ~(size_t)7;
+    }
+
+}
+#endif //DUPLICATION_CHECKER_BINARY_INDEX_H
+// EOF
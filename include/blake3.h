@@ -0,0 +1,1009 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_BLAKE3_H
+#define DUPLICATION_CHECKER_BLAKE3_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#ifdef __SSE2__
+#include <emmintrin.h>
+#endif // __SSE2__
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <immintrin.h>
+#endif // x86 with GCC or clang
+
+namespace duplication_checker
+{
+    /**
+     * Incremental BLAKE3 computation in hash mode producing the same 256 bits
+     * digest as b3sum.
+     * Input is split in chunks of 1 KB which are leaves of a binary tree.
+     * Chunks being independent, complete chunks are compressed several at
+     * once, one per lane of vector registers, by the widest kernel supported
+     * by the CPU, chosen at first use: AVX-512 for 16 chunks, AVX2 for 8
+     * chunks, then SSE2 for 4 chunks. Parents of a subtree of chunks are
+     * reduced level by level with the same kernels
+     */
+    class blake3
+    {
+      public:
+
+        static const size_t m_digest_size = 32;
+
+        inline
+        blake3();
+
+        inline
+        void
+        update(const uint8_t * p_data
+              ,size_t p_size
+              );
+
+        /**
+         * Complete computation and store digest in p_digest which must be
+         * at least m_digest_size bytes long
+         */
+        inline
+        void
+        finalize(uint8_t * p_digest);
+
+      private:
+
+        /**
+         * Input of last compression of a node, kept to compute either its
+         * chaining value or the root digest
+         */
+        class output
+        {
+          public:
+
+            uint32_t m_chaining_value[8];
+            uint32_t m_block[16];
+            uint64_t m_counter;
+            uint32_t m_block_size;
+            uint32_t m_flags;
+        };
+
+        /**
+         * Initial chaining value, same as SHA-256
+         */
+        static inline
+        const uint32_t *
+        get_iv();
+
+        /**
+         * Message words used by each of the 7 rounds, result of successive
+         * permutations of block words
+         */
+        static inline
+        const uint8_t (*get_schedule())[16];
+
+        /**
+         * Compress a block and return the 8 first words of result
+         */
+        static inline
+        void
+        compress(const uint32_t * p_chaining_value
+                ,const uint32_t * p_block
+                ,uint64_t p_counter
+                ,uint32_t p_block_size
+                ,uint32_t p_flags
+                ,uint32_t * p_result
+                );
+
+        static inline
+        void
+        load_block(const uint8_t * p_data
+                  ,size_t p_size
+                  ,uint32_t * p_block
+                  );
+
+        /**
+         * Output of current chunk
+         */
+        inline
+        void
+        get_chunk_output(output & p_output) const;
+
+        static inline
+        void
+        get_parent_output(const uint32_t * p_left
+                         ,const uint32_t * p_right
+                         ,output & p_output
+                         );
+
+        /**
+         * Push chaining value of a complete chunk and merge subtrees that are
+         * complete
+         * @param p_nb_chunks number of chunks including this one. For the
+         * chaining value of a subtree of 2^n chunks starting at a multiple of
+         * its size, number of such subtrees including this one
+         */
+        inline
+        void
+        add_chunk_chaining_value(uint32_t * p_chaining_value
+                                ,uint64_t p_nb_chunks
+                                );
+
+        /**
+         * Hash with vector kernels subtrees of complete chunks of p_data
+         * which do not contain last chunk of input, p_data and p_size are
+         * updated
+         */
+        inline
+        void
+        hash_subtrees(const uint8_t * & p_data
+                     ,size_t & p_size
+                     );
+
+        /**
+         * Chaining values of p_nb_inputs inputs of p_nb_blocks blocks stored
+         * one after the other at p_data, with the widest kernels supported by
+         * CPU. Counter of input i is p_counter + i if p_increment_counter,
+         * p_counter otherwise. p_flags is used by all blocks, p_flags_start
+         * and p_flags_end are added to first and last blocks of each input
+         */
+        static inline
+        void
+        hash_many(const uint8_t * p_data
+                 ,size_t p_nb_inputs
+                 ,size_t p_nb_blocks
+                 ,uint64_t p_counter
+                 ,bool p_increment_counter
+                 ,uint32_t p_flags
+                 ,uint32_t p_flags_start
+                 ,uint32_t p_flags_end
+                 ,uint32_t (*p_chaining_values)[8]
+                 );
+
+#ifdef __SSE2__
+        /**
+         * Same as hash_many for 4 inputs
+         */
+        static inline
+        void
+        hash_4_inputs(const uint8_t * p_data
+                     ,size_t p_nb_blocks
+                     ,uint64_t p_counter
+                     ,bool p_increment_counter
+                     ,uint32_t p_flags
+                     ,uint32_t p_flags_start
+                     ,uint32_t p_flags_end
+                     ,uint32_t (*p_chaining_values)[8]
+                     );
+#endif // __SSE2__
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+        /**
+         * Transpose 8 rows of 8 words so that each register holds one word
+         * of each row
+         */
+        __attribute__((target("avx2")))
+        static inline
+        void
+        transpose_avx2(__m256i * p_rows);
+
+        /**
+         * Mixing function applied to 4 words of state of 8 chunks
+         */
+        __attribute__((target("avx2")))
+        static inline
+        void
+        g_avx2(__m256i & p_a
+              ,__m256i & p_b
+              ,__m256i & p_c
+              ,__m256i & p_d
+              ,__m256i p_x
+              ,__m256i p_y
+              );
+
+        /**
+         * Same as hash_many for 8 inputs
+         */
+        __attribute__((target("avx2")))
+        static inline
+        void
+        hash_8_inputs_avx2(const uint8_t * p_data
+                          ,size_t p_nb_blocks
+                          ,uint64_t p_counter
+                          ,bool p_increment_counter
+                          ,uint32_t p_flags
+                          ,uint32_t p_flags_start
+                          ,uint32_t p_flags_end
+                          ,uint32_t (*p_chaining_values)[8]
+                          );
+
+        /**
+         * Transpose 16 rows of 16 words so that each register holds one
+         * word of each row
+         */
+        __attribute__((target("avx512f")))
+        static inline
+        void
+        transpose_avx512(__m512i * p_rows);
+
+        template <int t_shift>
+        __attribute__((target("avx512f")))
+        static inline
+        __m512i
+        rotate_right_avx512(__m512i p_value);
+
+        /**
+         * Mixing function applied to 4 words of state of 16 chunks
+         */
+        __attribute__((target("avx512f")))
+        static inline
+        void
+        g_avx512(__m512i & p_a
+                ,__m512i & p_b
+                ,__m512i & p_c
+                ,__m512i & p_d
+                ,__m512i p_x
+                ,__m512i p_y
+                );
+
+        /**
+         * Same as hash_many for 16 inputs
+         */
+        __attribute__((target("avx512f")))
+        static inline
+        void
+        hash_16_inputs_avx512(const uint8_t * p_data
+                             ,size_t p_nb_blocks
+                             ,uint64_t p_counter
+                             ,bool p_increment_counter
+                             ,uint32_t p_flags
+                             ,uint32_t p_flags_start
+                             ,uint32_t p_flags_end
+                             ,uint32_t (*p_chaining_values)[8]
+                             );
+#endif // x86 with GCC or clang
+
+        /**
+         * Chaining value of current chunk
+         */
+        uint32_t m_chaining_value[8];
+
+        /**
+         * Index of current chunk
+         */
+        uint64_t m_chunk_counter;
+
+        uint8_t m_buffer[64];
+
+        size_t m_buffer_size;
+
+        unsigned int m_nb_compressed_blocks;
+
+        /**
+         * Chaining values of complete subtrees, at most one per level
+         */
+        uint32_t m_stack[54][8];
+
+        size_t m_stack_size;
+
+        static const size_t m_chunk_size = 1024;
+
+        /**
+         * Maximum number of chunks of a subtree hashed by vector kernels
+         */
+        static const size_t m_max_subtree_chunks = 256;
+
+        static const uint32_t m_chunk_start = 1;
+        static const uint32_t m_chunk_end = 2;
+        static const uint32_t m_parent = 4;
+        static const uint32_t m_root = 8;
+    };
+
+    //-------------------------------------------------------------------------
+    blake3::blake3()
+    :m_chaining_value{}
+    ,m_chunk_counter{0}
+    ,m_buffer{}
+    ,m_buffer_size{0}
+    ,m_nb_compressed_blocks{0}
+    ,m_stack{}
+    ,m_stack_size{0}
+    {
+        memcpy(m_chaining_value, get_iv(), sizeof(m_chaining_value));
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    blake3::update(const uint8_t * p_data
+                  ,size_t p_size
+                  )
+    {
+        while(p_size)
+        {
+            // A chunk is only complete when more input follows because last
+            // chunk is compressed with root flag when it is the only one
+            if(m_chunk_size == 64 * m_nb_compressed_blocks + m_buffer_size)
+            {
+                output l_output;
+                get_chunk_output(l_output);
+                uint32_t l_chaining_value[8];
+                compress(l_output.m_chaining_value, l_output.m_block, l_output.m_counter, l_output.m_block_size, l_output.m_flags, l_chaining_value);
+                add_chunk_chaining_value(l_chaining_value, m_chunk_counter + 1);
+                memcpy(m_chaining_value, get_iv(), sizeof(m_chaining_value));
+                ++m_chunk_counter;
+                m_buffer_size = 0;
+                m_nb_compressed_blocks = 0;
+            }
+            if(!m_nb_compressed_blocks && !m_buffer_size)
+            {
+                hash_subtrees(p_data, p_size);
+            }
+            size_t l_chunk_remaining = m_chunk_size - 64 * m_nb_compressed_blocks - m_buffer_size;
+            size_t l_size = std::min(p_size, l_chunk_remaining);
+            p_size -= l_size;
+            while(l_size)
+            {
+                // Block is compressed once it is known not to be the last
+                if(sizeof(m_buffer) == m_buffer_size)
+                {
+                    uint32_t l_block[16];
+                    load_block(m_buffer, sizeof(m_buffer), l_block);
+                    compress(m_chaining_value, l_block, m_chunk_counter, 64, m_nb_compressed_blocks ? 0 : m_chunk_start, m_chaining_value);
+                    ++m_nb_compressed_blocks;
+                    m_buffer_size = 0;
+                }
+                size_t l_copy_size = std::min(l_size, sizeof(m_buffer) - m_buffer_size);
+                memcpy(m_buffer + m_buffer_size, p_data, l_copy_size);
+                m_buffer_size += l_copy_size;
+                p_data += l_copy_size;
+                l_size -= l_copy_size;
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    blake3::finalize(uint8_t * p_digest)
+    {
+        output l_output;
+        get_chunk_output(l_output);
+        for(size_t l_index = m_stack_size; l_index > 0; --l_index)
+        {
+            uint32_t l_chaining_value[8];
+            compress(l_output.m_chaining_value, l_output.m_block, l_output.m_counter, l_output.m_block_size, l_output.m_flags, l_chaining_value);
+            get_parent_output(m_stack[l_index - 1], l_chaining_value, l_output);
+        }
+        uint32_t l_result[8];
+        compress(l_output.m_chaining_value, l_output.m_block, 0, l_output.m_block_size, l_output.m_flags | m_root, l_result);
+        for(unsigned int l_index = 0; l_index < 8; ++l_index)
+        {
+            p_digest[4 * l_index] = (uint8_t)l_result[l_index];
+            p_digest[4 * l_index + 1] = (uint8_t)(l_result[l_index] >> 8);
+            p_digest[4 * l_index + 2] = (uint8_t)(l_result[l_index] >> 16);
+            p_digest[4 * l_index + 3] = (uint8_t)(l_result[l_index] >> 24);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    const uint32_t *
+    blake3::get_iv()
+    {
+        static const uint32_t l_iv[8] = {0x6A09E667, 0xBB67AE85, 0x3C6EF372, 0xA54FF53A, 0x510E527F, 0x9B05688C, 0x1F83D9AB, 0x5BE0CD19};
+        return l_iv;
+    }
+
+    //-------------------------------------------------------------------------
+    const uint8_t (*blake3::get_schedule())[16]
+    {
+        static const uint8_t l_schedule[7][16] =
+        {{0, 1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12, 13, 14, 15}
+        ,{2, 6, 3, 10, 7, 0, 4, 13, 1, 11, 12, 5, 9, 14, 15, 8}
+        ,{3, 4, 10, 12, 13, 2, 7, 14, 6, 5, 9, 0, 11, 15, 8, 1}
+        ,{10, 7, 12, 9, 14, 3, 13, 15, 4, 0, 11, 2, 5, 8, 1, 6}
+        ,{12, 13, 9, 11, 15, 10, 14, 8, 7, 2, 5, 3, 0, 1, 6, 4}
+        ,{9, 14, 11, 5, 8, 12, 15, 1, 13, 3, 0, 10, 2, 6, 4, 7}
+        ,{11, 15, 5, 0, 1, 9, 8, 6, 14, 10, 2, 12, 3, 4, 7, 13}
+        };
+        return l_schedule;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    blake3::compress(const uint32_t * p_chaining_value
+                    ,const uint32_t * p_block
+                    ,uint64_t p_counter
+                    ,uint32_t p_block_size
+                    ,uint32_t p_flags
+                    ,uint32_t * p_result
+                    )
+    {
+        const uint8_t (*l_schedule)[16] = get_schedule();
+        const uint32_t * l_iv = get_iv();
+        uint32_t l_state[16] = {p_chaining_value[0], p_chaining_value[1], p_chaining_value[2], p_chaining_value[3]
+                               ,p_chaining_value[4], p_chaining_value[5], p_chaining_value[6], p_chaining_value[7]
+                               ,l_iv[0], l_iv[1], l_iv[2], l_iv[3]
+                               ,(uint32_t)p_counter, (uint32_t)(p_counter >> 32), p_block_size, p_flags
+                               };
+        auto l_g = [&](unsigned int p_a
+                      ,unsigned int p_b
+                      ,unsigned int p_c
+                      ,unsigned int p_d
+                      ,uint32_t p_x
+                      ,uint32_t p_y
+                      )
+        {
+            l_state[p_a] = l_state[p_a] + l_state[p_b] + p_x;
+            l_state[p_d] = l_state[p_d] ^ l_state[p_a];
+            l_state[p_d] = (l_state[p_d] >> 16) | (l_state[p_d] << 16);
+            l_state[p_c] = l_state[p_c] + l_state[p_d];
+            l_state[p_b] = l_state[p_b] ^ l_state[p_c];
+            l_state[p_b] = (l_state[p_b] >> 12) | (l_state[p_b] << 20);
+            l_state[p_a] = l_state[p_a] + l_state[p_b] + p_y;
+            l_state[p_d] = l_state[p_d] ^ l_state[p_a];
+            l_state[p_d] = (l_state[p_d] >> 8) | (l_state[p_d] << 24);
+            l_state[p_c] = l_state[p_c] + l_state[p_d];
+            l_state[p_b] = l_state[p_b] ^ l_state[p_c];
+            l_state[p_b] = (l_state[p_b] >> 7) | (l_state[p_b] << 25);
+        };
+        for(unsigned int l_round = 0; l_round < 7; ++l_round)
+        {
+            const uint8_t * l_words = l_schedule[l_round];
+            // Columns then diagonals
+            l_g(0, 4, 8, 12, p_block[l_words[0]], p_block[l_words[1]]);
+            l_g(1, 5, 9, 13, p_block[l_words[2]], p_block[l_words[3]]);
+            l_g(2, 6, 10, 14, p_block[l_words[4]], p_block[l_words[5]]);
+            l_g(3, 7, 11, 15, p_block[l_words[6]], p_block[l_words[7]]);
+            l_g(0, 5, 10, 15, p_block[l_words[8]], p_block[l_words[9]]);
+            l_g(1, 6, 11, 12, p_block[l_words[10]], p_block[l_words[11]]);
+            l_g(2, 7, 8, 13, p_block[l_words[12]], p_block[l_words[13]]);
+            l_g(3, 4, 9, 14, p_block[l_words[14]], p_block[l_words[15]]);
+        }
+        for(unsigned int l_index = 0; l_index < 8; ++l_index)
+        {
+            p_result[l_index] = l_state[l_index] ^ l_state[l_index + 8];
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    blake3::load_block(const uint8_t * p_data
+                      ,size_t p_size
+                      ,uint32_t * p_block
+                      )
+    {
+        uint8_t l_bytes[64] = {};
+        memcpy(l_bytes, p_data, p_size);
+        for(unsigned int l_index = 0; l_index < 16; ++l_index)
+        {
+            p_block[l_index] = (uint32_t)l_bytes[4 * l_index] |
+                               ((uint32_t)l_bytes[4 * l_index + 1] << 8) |
+                               ((uint32_t)l_bytes[4 * l_index + 2] << 16) |
+                               ((uint32_t)l_bytes[4 * l_index + 3] << 24);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    blake3::get_chunk_output(output & p_output) const
+    {
+        memcpy(p_output.m_chaining_value, m_chaining_value, sizeof(m_chaining_value));
+        load_block(m_buffer, m_buffer_size, p_output.m_block);
+        p_output.m_counter = m_chunk_counter;
+        p_output.m_block_size = (uint32_t)m_buffer_size;
+        p_output.m_flags = (m_nb_compressed_blocks ? 0 : m_chunk_start) | m_chunk_end;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    blake3::get_parent_output(const uint32_t * p_left
+                             ,const uint32_t * p_right
+                             ,output & p_output
+                             )
+    {
+        memcpy(p_output.m_chaining_value, get_iv(), sizeof(p_output.m_chaining_value));
+        memcpy(p_output.m_block, p_left, 8 * sizeof(uint32_t));
+        memcpy(p_output.m_block + 8, p_right, 8 * sizeof(uint32_t));
+        p_output.m_counter = 0;
+        p_output.m_block_size = 64;
+        p_output.m_flags = m_parent;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    blake3::add_chunk_chaining_value(uint32_t * p_chaining_value
+                                    ,uint64_t p_nb_chunks
+                                    )
+    {
+        // Each trailing 0 bit of number of chunks is a subtree completed by
+        // this chunk
+        while(!(p_nb_chunks & 1))
+        {
+            output l_output;
+            get_parent_output(m_stack[--m_stack_size], p_chaining_value, l_output);
+            compress(l_output.m_chaining_value, l_output.m_block, l_output.m_counter, l_output.m_block_size, l_output.m_flags, p_chaining_value);
+            p_nb_chunks >>= 1;
+        }
+        memcpy(m_stack[m_stack_size++], p_chaining_value, 8 * sizeof(uint32_t));
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    blake3::hash_subtrees(const uint8_t * & p_data
+                         ,size_t & p_size
+                         )
+    {
+        // Vector kernels read chaining values stored in memory as little
+        // endian words, which they are on x86
+#ifdef __SSE2__
+        // Chaining values of chunks then of each level of parents
+        uint32_t l_chaining_values[2][m_max_subtree_chunks][8];
+        while(true)
+        {
+            // Largest subtree starting at a multiple of its size so that it
+            // is a node of the tree
+            size_t l_nb_chunks = m_max_subtree_chunks;
+            while(l_nb_chunks > 1 && ((m_chunk_counter & (l_nb_chunks - 1)) || p_size <= l_nb_chunks * m_chunk_size))
+            {
+                l_nb_chunks >>= 1;
+            }
+            if(l_nb_chunks < 2)
+            {
+                return;
+            }
+            hash_many(p_data, l_nb_chunks, m_chunk_size / 64, m_chunk_counter, true, 0, m_chunk_start, m_chunk_end, l_chaining_values[0]);
+            unsigned int l_level = 0;
+            for(size_t l_nb_nodes = l_nb_chunks; l_nb_nodes > 1; l_nb_nodes /= 2)
+            {
+                hash_many((const uint8_t *)l_chaining_values[l_level % 2], l_nb_nodes / 2, 1, 0, false, m_parent, 0, 0, l_chaining_values[(l_level + 1) % 2]);
+                ++l_level;
+            }
+            add_chunk_chaining_value(l_chaining_values[l_level % 2][0], (m_chunk_counter >> l_level) + 1);
+            m_chunk_counter += l_nb_chunks;
+            p_data += l_nb_chunks * m_chunk_size;
+            p_size -= l_nb_chunks * m_chunk_size;
+        }
+#else // __SSE2__
+        (void)p_data;
+        (void)p_size;
+#endif // __SSE2__
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    blake3::hash_many(const uint8_t * p_data
+                     ,size_t p_nb_inputs
+                     ,size_t p_nb_blocks
+                     ,uint64_t p_counter
+                     ,bool p_increment_counter
+                     ,uint32_t p_flags
+                     ,uint32_t p_flags_start
+                     ,uint32_t p_flags_end
+                     ,uint32_t (*p_chaining_values)[8]
+                     )
+    {
+        size_t l_index = 0;
+        auto l_counter = [&]() -> uint64_t
+        {
+            return p_counter + (p_increment_counter ? l_index : 0);
+        };
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+        static const bool l_avx512 = __builtin_cpu_supports("avx512f");
+        static const bool l_avx2 = __builtin_cpu_supports("avx2");
+        for(; l_avx512 && l_index + 16 <= p_nb_inputs; l_index += 16)
+        {
+            hash_16_inputs_avx512(p_data + 64 * p_nb_blocks * l_index, p_nb_blocks, l_counter(), p_increment_counter, p_flags, p_flags_start, p_flags_end, p_chaining_values + l_index);
+        }
+        for(; l_avx2 && l_index + 8 <= p_nb_inputs; l_index += 8)
+        {
+            hash_8_inputs_avx2(p_data + 64 * p_nb_blocks * l_index, p_nb_blocks, l_counter(), p_increment_counter, p_flags, p_flags_start, p_flags_end, p_chaining_values + l_index);
+        }
+#endif // x86 with GCC or clang
+#ifdef __SSE2__
+        for(; l_index + 4 <= p_nb_inputs; l_index += 4)
+        {
+            hash_4_inputs(p_data + 64 * p_nb_blocks * l_index, p_nb_blocks, l_counter(), p_increment_counter, p_flags, p_flags_start, p_flags_end, p_chaining_values + l_index);
+        }
+#endif // __SSE2__
+        for(; l_index < p_nb_inputs; ++l_index)
+        {
+            uint32_t * l_chaining_value = p_chaining_values[l_index];
+            memcpy(l_chaining_value, get_iv(), 8 * sizeof(uint32_t));
+            for(size_t l_block_index = 0; l_block_index < p_nb_blocks; ++l_block_index)
+            {
+                uint32_t l_block[16];
+                load_block(p_data + 64 * (p_nb_blocks * l_index + l_block_index), 64, l_block);
+                uint32_t l_flags = p_flags | (l_block_index ? 0 : p_flags_start) | (p_nb_blocks - 1 == l_block_index ? p_flags_end : 0);
+                compress(l_chaining_value, l_block, l_counter(), 64, l_flags, l_chaining_value);
+            }
+        }
+    }
+
+#ifdef __SSE2__
+    //-------------------------------------------------------------------------
+    void
+    blake3::hash_4_inputs(const uint8_t * p_data
+                         ,size_t p_nb_blocks
+                         ,uint64_t p_counter
+                         ,bool p_increment_counter
+                         ,uint32_t p_flags
+                         ,uint32_t p_flags_start
+                         ,uint32_t p_flags_end
+                         ,uint32_t (*p_chaining_values)[8]
+                         )
+    {
+        const uint8_t (*l_schedule)[16] = get_schedule();
+        const uint32_t * l_iv = get_iv();
+
+        // Transpose 4 rows of 4 words so that each register holds one word
+        // of each chunk
+        auto l_transpose = [](__m128i * p_rows)
+        {
+            __m128i l_01_low = _mm_unpacklo_epi32(p_rows[0], p_rows[1]);
+            __m128i l_01_high = _mm_unpackhi_epi32(p_rows[0], p_rows[1]);
+            __m128i l_23_low = _mm_unpacklo_epi32(p_rows[2], p_rows[3]);
+            __m128i l_23_high = _mm_unpackhi_epi32(p_rows[2], p_rows[3]);
+            p_rows[0] = _mm_unpacklo_epi64(l_01_low, l_23_low);
+            p_rows[1] = _mm_unpackhi_epi64(l_01_low, l_23_low);
+            p_rows[2] = _mm_unpacklo_epi64(l_01_high, l_23_high);
+            p_rows[3] = _mm_unpackhi_epi64(l_01_high, l_23_high);
+        };
+        auto l_rotate = [](__m128i p_value, int p_shift) -> __m128i
+        {
+            return _mm_or_si128(_mm_srli_epi32(p_value, p_shift), _mm_slli_epi32(p_value, 32 - p_shift));
+        };
+
+        __m128i l_chaining_value[8];
+        for(unsigned int l_index = 0; l_index < 8; ++l_index)
+        {
+            l_chaining_value[l_index] = _mm_set1_epi32((int)l_iv[l_index]);
+        }
+        uint32_t l_counters[2][4];
+        for(unsigned int l_input = 0; l_input < 4; ++l_input)
+        {
+            l_counters[0][l_input] = (uint32_t)(p_counter + (p_increment_counter ? l_input : 0));
+            l_counters[1][l_input] = (uint32_t)((p_counter + (p_increment_counter ? l_input : 0)) >> 32);
+        }
+        __m128i l_counter_low = _mm_loadu_si128((const __m128i *)l_counters[0]);
+        __m128i l_counter_high = _mm_loadu_si128((const __m128i *)l_counters[1]);
+        for(size_t l_block_index = 0; l_block_index < p_nb_blocks; ++l_block_index)
+        {
+            __m128i l_block[16];
+            for(unsigned int l_group = 0; l_group < 4; ++l_group)
+            {
+                for(unsigned int l_input = 0; l_input < 4; ++l_input)
+                {
+                    l_block[4 * l_group + l_input] = _mm_loadu_si128((const __m128i *)(p_data + 64 * (l_input * p_nb_blocks + l_block_index) + l_group * 16));
+                }
+                l_transpose(l_block + 4 * l_group);
+            }
+            uint32_t l_flags = p_flags | (l_block_index ? 0 : p_flags_start) | (p_nb_blocks - 1 == l_block_index ? p_flags_end : 0);
+            __m128i l_state[16] = {l_chaining_value[0], l_chaining_value[1], l_chaining_value[2], l_chaining_value[3]
+                                  ,l_chaining_value[4], l_chaining_value[5], l_chaining_value[6], l_chaining_value[7]
+                                  ,_mm_set1_epi32((int)l_iv[0]), _mm_set1_epi32((int)l_iv[1]), _mm_set1_epi32((int)l_iv[2]), _mm_set1_epi32((int)l_iv[3])
+                                  ,l_counter_low, l_counter_high, _mm_set1_epi32(64), _mm_set1_epi32((int)l_flags)
+                                  };
+            auto l_g = [&](unsigned int p_a
+                          ,unsigned int p_b
+                          ,unsigned int p_c
+                          ,unsigned int p_d
+                          ,__m128i p_x
+                          ,__m128i p_y
+                          )
+            {
+                l_state[p_a] = _mm_add_epi32(_mm_add_epi32(l_state[p_a], l_state[p_b]), p_x);
+                l_state[p_d] = l_rotate(_mm_xor_si128(l_state[p_d], l_state[p_a]), 16);
+                l_state[p_c] = _mm_add_epi32(l_state[p_c], l_state[p_d]);
+                l_state[p_b] = l_rotate(_mm_xor_si128(l_state[p_b], l_state[p_c]), 12);
+                l_state[p_a] = _mm_add_epi32(_mm_add_epi32(l_state[p_a], l_state[p_b]), p_y);
+                l_state[p_d] = l_rotate(_mm_xor_si128(l_state[p_d], l_state[p_a]), 8);
+                l_state[p_c] = _mm_add_epi32(l_state[p_c], l_state[p_d]);
+                l_state[p_b] = l_rotate(_mm_xor_si128(l_state[p_b], l_state[p_c]), 7);
+            };
+            for(unsigned int l_round = 0; l_round < 7; ++l_round)
+            {
+                const uint8_t * l_words = l_schedule[l_round];
+                l_g(0, 4, 8, 12, l_block[l_words[0]], l_block[l_words[1]]);
+                l_g(1, 5, 9, 13, l_block[l_words[2]], l_block[l_words[3]]);
+                l_g(2, 6, 10, 14, l_block[l_words[4]], l_block[l_words[5]]);
+                l_g(3, 7, 11, 15, l_block[l_words[6]], l_block[l_words[7]]);
+                l_g(0, 5, 10, 15, l_block[l_words[8]], l_block[l_words[9]]);
+                l_g(1, 6, 11, 12, l_block[l_words[10]], l_block[l_words[11]]);
+                l_g(2, 7, 8, 13, l_block[l_words[12]], l_block[l_words[13]]);
+                l_g(3, 4, 9, 14, l_block[l_words[14]], l_block[l_words[15]]);
+            }
+            for(unsigned int l_index = 0; l_index < 8; ++l_index)
+            {
+                l_chaining_value[l_index] = _mm_xor_si128(l_state[l_index], l_state[l_index + 8]);
+            }
+        }
+        // Back to one row per chunk
+        l_transpose(l_chaining_value);
+        l_transpose(l_chaining_value + 4);
+        for(unsigned int l_input = 0; l_input < 4; ++l_input)
+        {
+            _mm_storeu_si128((__m128i *)p_chaining_values[l_input], l_chaining_value[l_input]);
+            _mm_storeu_si128((__m128i *)(p_chaining_values[l_input] + 4), l_chaining_value[4 + l_input]);
+        }
+    }
+#endif // __SSE2__
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    //-------------------------------------------------------------------------
+    void
+    blake3::transpose_avx2(__m256i * p_rows)
+    {
+        __m256i l_pairs[8];
+        for(unsigned int l_index = 0; l_index < 8; l_index += 2)
+        {
+            l_pairs[l_index] = _mm256_unpacklo_epi32(p_rows[l_index], p_rows[l_index + 1]);
+            l_pairs[l_index + 1] = _mm256_unpackhi_epi32(p_rows[l_index], p_rows[l_index + 1]);
+        }
+        // Word i of rows 0 to 3 then 4 to 7 in each 128 bits half, i being
+        // index in half
+        __m256i l_quads[8];
+        for(unsigned int l_index = 0; l_index < 8; l_index += 4)
+        {
+            l_quads[l_index] = _mm256_unpacklo_epi64(l_pairs[l_index], l_pairs[l_index + 2]);
+            l_quads[l_index + 1] = _mm256_unpackhi_epi64(l_pairs[l_index], l_pairs[l_index + 2]);
+            l_quads[l_index + 2] = _mm256_unpacklo_epi64(l_pairs[l_index + 1], l_pairs[l_index + 3]);
+            l_quads[l_index + 3] = _mm256_unpackhi_epi64(l_pairs[l_index + 1], l_pairs[l_index + 3]);
+        }
+        for(unsigned int l_index = 0; l_index < 4; ++l_index)
+        {
+            p_rows[l_index] = _mm256_permute2x128_si256(l_quads[l_index], l_quads[l_index + 4], 0x20);
+            p_rows[l_index + 4] = _mm256_permute2x128_si256(l_quads[l_index], l_quads[l_index + 4], 0x31);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    blake3::g_avx2(__m256i & p_a
+                  ,__m256i & p_b
+                  ,__m256i & p_c
+                  ,__m256i & p_d
+                  ,__m256i p_x
+                  ,__m256i p_y
+                  )
+    {
+        // Rotations by multiples of 8 bits are byte shuffles
+        const __m256i l_rotate_16 = _mm256_setr_epi8(2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13
+                                                    ,2, 3, 0, 1, 6, 7, 4, 5, 10, 11, 8, 9, 14, 15, 12, 13
+                                                    );
+        const __m256i l_rotate_8 = _mm256_setr_epi8(1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12
+                                                   ,1, 2, 3, 0, 5, 6, 7, 4, 9, 10, 11, 8, 13, 14, 15, 12
+                                                   );
+        p_a = _mm256_add_epi32(_mm256_add_epi32(p_a, p_b), p_x);
+        p_d = _mm256_shuffle_epi8(_mm256_xor_si256(p_d, p_a), l_rotate_16);
+        p_c = _mm256_add_epi32(p_c, p_d);
+        p_b = _mm256_xor_si256(p_b, p_c);
+        p_b = _mm256_or_si256(_mm256_srli_epi32(p_b, 12), _mm256_slli_epi32(p_b, 20));
+        p_a = _mm256_add_epi32(_mm256_add_epi32(p_a, p_b), p_y);
+        p_d = _mm256_shuffle_epi8(_mm256_xor_si256(p_d, p_a), l_rotate_8);
+        p_c = _mm256_add_epi32(p_c, p_d);
+        p_b = _mm256_xor_si256(p_b, p_c);
+        p_b = _mm256_or_si256(_mm256_srli_epi32(p_b, 7), _mm256_slli_epi32(p_b, 25));
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    blake3::hash_8_inputs_avx2(const uint8_t * p_data
+                              ,size_t p_nb_blocks
+                              ,uint64_t p_counter
+                              ,bool p_increment_counter
+                              ,uint32_t p_flags
+                              ,uint32_t p_flags_start
+                              ,uint32_t p_flags_end
+                              ,uint32_t (*p_chaining_values)[8]
+                              )
+    {
+        const uint8_t (*l_schedule)[16] = get_schedule();
+        const uint32_t * l_iv = get_iv();
+
+
+        __m256i l_chaining_value[8];
+        for(unsigned int l_index = 0; l_index < 8; ++l_index)
+        {
+            l_chaining_value[l_index] = _mm256_set1_epi32((int)l_iv[l_index]);
+        }
+        uint32_t l_counters[2][8];
+        for(unsigned int l_input = 0; l_input < 8; ++l_input)
+        {
+            l_counters[0][l_input] = (uint32_t)(p_counter + (p_increment_counter ? l_input : 0));
+            l_counters[1][l_input] = (uint32_t)((p_counter + (p_increment_counter ? l_input : 0)) >> 32);
+        }
+        __m256i l_counter_low = _mm256_loadu_si256((const __m256i *)l_counters[0]);
+        __m256i l_counter_high = _mm256_loadu_si256((const __m256i *)l_counters[1]);
+        for(size_t l_block_index = 0; l_block_index < p_nb_blocks; ++l_block_index)
+        {
+            __m256i l_block[16];
+            for(unsigned int l_half = 0; l_half < 2; ++l_half)
+            {
+                for(unsigned int l_input = 0; l_input < 8; ++l_input)
+                {
+                    l_block[8 * l_half + l_input] = _mm256_loadu_si256((const __m256i *)(p_data + 64 * (l_input * p_nb_blocks + l_block_index) + l_half * 32));
+                }
+                transpose_avx2(l_block + 8 * l_half);
+            }
+            uint32_t l_flags = p_flags | (l_block_index ? 0 : p_flags_start) | (p_nb_blocks - 1 == l_block_index ? p_flags_end : 0);
+            __m256i l_state[16] = {l_chaining_value[0], l_chaining_value[1], l_chaining_value[2], l_chaining_value[3]
+                                  ,l_chaining_value[4], l_chaining_value[5], l_chaining_value[6], l_chaining_value[7]
+                                  ,_mm256_set1_epi32((int)l_iv[0]), _mm256_set1_epi32((int)l_iv[1]), _mm256_set1_epi32((int)l_iv[2]), _mm256_set1_epi32((int)l_iv[3])
+                                  ,l_counter_low, l_counter_high, _mm256_set1_epi32(64), _mm256_set1_epi32((int)l_flags)
+                                  };
+            for(unsigned int l_round = 0; l_round < 7; ++l_round)
+            {
+                const uint8_t * l_words = l_schedule[l_round];
+                g_avx2(l_state[0], l_state[4], l_state[8], l_state[12], l_block[l_words[0]], l_block[l_words[1]]);
+                g_avx2(l_state[1], l_state[5], l_state[9], l_state[13], l_block[l_words[2]], l_block[l_words[3]]);
+                g_avx2(l_state[2], l_state[6], l_state[10], l_state[14], l_block[l_words[4]], l_block[l_words[5]]);
+                g_avx2(l_state[3], l_state[7], l_state[11], l_state[15], l_block[l_words[6]], l_block[l_words[7]]);
+                g_avx2(l_state[0], l_state[5], l_state[10], l_state[15], l_block[l_words[8]], l_block[l_words[9]]);
+                g_avx2(l_state[1], l_state[6], l_state[11], l_state[12], l_block[l_words[10]], l_block[l_words[11]]);
+                g_avx2(l_state[2], l_state[7], l_state[8], l_state[13], l_block[l_words[12]], l_block[l_words[13]]);
+                g_avx2(l_state[3], l_state[4], l_state[9], l_state[14], l_block[l_words[14]], l_block[l_words[15]]);
+            }
+            for(unsigned int l_index = 0; l_index < 8; ++l_index)
+            {
+                l_chaining_value[l_index] = _mm256_xor_si256(l_state[l_index], l_state[l_index + 8]);
+            }
+        }
+        // Back to one row per chunk
+        transpose_avx2(l_chaining_value);
+        for(unsigned int l_input = 0; l_input < 8; ++l_input)
+        {
+            _mm256_storeu_si256((__m256i *)p_chaining_values[l_input], l_chaining_value[l_input]);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    blake3::transpose_avx512(__m512i * p_rows)
+    {
+        // At each step rows i and i + step exchange their words k + step and
+        // k, for k having bit step cleared, which swaps this bit of row and
+        // word indexes. Two sources permutations are used as unpack and
+        // shuffle intrinsics of GCC 12 trigger uninitialized warnings
+        for(unsigned int l_step = 8; l_step; l_step >>= 1)
+        {
+            uint32_t l_indexes[2][16];
+            for(unsigned int l_word = 0; l_word < 16; ++l_word)
+            {
+                l_indexes[0][l_word] = l_word & l_step ? 16 + l_word - l_step : l_word;
+                l_indexes[1][l_word] = l_word & l_step ? 16 + l_word : l_word + l_step;
+            }
+            __m512i l_first = _mm512_loadu_si512(l_indexes[0]);
+            __m512i l_second = _mm512_loadu_si512(l_indexes[1]);
+            for(unsigned int l_row = 0; l_row < 16; ++l_row)
+            {
+                if(!(l_row & l_step))
+                {
+                    __m512i l_row_value = p_rows[l_row];
+                    p_rows[l_row] = _mm512_permutex2var_epi32(l_row_value, l_first, p_rows[l_row + l_step]);
+                    p_rows[l_row + l_step] = _mm512_permutex2var_epi32(l_row_value, l_second, p_rows[l_row + l_step]);
+                }
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    template <int t_shift>
+    __m512i
+    blake3::rotate_right_avx512(__m512i p_value)
+    {
+        // Unmasked form of GCC 12 triggers an uninitialized warning
+        return _mm512_maskz_ror_epi32(0xFFFF, p_value, t_shift);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    blake3::g_avx512(__m512i & p_a
+                    ,__m512i & p_b
+                    ,__m512i & p_c
+                    ,__m512i & p_d
+                    ,__m512i p_x
+                    ,__m512i p_y
+                    )
+    {
+        p_a = _mm512_add_epi32(_mm512_add_epi32(p_a, p_b), p_x);
+        p_d = rotate_right_avx512<16>(_mm512_xor_si512(p_d, p_a));
+        p_c = _mm512_add_epi32(p_c, p_d);
+        p_b = rotate_right_avx512<12>(_mm512_xor_si512(p_b, p_c));
+        p_a = _mm512_add_epi32(_mm512_add_epi32(p_a, p_b), p_y);
+        p_d = rotate_right_avx512<8>(_mm512_xor_si512(p_d, p_a));
+        p_c = _mm512_add_epi32(p_c, p_d);
+        p_b = rotate_right_avx512<7>(_mm512_xor_si512(p_b, p_c));
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    blake3::hash_16_inputs_avx512(const uint8_t * p_data
+                              ,size_t p_nb_blocks
+                                 ,uint64_t p_counter
+                                 ,bool p_increment_counter
+                                 ,uint32_t p_flags
+                                 ,uint32_t p_flags_start
+                                 ,uint32_t p_flags_end
+                                 ,uint32_t (*p_chaining_values)[8]
+                                 )
+    {
+        const uint8_t (*l_schedule)[16] = get_schedule();
+        const uint32_t * l_iv = get_iv();
+
+        __m512i l_chaining_value[8];
+        for(unsigned int l_index = 0; l_index < 8; ++l_index)
+        {
+            l_chaining_value[l_index] = _mm512_set1_epi32((int)l_iv[l_index]);
+        }
+        uint32_t l_counters[2][16];
+        for(unsigned int l_input = 0; l_input < 16; ++l_input)
+        {
+            l_counters[0][l_input] = (uint32_t)(p_counter + (p_increment_counter ? l_input : 0));
+            l_counters[1][l_input] = (uint32_t)((p_counter + (p_increment_counter ? l_input : 0)) >> 32);
+        }
+        __m512i l_counter_low = _mm512_loadu_si512(l_counters[0]);
+        __m512i l_counter_high = _mm512_loadu_si512(l_counters[1]);
+        for(size_t l_block_index = 0; l_block_index < p_nb_blocks; ++l_block_index)
+        {
+            // A block is exactly one register
+            __m512i l_block[16];
+            for(unsigned int l_input = 0; l_input < 16; ++l_input)
+            {
+                l_block[l_input] = _mm512_loadu_si512(p_data + 64 * (l_input * p_nb_blocks + l_block_index));
+            }
+            transpose_avx512(l_block);
+            uint32_t l_flags = p_flags | (l_block_index ? 0 : p_flags_start) | (p_nb_blocks - 1 == l_block_index ? p_flags_end : 0);
+            __m512i l_state[16] = {l_chaining_value[0], l_chaining_value[1], l_chaining_value[2], l_chaining_value[3]
+                                  ,l_chaining_value[4], l_chaining_value[5], l_chaining_value[6], l_chaining_value[7]
+                                  ,_mm512_set1_epi32((int)l_iv[0]), _mm512_set1_epi32((int)l_iv[1]), _mm512_set1_epi32((int)l_iv[2]), _mm512_set1_epi32((int)l_iv[3])
+                                  ,l_counter_low, l_counter_high, _mm512_set1_epi32(64), _mm512_set1_epi32((int)l_flags)
+                                  };
+            for(unsigned int l_round = 0; l_round < 7; ++l_round)
+            {
+                const uint8_t * l_words = l_schedule[l_round];
+                g_avx512(l_state[0], l_state[4], l_state[8], l_state[12], l_block[l_words[0]], l_block[l_words[1]]);
+                g_avx512(l_state[1], l_state[5], l_state[9], l_state[13], l_block[l_words[2]], l_block[l_words[3]]);
+                g_avx512(l_state[2], l_state[6], l_state[10], l_state[14], l_block[l_words[4]], l_block[l_words[5]]);
+                g_avx512(l_state[3], l_state[7], l_state[11], l_state[15], l_block[l_words[6]], l_block[l_words[7]]);
+                g_avx512(l_state[0], l_state[5], l_state[10], l_state[15], l_block[l_words[8]], l_block[l_words[9]]);
+                g_avx512(l_state[1], l_state[6], l_state[11], l_state[12], l_block[l_words[10]], l_block[l_words[11]]);
+                g_avx512(l_state[2], l_state[7], l_state[8], l_state[13], l_block[l_words[12]], l_block[l_words[13]]);
+                g_avx512(l_state[3], l_state[4], l_state[9], l_state[14], l_block[l_words[14]], l_block[l_words[15]]);
+            }
+            for(unsigned int l_index = 0; l_index < 8; ++l_index)
+            {
+                l_chaining_value[l_index] = _mm512_xor_si512(l_state[l_index], l_state[l_index + 8]);
+            }
+        }
+        // Chaining values are only 8 words so they are spread back through
+        // memory
+        uint32_t l_words[8][16];
+        for(unsigned int l_index = 0; l_index < 8; ++l_index)
+        {
+            _mm512_storeu_si512(l_words[l_index], l_chaining_value[l_index]);
+        }
+        for(unsigned int l_input = 0; l_input < 16; ++l_input)
+        {
+            for(unsigned int l_index = 0; l_index < 8; ++l_index)
+            {
+                p_chaining_values[l_input][l_index] = l_words[l_index][l_input];
+            }
+        }
+    }
+#endif // x86 with GCC or clang
+
+}
+#endif //DUPLICATION_CHECKER_BLAKE3_H
+// EOF
@@ -19,9 +19,11 @@
 #ifndef DUPLICATION_CHECKER_CONFIG_DUMPER_H
 #define DUPLICATION_CHECKER_CONFIG_DUMPER_H
 
-#include "xmlParser.h"
-#include "rule.h"
-#include "keep_only.h"
+#include "xml_writer.h"
+#include "rule_set.h"
+#include "sha1_ignore_list.h"
+#include "keep_only_set.h"
+#include <functional>
 #include <set>
 #include <string>
 #include <vector>
@@ -35,9 +37,9 @@ namespace duplication_checker
         inline static
         void
         dump(const std::string & p_file_name
-            ,const std::vector<rule> & p_rules
-            ,const std::vector<keep_only> & p_keep_only
-            ,const std::map<std::string, std::string> & p_sha1_ignore_list
+            ,const rule_set & p_rules
+            ,const keep_only_set & p_keep_only
+            ,const sha1_ignore_list & p_sha1_ignore_list
             ,const std::set<std::string> & p_path_ignore_list
             );
 
@@ -47,64 +49,82 @@ namespace duplication_checker
     //-------------------------------------------------------------------------
     void
     config_dumper::dump(const std::string & p_file_name
-                       ,const std::vector<rule> & p_rules
-                       ,const std::vector<keep_only> & p_keep_only
-                       ,const std::map<std::string, std::string> & p_sha1_ignore_list
+                       ,const rule_set & p_rules
+                       ,const keep_only_set & p_keep_only
+                       ,const sha1_ignore_list & p_sha1_ignore_list
                        ,const std::set<std::string> & p_path_ignore_list
                        )
     {
-        XMLNode l_root = XMLNode::createXMLTopNode("duplication_checker");
+        // Elements are written as soon as they are built to avoid keeping a
+        // copy of whole configuration in memory
+        xml_writer l_writer(p_file_name);
+        l_writer.open("duplication_checker");
         if(!p_sha1_ignore_list.empty())
         {
-            XMLNode l_list = l_root.addChild("sha1_ignore_list");
-            for(const auto & l_iter: p_sha1_ignore_list)
+            l_writer.open("sha1_ignore_list");
+            std::function<void(const std::string &, const std::string &)> l_func = [&](const std::string & p_sha1, const std::string & p_comment) -> void
             {
-                XMLNode l_node = l_list.addChild("ignore");
-                l_node.addAttribute("sha1", l_iter.first.c_str());
-                l_node.addAttribute("comment", l_iter.second.c_str());
-            }
+                l_writer.open("ignore");
+                l_writer.add_attribute("sha1", p_sha1);
+                l_writer.add_attribute("comment", p_comment);
+                l_writer.close();
+            };
+            p_sha1_ignore_list.apply(l_func);
+            l_writer.close();
         }
         if(!p_path_ignore_list.empty())
         {
-            XMLNode l_list = l_root.addChild("path_ignore_list");
+            l_writer.open("path_ignore_list");
             for(const auto & l_iter: p_path_ignore_list)
             {
-                XMLNode l_node = l_list.addChild("ignore_path");
-                l_node.addAttribute("str", l_iter.c_str());
+                l_writer.open("ignore_path");
+                l_writer.add_attribute("str", l_iter);
+                l_writer.close();
             }
+            l_writer.close();
         }
         if(!p_rules.empty())
         {
-            XMLNode l_list = l_root.addChild("rules");
+            l_writer.open("rules");
             for(const auto & l_iter: p_rules)
             {
-                XMLNode l_node = l_list.addChild("rule");
-                l_node.addAttribute("cmd", rule::to_string(l_iter.get_cmd()).c_str());
-                l_node.addAttribute("file1", l_iter.get_path_1().c_str());
-                l_node.addAttribute("file2", l_iter.get_path_2().c_str());
+                l_writer.open("rule");
+                l_writer.add_attribute("cmd", rule::to_string(l_iter.get_cmd()));
+                l_writer.add_attribute("file1", l_iter.get_path_1());
+                l_writer.add_attribute("file2", l_iter.get_path_2());
+                l_writer.close();
             }
+            l_writer.close();
         }
         if(!p_keep_only.empty())
         {
-            XMLNode l_list = l_root.addChild("keep_only_list");
+            l_writer.open("keep_only_list");
+            std::function<void(const std::string & p_str)> l_keep_func = [&](const std::string & p_str) -> void
+            {
+                l_writer.open("keep");
+                l_writer.add_attribute("path", p_str);
+                l_writer.close();
+            };
+            std::function<void(const std::string & p_str)> l_rm_func = [&](const std::string & p_str) -> void
+            {
+                l_writer.open("remove");
+                l_writer.add_attribute("path", p_str);
+                l_writer.close();
+            };
             for(const auto & l_iter: p_keep_only)
             {
-                XMLNode l_node = l_list.addChild("keep_only");
-                XMLNode l_keep_list = l_node.addChild("keep_list");
-                std::function<void(const std::string & p_str)> l_keep_func = [&](const std::string & p_str) -> void
-                {
-                    l_keep_list.addChild("keep").addAttribute("path", p_str.c_str());
-                };
+                l_writer.open("keep_only");
+                l_writer.open("keep_list");
                 l_iter.apply_to_keep(l_keep_func);
-                XMLNode l_remove_list = l_node.addChild("remove_list");
-                std::function<void(const std::string & p_str)> l_rm_func = [&](const std::string & p_str) -> void
-                {
-                    l_remove_list.addChild("remove").addAttribute("path", p_str.c_str());
-                };
+                l_writer.close();
+                l_writer.open("remove_list");
                 l_iter.apply_to_remove(l_rm_func);
+                l_writer.close();
+                l_writer.close();
             }
+            l_writer.close();
         }
-        l_root.writeToFile(p_file_name.c_str());
+        l_writer.finish();
     }
 
 }
@@ -20,8 +20,9 @@
 #define DUPLICATION_CHECKER_CONFIG_PARSER_H
 
 #include "xmlParser.h"
-#include "rule.h"
-#include "keep_only.h"
+#include "rule_set.h"
+#include "sha1_ignore_list.h"
+#include "keep_only_set.h"
 #include "quicky_exception.h"
 #include <string>
 #include <vector>
@@ -33,9 +34,9 @@ namespace duplication_checker
     {
       public:
 
-        config_parser( std::vector<rule> & p_rules
-                     , std::map<std::string, std::string> & p_sha1_ignore_list
-                     , std::vector<keep_only> & p_keep_only
+        config_parser( rule_set & p_rules
+                     , sha1_ignore_list & p_sha1_ignore_list
+                     , keep_only_set & p_keep_only
                      , std::set<std::string> & p_path_ignore_list
                      );
 
@@ -62,16 +63,21 @@ namespace duplication_checker
                                , const std::string & p_string
                                );
 
-        std::vector<rule> & m_rules;
-        std::map<std::string, std::string> & m_sha1_ignore_list;
-        std::vector<keep_only> & m_keep_only;
+        rule_set & m_rules;
+        sha1_ignore_list & m_sha1_ignore_list;
+        keep_only_set & m_keep_only;
+
+        /**
+         * Keep only being parsed, added to m_keep_only once complete
+         */
+        keep_only m_pending_keep_only;
         std::set<std::string> & m_path_ignore_list;
     };
 
     //-------------------------------------------------------------------------
-    config_parser::config_parser( std::vector<rule> & p_rules
-                                , std::map<std::string, std::string> & p_sha1_ignore_list
-                                , std::vector<keep_only> & p_keep_only
+    config_parser::config_parser( rule_set & p_rules
+                                , sha1_ignore_list & p_sha1_ignore_list
+                                , keep_only_set & p_keep_only
                                 , std::set<std::string> & p_path_ignore_list
                                 )
     : m_rules(p_rules)
@@ -109,11 +115,6 @@ namespace duplication_checker
         }
 
         treat(l_node);
-
-        std::cout << std::to_string(m_rules.size()) + " rules imported" << std::endl;
-        std::cout << std::to_string(m_sha1_ignore_list.size()) + " SHA1 ignore imported" << std::endl;
-        std::cout << std::to_string(m_path_ignore_list.size()) + " path ignore imported" << std::endl;
-        std::cout << std::to_string(m_keep_only.size()) + " keep only imported" << std::endl;
     }
 
     //-------------------------------------------------------------------------
@@ -194,7 +195,7 @@ namespace duplication_checker
     {
         std::string l_sha1_attribute = get_mandatory_attribute(p_node, "sha1");
         std::string l_comment = p_node.getAttribute("comment") != nullptr ? p_node.getAttribute("comment") : "";
-        m_sha1_ignore_list.emplace(l_sha1_attribute, l_comment);
+        m_sha1_ignore_list.insert(l_sha1_attribute, l_comment);
     }
 
     //-------------------------------------------------------------------------
@@ -241,9 +242,10 @@ namespace duplication_checker
         {
             throw quicky_exception::quicky_logic_exception(R"(Node keep_only second child should be name "remove_list" instead of ")" + l_child_name + R"(")", __LINE__, __FILE__);
         }
-        m_keep_only.emplace_back();
+        m_pending_keep_only = keep_only();
         treat(p_node.getChildNode(0));
         treat(p_node.getChildNode(1));
+        m_keep_only.add(m_pending_keep_only);
     }
 
     //-------------------------------------------------------------------------
@@ -251,8 +253,7 @@ namespace duplication_checker
     config_parser::treat_remove(const XMLNode & p_node)
     {
         std::string l_path = get_mandatory_attribute(p_node, "path");
-        assert(!m_keep_only.empty());
-        m_keep_only.back().add_to_remove(l_path);
+        m_pending_keep_only.add_to_remove(l_path);
     }
 
     //-------------------------------------------------------------------------
@@ -260,8 +261,7 @@ namespace duplication_checker
     config_parser::treat_keep(const XMLNode & p_node)
     {
         std::string l_path = get_mandatory_attribute(p_node, "path");
-        assert(!m_keep_only.empty());
-        m_keep_only.back().add_to_keep(l_path);
+        m_pending_keep_only.add_to_keep(l_path);
     }
 
 }
@@ -0,0 +1,490 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_CONFIG_SNAPSHOT_H
+#define DUPLICATION_CHECKER_CONFIG_SNAPSHOT_H
+
+#include "keep_only_set.h"
+#include "mapped_file.h"
+#include "rule_set.h"
+#include "sha1.h"
+#include "sha1_ignore_list.h"
+#include "quicky_exception.h"
+#include <sys/stat.h>
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Compiled form of config.xml which is memory mapped at startup instead
+     * of building and walking an XML tree.
+     * File layout, integers are in host byte order:
+     * - header: magic, version, modification time and size of config.xml it
+     *   was compiled from, size of body
+     * - body: rules, keep only, SHA1 ignore list then path ignore list. Each
+     *   section starts with its number of entries, lengths and numbers are
+     *   varints. SHA1 are stored as binary digests followed by their text
+     *   and comment so that no hexadecimal has to be decoded
+     * - end magic
+     * Containers are sized from section counts before being filled
+     */
+    class config_snapshot
+    {
+      public:
+
+        /**
+         * Compile configuration in p_snapshot_name. Stamp of config.xml has
+         * to be taken with get_config_stamp before it is parsed so that a
+         * modification made while parsing invalidates snapshot.
+         * Snapshot is written in a temporary file then renamed so that a
+         * partially written snapshot is never loaded
+         */
+        static inline
+        void
+        save(const std::string & p_snapshot_name
+            ,uint64_t p_config_mtime
+            ,uint64_t p_config_size
+            ,const rule_set & p_rules
+            ,const keep_only_set & p_keep_only
+            ,const sha1_ignore_list & p_sha1_ignore_list
+            ,const std::set<std::string> & p_path_ignore_list
+            );
+
+        /**
+         * Load configuration from snapshot if it exists, is valid and has
+         * been compiled from current version of p_config_name
+         * @return false if configuration has to be read from p_config_name
+         */
+        static inline
+        bool
+        load(const std::string & p_snapshot_name
+            ,const std::string & p_config_name
+            ,rule_set & p_rules
+            ,keep_only_set & p_keep_only
+            ,sha1_ignore_list & p_sha1_ignore_list
+            ,std::set<std::string> & p_path_ignore_list
+            );
+
+        /**
+         * Get modification time in nanoseconds and size of config.xml
+         * @return false if file cannot be accessed
+         */
+        static inline
+        bool
+        get_config_stamp(const std::string & p_config_name
+                        ,uint64_t & p_mtime
+                        ,uint64_t & p_size
+                        );
+
+      private:
+
+        /**
+         * Sequential reader of snapshot body checking that reads stay inside
+         */
+        class reader
+        {
+          public:
+
+            inline
+            reader(const char * p_begin
+                  ,const char * p_end
+                  );
+
+            inline
+            bool
+            read_varint(uint64_t & p_value);
+
+            inline
+            bool
+            read_string(std::string & p_string);
+
+            inline
+            bool
+            read_bytes(uint8_t * p_bytes
+                      ,size_t p_size
+                      );
+
+            inline
+            bool
+            at_end() const;
+
+          private:
+
+            const char * m_pointer;
+
+            const char * m_end;
+        };
+
+        static inline
+        void
+        write_varint(std::string & p_output
+                    ,uint64_t p_value
+                    );
+
+        static inline
+        void
+        write_string(std::string & p_output
+                    ,const std::string & p_string
+                    );
+
+        static const uint64_t m_magic = 0x50414e5347464323ULL;
+
+        static const uint64_t m_end_magic = 0x444e452d50414e23ULL;
+
+        static const uint32_t m_version = 1;
+
+        static const size_t m_header_size = 40;
+    };
+
+    //-------------------------------------------------------------------------
+    void
+    config_snapshot::save(const std::string & p_snapshot_name
+                         ,uint64_t p_config_mtime
+                         ,uint64_t p_config_size
+                         ,const rule_set & p_rules
+                         ,const keep_only_set & p_keep_only
+                         ,const sha1_ignore_list & p_sha1_ignore_list
+                         ,const std::set<std::string> & p_path_ignore_list
+                         )
+    {
+        std::string l_body;
+        write_varint(l_body, p_rules.size());
+        for(const auto & l_iter: p_rules)
+        {
+            l_body.push_back((char)l_iter.get_cmd());
+            write_string(l_body, l_iter.get_path_1());
+            write_string(l_body, l_iter.get_path_2());
+        }
+
+        write_varint(l_body, p_keep_only.size());
+        std::vector<std::string> l_paths;
+        std::function<void(const std::string &)> l_path_func = [&](const std::string & p_path) -> void
+        {
+            l_paths.emplace_back(p_path);
+        };
+        for(const auto & l_iter: p_keep_only)
+        {
+            l_paths.clear();
+            l_iter.apply_to_keep(l_path_func);
+            size_t l_nb_keep = l_paths.size();
+            l_iter.apply_to_remove(l_path_func);
+            write_varint(l_body, l_nb_keep);
+            write_varint(l_body, l_paths.size() - l_nb_keep);
+            for(const auto & l_path: l_paths)
+            {
+                write_string(l_body, l_path);
+            }
+        }
+
+        write_varint(l_body, p_sha1_ignore_list.size());
+        std::function<void(const std::string &, const std::string &)> l_sha1_func = [&](const std::string & p_sha1, const std::string & p_comment) -> void
+        {
+            uint8_t l_digest[sha1::m_digest_size];
+            sha1::from_string(p_sha1, l_digest);
+            l_body.append((const char *)l_digest, sha1::m_digest_size);
+            write_string(l_body, p_sha1);
+            write_string(l_body, p_comment);
+        };
+        p_sha1_ignore_list.apply(l_sha1_func);
+
+        write_varint(l_body, p_path_ignore_list.size());
+        for(const auto & l_iter: p_path_ignore_list)
+        {
+            write_string(l_body, l_iter);
+        }
+
+        std::string l_tmp_name = p_snapshot_name + ".tmp";
+        std::ofstream l_output(l_tmp_name, std::ios::binary | std::ios::trunc);
+        if(!l_output.is_open())
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error opening output file ")" + l_tmp_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        uint64_t l_header[5] = {m_magic, 0, p_config_mtime, p_config_size, (uint64_t)l_body.size()};
+        uint32_t l_version = m_version;
+        memcpy(&l_header[1], &l_version, sizeof(l_version));
+        l_output.write((const char *)l_header, m_header_size);
+        l_output.write(l_body.data(), (std::streamsize)l_body.size());
+        uint64_t l_end_magic = m_end_magic;
+        l_output.write((const char *)&l_end_magic, sizeof(l_end_magic));
+        l_output.close();
+        if(l_output.fail() || rename(l_tmp_name.c_str(), p_snapshot_name.c_str()))
+        {
+            remove(l_tmp_name.c_str());
+            throw quicky_exception::quicky_runtime_exception(R"(Error writing config snapshot ")" + p_snapshot_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        std::cout << R"(Config snapshot ")" + p_snapshot_name + R"(" written)" << std::endl;
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    config_snapshot::load(const std::string & p_snapshot_name
+                         ,const std::string & p_config_name
+                         ,rule_set & p_rules
+                         ,keep_only_set & p_keep_only
+                         ,sha1_ignore_list & p_sha1_ignore_list
+                         ,std::set<std::string> & p_path_ignore_list
+                         )
+    {
+        struct stat l_stat;
+        uint64_t l_mtime;
+        uint64_t l_size;
+        if(stat(p_snapshot_name.c_str(), &l_stat) || !get_config_stamp(p_config_name, l_mtime, l_size))
+        {
+            return false;
+        }
+        mapped_file l_file(p_snapshot_name);
+        uint64_t l_header[5] = {0, 0, 0, 0, 0};
+        if(l_file.size() >= m_header_size + sizeof(uint64_t))
+        {
+            memcpy(l_header, l_file.data(), m_header_size);
+        }
+        uint32_t l_version;
+        memcpy(&l_version, &l_header[1], sizeof(l_version));
+        uint64_t l_end_magic = 0;
+        if(m_magic == l_header[0] && m_version == l_version && m_header_size + l_header[4] + sizeof(uint64_t) == l_file.size())
+        {
+            memcpy(&l_end_magic, l_file.data() + l_file.size() - sizeof(uint64_t), sizeof(l_end_magic));
+        }
+        if(m_end_magic != l_end_magic)
+        {
+            std::cerr << R"(WARNING : ")" << p_snapshot_name << R"(" is not a valid config snapshot, it will be regenerated)" << std::endl;
+            return false;
+        }
+        if(l_mtime != l_header[2] || l_size != l_header[3])
+        {
+            std::cout << R"(")" + p_config_name + R"(" modified since snapshot, it will be regenerated)" << std::endl;
+            return false;
+        }
+
+        // Decode in local containers so that a corrupted snapshot has no effect
+        rule_set l_rules;
+        keep_only_set l_keep_only;
+        sha1_ignore_list l_sha1_ignore_list;
+        std::set<std::string> l_path_ignore_list;
+        reader l_reader(l_file.data() + m_header_size, l_file.data() + m_header_size + l_header[4]);
+        uint64_t l_nb;
+        bool l_valid = l_reader.read_varint(l_nb);
+        if(l_valid)
+        {
+            l_rules.reserve((size_t)std::min(l_nb, (uint64_t)l_file.size()));
+        }
+        std::string l_path_1;
+        std::string l_path_2;
+        for(uint64_t l_index = 0; l_valid && l_index < l_nb; ++l_index)
+        {
+            uint8_t l_cmd;
+            l_valid = l_reader.read_bytes(&l_cmd, 1) &&
+                      l_cmd <= (uint8_t)rule::t_rule_cmd::LINK_SECOND &&
+                      l_reader.read_string(l_path_1) &&
+                      l_reader.read_string(l_path_2);
+            if(l_valid)
+            {
+                l_rules.emplace_back((rule::t_rule_cmd)l_cmd, l_path_1, l_path_2);
+            }
+        }
+
+        l_valid = l_valid && l_reader.read_varint(l_nb);
+        if(l_valid)
+        {
+            l_keep_only.reserve((size_t)std::min(l_nb, (uint64_t)l_file.size()));
+        }
+        for(uint64_t l_index = 0; l_valid && l_index < l_nb; ++l_index)
+        {
+            uint64_t l_nb_keep;
+            uint64_t l_nb_remove;
+            keep_only l_keep_only_item;
+            l_valid = l_reader.read_varint(l_nb_keep) && l_reader.read_varint(l_nb_remove);
+            for(uint64_t l_path_index = 0; l_valid && l_path_index < l_nb_keep + l_nb_remove; ++l_path_index)
+            {
+                l_valid = l_reader.read_string(l_path_1);
+                if(l_valid && l_path_index < l_nb_keep)
+                {
+                    l_keep_only_item.add_to_keep(l_path_1);
+                }
+                else if(l_valid)
+                {
+                    l_keep_only_item.add_to_remove(l_path_1);
+                }
+            }
+            if(l_valid)
+            {
+                l_keep_only.add(l_keep_only_item);
+            }
+        }
+
+        l_valid = l_valid && l_reader.read_varint(l_nb);
+        if(l_valid)
+        {
+            l_sha1_ignore_list.reserve((size_t)std::min(l_nb, (uint64_t)l_file.size()));
+        }
+        for(uint64_t l_index = 0; l_valid && l_index < l_nb; ++l_index)
+        {
+            uint8_t l_digest[sha1::m_digest_size];
+            l_valid = l_reader.read_bytes(l_digest, sha1::m_digest_size) &&
+                      l_reader.read_string(l_path_1) &&
+                      l_reader.read_string(l_path_2);
+            if(l_valid)
+            {
+                l_sha1_ignore_list.insert(l_digest, l_path_1, l_path_2);
+            }
+        }
+
+        l_valid = l_valid && l_reader.read_varint(l_nb);
+        for(uint64_t l_index = 0; l_valid && l_index < l_nb; ++l_index)
+        {
+            l_valid = l_reader.read_string(l_path_1);
+            if(l_valid)
+            {
+                l_path_ignore_list.emplace_hint(l_path_ignore_list.end(), l_path_1);
+            }
+        }
+
+        if(!l_valid || !l_reader.at_end())
+        {
+            std::cerr << R"(WARNING : ")" << p_snapshot_name << R"(" is corrupted, it will be regenerated)" << std::endl;
+            return false;
+        }
+        p_rules = std::move(l_rules);
+        p_keep_only = std::move(l_keep_only);
+        p_sha1_ignore_list = std::move(l_sha1_ignore_list);
+        p_path_ignore_list = std::move(l_path_ignore_list);
+        std::cout << R"(Config snapshot ")" + p_snapshot_name + R"(" loaded)" << std::endl;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    config_snapshot::write_varint(std::string & p_output
+                                 ,uint64_t p_value
+                                 )
+    {
+        while(p_value >= 0x80)
+        {
+            p_output.push_back((char)(0x80 | (p_value & 0x7F)));
+            p_value >>= 7;
+        }
+        p_output.push_back((char)p_value);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    config_snapshot::write_string(std::string & p_output
+                                 ,const std::string & p_string
+                                 )
+    {
+        write_varint(p_output, p_string.size());
+        p_output.append(p_string);
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    config_snapshot::get_config_stamp(const std::string & p_config_name
+                                     ,uint64_t & p_mtime
+                                     ,uint64_t & p_size
+                                     )
+    {
+        struct stat l_stat;
+        if(stat(p_config_name.c_str(), &l_stat))
+        {
+            return false;
+        }
+        p_mtime = (uint64_t)l_stat.st_mtim.tv_sec * 1000000000 + (uint64_t)l_stat.st_mtim.tv_nsec;
+        p_size = (uint64_t)l_stat.st_size;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    config_snapshot::reader::reader(const char * p_begin
+                                   ,const char * p_end
+                                   )
+    :m_pointer{p_begin}
+    ,m_end{p_end}
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    config_snapshot::reader::read_varint(uint64_t & p_value)
+    {
+        p_value = 0;
+        for(unsigned int l_shift = 0; m_pointer < m_end && l_shift < 64; l_shift += 7)
+        {
+            uint8_t l_byte = (uint8_t)*m_pointer++;
+            p_value |= (uint64_t)(l_byte & 0x7F) << l_shift;
+            if(!(l_byte & 0x80))
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    config_snapshot::reader::read_string(std::string & p_string)
+    {
+        uint64_t l_size;
+        if(!read_varint(l_size) || l_size > (uint64_t)(m_end - m_pointer))
+        {
+            return false;
+        }
+        p_string.assign(m_pointer, (size_t)l_size);
+        m_pointer += l_size;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    config_snapshot::reader::read_bytes(uint8_t * p_bytes
+                                       ,size_t p_size
+                                       )
+    {
+        if(p_size > (size_t)(m_end - m_pointer))
+        {
+            return false;
+        }
+        memcpy(p_bytes, m_pointer, p_size);
+        m_pointer += p_size;
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    config_snapshot::reader::at_end() const
+    {
+        return m_pointer == m_end;
+    }
+
+}
+#endif //DUPLICATION_CHECKER_CONFIG_SNAPSHOT_H
+// EOF
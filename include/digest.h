@@ -0,0 +1,298 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_DIGEST_H
+#define DUPLICATION_CHECKER_DIGEST_H
+
+#include "blake3.h"
+#include "sha1.h"
+#include "quicky_exception.h"
+#include <cstdint>
+#include <string>
+
+namespace duplication_checker
+{
+    /**
+     * Algorithm used to identify file contents. SHA1 is the one of sha1sum
+     * logs and of sha1 ignore list, BLAKE3 is faster than SHA1 on CPUs
+     * with AVX2
+     */
+    enum class digest_type
+    { SHA1
+    , BLAKE3
+    };
+
+    inline
+    digest_type
+    to_digest_type(const std::string & p_digest_type_str);
+
+    inline
+    std::string
+    to_string(digest_type p_digest_type);
+
+    /**
+     * Number of bytes of digest
+     */
+    inline
+    size_t
+    get_digest_size(digest_type p_digest_type);
+
+    /**
+     * Incremental computation of a digest of any type.
+     * Logs whose digests are not SHA1 start with a header line giving their
+     * type, a log without header is a sha1sum log
+     */
+    class digest
+    {
+      public:
+
+        /**
+         * Size of biggest digest
+         */
+        static const size_t m_max_size = 32;
+
+        inline explicit
+        digest(digest_type p_type);
+
+        inline
+        void
+        update(const uint8_t * p_data
+              ,size_t p_size
+              );
+
+        /**
+         * Complete computation and store digest in p_digest which must be
+         * at least get_digest_size(type) bytes long
+         */
+        inline
+        void
+        finalize(uint8_t * p_digest);
+
+        /**
+         * Lower case hexadecimal representation
+         */
+        static inline
+        std::string
+        to_string(const uint8_t * p_digest
+                 ,size_t p_size
+                 );
+
+        /**
+         * Convert hexadecimal representation of p_size characters to digest
+         * of any type, p_digest must be at least m_max_size bytes long
+         * @return size of digest, 0 if characters are not a valid digest
+         */
+        static inline
+        size_t
+        from_string(const char * p_data
+                   ,size_t p_size
+                   ,uint8_t * p_digest
+                   );
+
+        /**
+         * Header line of a log, without end of line
+         */
+        static inline
+        std::string
+        get_header(digest_type p_type);
+
+        /**
+         * Check if line is a log header
+         * @return true if line is a header, then type is stored in p_type
+         */
+        static inline
+        bool
+        parse_header(const std::string & p_line
+                    ,digest_type & p_type
+                    );
+
+      private:
+
+        digest_type m_type;
+
+        sha1 m_sha1;
+
+        blake3 m_blake3;
+    };
+
+    //-------------------------------------------------------------------------
+    digest_type
+    to_digest_type(const std::string & p_digest_type_str)
+    {
+        if("sha1" == p_digest_type_str)
+        {
+            return digest_type::SHA1;
+        }
+        else if("blake3" == p_digest_type_str)
+        {
+            return digest_type::BLAKE3;
+        }
+        throw quicky_exception::quicky_logic_exception(R"(Unknown digest ")" + p_digest_type_str + R"(")"
+                                                      ,__LINE__
+                                                      ,__FILE__
+                                                      );
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    to_string(digest_type p_digest_type)
+    {
+        switch(p_digest_type)
+        {
+            case digest_type::SHA1:
+                return "sha1";
+            case digest_type::BLAKE3:
+                return "blake3";
+            default:
+                throw quicky_exception::quicky_logic_exception("Unknown digest type value"
+                                                              ,__LINE__
+                                                              ,__FILE__
+                                                              );
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    size_t
+    get_digest_size(digest_type p_digest_type)
+    {
+        switch(p_digest_type)
+        {
+            case digest_type::SHA1:
+                return sha1::m_digest_size;
+            case digest_type::BLAKE3:
+                return blake3::m_digest_size;
+            default:
+                throw quicky_exception::quicky_logic_exception("Unknown digest type value"
+                                                              ,__LINE__
+                                                              ,__FILE__
+                                                              );
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    digest::digest(digest_type p_type)
+    :m_type{p_type}
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    digest::update(const uint8_t * p_data
+                  ,size_t p_size
+                  )
+    {
+        if(digest_type::SHA1 == m_type)
+        {
+            m_sha1.update(p_data, p_size);
+        }
+        else
+        {
+            m_blake3.update(p_data, p_size);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    digest::finalize(uint8_t * p_digest)
+    {
+        if(digest_type::SHA1 == m_type)
+        {
+            m_sha1.finalize(p_digest);
+        }
+        else
+        {
+            m_blake3.finalize(p_digest);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    digest::to_string(const uint8_t * p_digest
+                     ,size_t p_size
+                     )
+    {
+        static const char l_hexa[] = "0123456789abcdef";
+        std::string l_result(2 * p_size, '0');
+        for(size_t l_index = 0; l_index < p_size; ++l_index)
+        {
+            l_result[2 * l_index] = l_hexa[p_digest[l_index] >> 4];
+            l_result[2 * l_index + 1] = l_hexa[p_digest[l_index] & 0xF];
+        }
+        return l_result;
+    }
+
+    //-------------------------------------------------------------------------
+    size_t
+    digest::from_string(const char * p_data
+                       ,size_t p_size
+                       ,uint8_t * p_digest
+                       )
+    {
+        if(2 * sha1::m_digest_size != p_size && 2 * blake3::m_digest_size != p_size)
+        {
+            return 0;
+        }
+        for(size_t l_index = 0; l_index < p_size; ++l_index)
+        {
+            char l_char = p_data[l_index];
+            uint8_t l_value;
+            if('0' <= l_char && l_char <= '9')
+            {
+                l_value = (uint8_t)(l_char - '0');
+            }
+            else if('a' <= l_char && l_char <= 'f')
+            {
+                l_value = (uint8_t)(l_char - 'a' + 10);
+            }
+            else if('A' <= l_char && l_char <= 'F')
+            {
+                l_value = (uint8_t)(l_char - 'A' + 10);
+            }
+            else
+            {
+                return 0;
+            }
+            p_digest[l_index / 2] = l_index % 2 ? (uint8_t)(p_digest[l_index / 2] | l_value) : (uint8_t)(l_value << 4);
+        }
+        return p_size / 2;
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    digest::get_header(digest_type p_type)
+    {
+        return "#digest=" + duplication_checker::to_string(p_type);
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    digest::parse_header(const std::string & p_line
+                        ,digest_type & p_type
+                        )
+    {
+        if(p_line.compare(0, 8, "#digest="))
+        {
+            return false;
+        }
+        p_type = to_digest_type(p_line.substr(8));
+        return true;
+    }
+
+}
+#endif //DUPLICATION_CHECKER_DIGEST_H
+// EOF
@@ -19,16 +19,34 @@
 #ifndef DUPLICATION_CHECKER_DUPLICATION_CHECKER_H
 #define DUPLICATION_CHECKER_DUPLICATION_CHECKER_H
 
+#include "binary_index.h"
 #include "config_parser.h"
+#include "config_snapshot.h"
 #include "config_dumper.h"
-#include "rule.h"
+#include "digest.h"
+#include "file_verifier.h"
+#include "rule_set.h"
+#include "sha1_ignore_list.h"
 #include "item.h"
-#include "keep_only.h"
+#include "keep_only_set.h"
+#include "link_type.h"
+#include "log_reader.h"
+#include "log_sorter.h"
+#include "output_sink.h"
+#include "group_batch.h"
+#include "group_pipeline.h"
+#include "path_table.h"
+#include "removal_executor.h"
+#include "rule_profile.h"
+#include "run_statistics.h"
+#include "substring_matcher.h"
+#include "text_view.h"
 #include <fstream>
 #include <iostream>
 #include <vector>
 #include <set>
 #include <cassert>
+#include <memory>
 #include <string>
 
 namespace duplication_checker
@@ -37,75 +55,286 @@ namespace duplication_checker
     {
     public:
 
+        /**
+         * @param p_input_dir directory containing log and config.xml
+         * @param p_interactive ask user to create rules
+         * @param p_unsorted indicate that log has not been sorted. In this
+         * case sha1sum.log is read instead of sorted_sha1sum.log
+         * @param p_max_memory memory budget in bytes to sort unsorted log
+         * @param p_nb_threads number of threads to sort unsorted log and to
+         * process groups when not interactive
+         * @param p_removal_executor if not null, removals are applied by it
+         * in addition to being written in clean_cmd.bash
+         * @param p_link_type kind of link used by LINK_FIRST and LINK_SECOND
+         * rules in clean_cmd.bash
+         * @param p_verify check that files are still identical before
+         * removing them
+         * @param p_index_name if not empty, binary index read instead of log
+         * @param p_config_snapshot if not empty, compiled configuration
+         * loaded instead of config.xml. It is regenerated when config.xml
+         * has been modified
+         * @param p_statistics if not null, times of phases and counters are
+         * recorded in it
+         * @param p_rule_profile if not null, hits of rules are recorded in
+         * it and it may prune and reorder rules before config is dumped
+         */
         inline
         duplication_checker(const std::string & p_input_dir
                            ,bool p_interactive
+                           ,bool p_unsorted
+                           ,size_t p_max_memory
+                           ,unsigned int p_nb_threads
+                           ,removal_executor * p_removal_executor = nullptr
+                           ,link_type p_link_type = link_type::HARD
+                           ,bool p_verify = false
+                           ,const std::string & p_index_name = ""
+                           ,const std::string & p_config_snapshot = ""
+                           ,run_statistics * p_statistics = nullptr
+                           ,rule_profile * p_rule_profile = nullptr
                            );
 
         inline
         ~duplication_checker();
 
+        /**
+         * Process all groups of log then write updated config and close
+         * outputs
+         */
         inline
         void
         run();
 
+        /**
+         * Process a group of files having same SHA1 found without log, like
+         * in watch mode. Output is given to background writers and removals
+         * are executed immediately.
+         * Groups are processed by calling thread
+         */
+        inline
+        void
+        process_group(const std::string & p_sha1
+                     ,const std::vector<std::string> & p_filenames
+                     );
+
+        /**
+         * Write updated config and close outputs, called by run
+         * @param p_complete false if not all groups were processed, like when
+         * user quits or when watch mode stops
+         */
+        inline
+        void
+        finish(bool p_complete);
+
     private:
         static
         void
-        print_items(std::ofstream & p_file
+        print_items(std::ostream & p_stream
                    ,const std::vector<item> & p_items
                    );
 
+        /**
+         * Give current group to processing if it contains at least 2 files
+         */
+        inline
         void
-        process_duplicated();
+        end_group();
 
+        /**
+         * Create items of groups and process them. Output is stored in batch
+         * until it is written.
+         * Except in interactive mode only rules are read so several batches
+         * can be processed at the same time
+         * @param p_path_table table storing directories of items, it must not
+         * be shared with another thread
+         */
+        inline
         void
-        process_duplicated_couple();
+        process_batch(group_batch & p_batch
+                     ,path_table & p_path_table
+                     );
 
+        /**
+         * Write output of a batch, batches have to be written in order
+         */
+        inline
         void
-        process_duplicated_list();
+        write_batch(group_batch & p_batch);
 
+        /**
+         * Wall and CPU times spent processing and writing groups
+         */
+        inline
+        std::pair<uint64_t, uint64_t>
+        get_processing_time() const;
+
+        /**
+         * When verification is enabled, check that p_other is identical to
+         * p_reference. If not, reason is written in clean_cmd.bash
+         * @return true if p_other can be removed
+         */
+        inline
+        bool
+        verify(const std::string & p_reference
+              ,const std::string & p_other
+              ,group_output & p_output
+              );
+
+        /**
+         * Open log, sorting it first if needed
+         */
         inline
         void
-        generate_rm(const std::string & p_remove
+        open_log();
+
+        /**
+         * Give groups of log to processing
+         */
+        inline
+        void
+        read_log();
+
+        /**
+         * Give groups of binary index having several files to processing
+         */
+        inline
+        void
+        read_index();
+
+        /**
+         * SHA1 ignore list only applies to SHA1 digests, warn if it will not
+         * be applied because log or index uses another digest
+         */
+        inline
+        void
+        warn_sha1_ignore_list() const;
+
+        /**
+         * Get next line of sorted log
+         * @return false if there are no more lines
+         */
+        inline
+        bool
+        read_line(text_view & p_line);
+
+        void
+        process_duplicated_couple(std::vector<item> & p_items
+                                 ,group_output & p_output
+                                 );
+
+        void
+        process_duplicated_list(std::vector<item> & p_items
+                               ,group_output & p_output
+                               );
+
+        static inline
+        void
+        generate_rm(std::ostream & p_cmd
+                   ,const std::string & p_remove
                    ,const std::string & p_keep
                    );
 
-        inline
+        static inline
         void
-        generate_rm(const std::vector<std::string> & p_remove
+        generate_rm(std::ostream & p_cmd
+                   ,const std::vector<std::string> & p_remove
                    ,const std::vector<std::string> & p_keep
                    );
 
-        std::ifstream m_input_file;
+        /**
+         * Replace p_replace by a link to p_keep if p_keep exists and is not a
+         * symbolic link. Link is created with a temporary name then renamed
+         * so that p_replace is never missing
+         */
+        static inline
+        void
+        generate_link(std::ostream & p_cmd
+                     ,const std::string & p_replace
+                     ,const std::string & p_keep
+                     ,link_type p_link_type
+                     );
+
+        /**
+         * Provide lines when log is sorted
+         */
+        std::unique_ptr<log_reader> m_log_reader;
+
+        /**
+         * Provide sorted lines when log is not sorted
+         */
+        std::unique_ptr<log_sorter> m_log_sorter;
+
+        /**
+         * Provide groups directly when a binary index is used instead of log
+         */
+        std::unique_ptr<binary_index> m_index;
 
         /**
          * List duplicated files
          */
-        std::ofstream m_output_file;
+        std::unique_ptr<output_sink> m_output_file;
 
         /**
          * Command generated according to rules found in config files
          */
-        std::ofstream m_output_cmd_file;
+        std::unique_ptr<output_sink> m_output_cmd_file;
 
         /**
          * Rules loaded from config file
          */
-        std::vector<rule> m_rules;
+        rule_set m_rules;
 
         /**
          * Rules indicating which file to keep when there are more than 2 files
          * with same hase
          */
-        std::vector<keep_only> m_keep_only;
+        keep_only_set m_keep_only;
 
         /**
          * Hash to ignore
          */
-        std::map<std::string, std::string> m_sha1_ignore_list;
+        sha1_ignore_list m_sha1_ignore_list;
+
+        /**
+         * Digest used by log or index, SHA1 unless log starts with a header
+         */
+        digest_type m_digest_type;
+
+        /**
+         * SHA1 of current group, view on log content
+         */
+        text_view m_group_sha1;
+
+        /**
+         * Complete filenames of current group, views on log content.
+         * Items are only created when group contains several files
+         */
+        std::vector<text_view> m_group_filenames;
 
-        std::vector<item> m_duplicated_items;
+        /**
+         * Directories of duplicated items when groups are processed by
+         * reading thread
+         */
+        path_table m_path_table;
+
+        /**
+         * Groups waiting to be processed
+         */
+        std::unique_ptr<group_batch> m_batch;
+
+        /**
+         * Process groups in parallel when not interactive
+         */
+        std::unique_ptr<group_pipeline> m_pipeline;
+
+        /**
+         * Directories of duplicated items for each pipeline worker
+         */
+        std::vector<std::unique_ptr<path_table>> m_worker_path_tables;
+
+        /**
+         * Number of groups in a batch given to pipeline
+         */
+        static const size_t m_batch_size = 1024;
 
         /**
          * Remember couple of paths for which rules has been proposed
@@ -117,227 +346,800 @@ namespace duplication_checker
          */
         std::set<std::string> m_path_ignore_list;
 
+        /**
+         * Patterns of m_path_ignore_list compiled once config is parsed
+         */
+        std::unique_ptr<substring_matcher> m_path_ignore_matcher;
+
         bool m_interactive;
 
         bool m_exit;
+
+        unsigned int m_nb_threads;
+
+        removal_executor * m_removal_executor;
+
+        link_type m_link_type;
+
+        /**
+         * Check files before removing them if not null
+         */
+        std::unique_ptr<file_verifier> m_verifier;
+
+        /**
+         * sorted_sha1sum.log or sha1sum.log when log is not sorted
+         */
+        std::string m_log_name;
+
+        std::string m_index_name;
+
+        bool m_unsorted;
+
+        size_t m_max_memory;
+
+        /**
+         * Record times and counters if not null
+         */
+        run_statistics * m_statistics;
+
+        /**
+         * Record hits of rules if not null
+         */
+        rule_profile * m_rule_profile;
     };
 
     //-------------------------------------------------------------------------
     duplication_checker::duplication_checker(const std::string &p_input_dir
                                             ,bool p_interactive
+                                            ,bool p_unsorted
+                                            ,size_t p_max_memory
+                                            ,unsigned int p_nb_threads
+                                            ,removal_executor * p_removal_executor
+                                            ,link_type p_link_type
+                                            ,bool p_verify
+                                            ,const std::string & p_index_name
+                                            ,const std::string & p_config_snapshot
+                                            ,run_statistics * p_statistics
+                                            ,rule_profile * p_rule_profile
                                             )
-    :m_interactive{p_interactive}
+    :m_digest_type{digest_type::SHA1}
+    ,m_batch(new group_batch())
+    ,m_interactive{p_interactive}
     ,m_exit{false}
+    ,m_nb_threads{p_nb_threads}
+    ,m_removal_executor{p_removal_executor}
+    ,m_link_type{p_link_type}
+    ,m_log_name{p_input_dir + (p_unsorted ? "/sha1sum.log" : "/sorted_sha1sum.log")}
+    ,m_index_name{p_index_name}
+    ,m_unsorted{p_unsorted}
+    ,m_max_memory{p_max_memory}
+    ,m_statistics{p_statistics}
+    ,m_rule_profile{p_rule_profile}
     {
-        std::string l_input_file_name = p_input_dir + "/sorted_sha1sum.log";
-        m_input_file.open(l_input_file_name);
-        if(!m_input_file.is_open())
+        if(p_verify)
         {
-            throw quicky_exception::quicky_runtime_exception(R"(Error opening input file ")" + l_input_file_name + R"(")"
-                                                            ,__LINE__
-                                                            ,__FILE__
-                                                            );
+            m_verifier.reset(new file_verifier());
         }
 
+        run_statistics::timer l_config_start(m_statistics);
         std::string l_config_file_name = p_input_dir + "/config.xml";
-        config_parser l_parser(m_rules, m_sha1_ignore_list, m_keep_only, m_path_ignore_list);
-        l_parser.parse(l_config_file_name);
+        if(p_config_snapshot.empty() || !config_snapshot::load(p_config_snapshot, l_config_file_name, m_rules, m_keep_only, m_sha1_ignore_list, m_path_ignore_list))
+        {
+            // Stamp is taken before parsing so that a modification made
+            // meanwhile is detected at next run
+            uint64_t l_config_mtime = 0;
+            uint64_t l_config_size = 0;
+            if(!p_config_snapshot.empty() && !config_snapshot::get_config_stamp(l_config_file_name, l_config_mtime, l_config_size))
+            {
+                throw quicky_exception::quicky_runtime_exception(R"(Error getting modification time of ")" + l_config_file_name + R"(")"
+                                                                ,__LINE__
+                                                                ,__FILE__
+                                                                );
+            }
+            config_parser l_parser(m_rules, m_sha1_ignore_list, m_keep_only, m_path_ignore_list);
+            l_parser.parse(l_config_file_name);
+            if(!p_config_snapshot.empty())
+            {
+                config_snapshot::save(p_config_snapshot, l_config_mtime, l_config_size, m_rules, m_keep_only, m_sha1_ignore_list, m_path_ignore_list);
+            }
+        }
+        std::cout << std::to_string(m_rules.size()) + " rules imported" << std::endl;
+        std::cout << std::to_string(m_sha1_ignore_list.size()) + " SHA1 ignore imported" << std::endl;
+        std::cout << std::to_string(m_path_ignore_list.size()) + " path ignore imported" << std::endl;
+        std::cout << std::to_string(m_keep_only.size()) + " keep only imported" << std::endl;
+        if(m_rule_profile)
+        {
+            m_rule_profile->start(m_rules, m_keep_only);
+        }
+        if(m_statistics)
+        {
+            m_statistics->add_time(run_statistics::phase::CONFIG, l_config_start);
+        }
+        m_path_ignore_matcher.reset(new substring_matcher(m_path_ignore_list));
+
+        m_output_file.reset(new output_sink("duplicata.log"));
+        m_output_cmd_file.reset(new output_sink("clean_cmd.bash"));
+        m_output_cmd_file->write("#!/bin/bash\n");
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    duplication_checker::run()
+    {
+        run_statistics::timer l_input_start(m_statistics);
+        open_log();
+
+        // Interactive mode modifies rules so groups have to be processed in
+        // order by this thread
+        if(!m_interactive && m_nb_threads > 1)
+        {
+            for(unsigned int l_index = 0; l_index < m_nb_threads; ++l_index)
+            {
+                m_worker_path_tables.emplace_back(new path_table());
+            }
+            m_pipeline.reset(new group_pipeline(m_nb_threads
+                                               ,[&](group_batch & p_batch, unsigned int p_worker_index)
+                                                {
+                                                    process_batch(p_batch, *m_worker_path_tables[p_worker_index]);
+                                                }
+                                               ,[&](group_batch & p_batch)
+                                                {
+                                                    write_batch(p_batch);
+                                                }
+                                               )
+                            );
+        }
+
+        // Without pipeline groups are processed and written while reading
+        // so their time is removed from input time
+        std::pair<uint64_t, uint64_t> l_processing_start = m_statistics ? get_processing_time() : std::pair<uint64_t, uint64_t>(0, 0);
+        if(m_index)
+        {
+            read_index();
+        }
+        else
+        {
+            read_log();
+        }
+        if(m_statistics)
+        {
+            std::pair<uint64_t, uint64_t> l_processing = m_pipeline ? l_processing_start : get_processing_time();
+            m_statistics->add_time(run_statistics::phase::INPUT
+                                  ,l_input_start
+                                  ,std::make_pair(l_processing.first - l_processing_start.first, l_processing.second - l_processing_start.second)
+                                  );
+        }
 
-        std::string l_output_file_name = "duplicata.log";
-        m_output_file.open(l_output_file_name);
-        if(!m_output_file.is_open())
+        if(m_pipeline)
         {
-            throw quicky_exception::quicky_runtime_exception(R"(Error opening output file ")" + l_output_file_name + R"(")"
-                                                            ,__LINE__
-                                                            ,__FILE__
-                                                            );
+            if(m_batch->size())
+            {
+                m_pipeline->push(std::move(m_batch));
+            }
+            m_pipeline->finish();
+            m_pipeline.reset();
         }
 
-        std::string l_output_cmd_file_name = "clean_cmd.bash";
-        m_output_cmd_file.open(l_output_cmd_file_name);
-        if(!m_output_cmd_file.is_open())
+        finish(!m_exit);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    duplication_checker::process_group(const std::string & p_sha1
+                                      ,const std::vector<std::string> & p_filenames
+                                      )
+    {
+        if(m_exit)
+        {
+            return;
+        }
+        if(m_statistics)
+        {
+            m_statistics->add_lines(p_filenames.size());
+        }
+        uint8_t l_digest[sha1::m_digest_size];
+        if(sha1::from_string(p_sha1.data(), p_sha1.size(), l_digest) && sha1_ignore_list::m_not_found != m_sha1_ignore_list.find(l_digest))
+        {
+            if(m_statistics)
+            {
+                m_statistics->add_ignored_sha1();
+            }
+            return;
+        }
+        m_group_sha1 = text_view(p_sha1);
+        for(const auto & l_iter: p_filenames)
+        {
+            text_view l_complete_filename(l_iter);
+            if(!m_path_ignore_matcher->match(l_complete_filename))
+            {
+                m_group_filenames.emplace_back(l_complete_filename);
+            }
+            else if(m_statistics)
+            {
+                m_statistics->add_ignored_path();
+            }
+        }
+        // Files were just hashed so they must not have been modified since
+        if(m_verifier)
         {
-            throw quicky_exception::quicky_runtime_exception(R"(Error opening output cmd file ")" + l_output_cmd_file_name + R"(")"
-                                                            ,__LINE__
-                                                            , __FILE__
-                                                            );
+            m_verifier->set_log_time(time(nullptr));
+        }
+        // Without pipeline group is processed and written immediately
+        end_group();
+        m_output_file->hand_over();
+        m_output_cmd_file->hand_over();
+        if(m_removal_executor)
+        {
+            m_removal_executor->execute();
         }
-        m_output_cmd_file << "#!/bin/bash" << std::endl;
     }
 
     //-------------------------------------------------------------------------
     void
-    duplication_checker::run()
+    duplication_checker::finish(bool p_complete)
+    {
+        if(m_verifier)
+        {
+            m_verifier->print_statistics();
+        }
+
+        if(m_removal_executor)
+        {
+            m_removal_executor->finish();
+        }
+
+        run_statistics::timer l_dump_start(m_statistics);
+        if(m_rule_profile)
+        {
+            m_rule_profile->finish(m_rules, m_keep_only, p_complete);
+        }
+        config_dumper::dump("updated_config.xml", m_rules, m_keep_only, m_sha1_ignore_list, m_path_ignore_list);
+        run_statistics::timer l_output_start(m_statistics);
+        if(m_statistics)
+        {
+            m_statistics->add_time(run_statistics::phase::DUMP, l_dump_start);
+        }
+
+        m_output_file->close();
+        m_output_cmd_file->write("#EOF\n");
+        m_output_cmd_file->close();
+        if(m_statistics)
+        {
+            m_statistics->add_time(run_statistics::phase::OUTPUT, l_output_start);
+            m_statistics->add_bytes_written("duplicata.log", m_output_file->get_nb_bytes());
+            m_statistics->add_bytes_written("clean_cmd.bash", m_output_cmd_file->get_nb_bytes());
+            struct stat l_stat;
+            if(!stat("updated_config.xml", &l_stat))
+            {
+                m_statistics->add_bytes_written("updated_config.xml", (uint64_t)l_stat.st_size);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    duplication_checker::verify(const std::string & p_reference
+                               ,const std::string & p_other
+                               ,group_output & p_output
+                               )
+    {
+        if(!m_verifier)
+        {
+            return true;
+        }
+        std::string l_reason = m_verifier->verify(p_reference, p_other);
+        if(!l_reason.empty())
+        {
+            p_output.get_cmd() << R"(# Verification failed, ")" << p_other << R"(" is kept : )" << l_reason << "\n";
+            return false;
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    duplication_checker::open_log()
     {
-        std::string l_previous_sha1;
-        while(!m_input_file.eof() && !m_exit)
+        if(!m_index_name.empty())
         {
-            std::string l_line;
-            getline(m_input_file, l_line);
-            //std::cout << "\"" << l_line << "\"" << std::endl;
-            if(!l_line.empty())
+            m_log_name = m_index_name;
+            m_index.reset(new binary_index(m_index_name));
+        }
+        else if(m_unsorted)
+        {
+            m_log_sorter.reset(new log_sorter(m_log_name, m_max_memory, m_nb_threads));
+        }
+        else
+        {
+            m_log_reader.reset(new log_reader(m_log_name));
+        }
+        if(m_verifier)
+        {
+            struct stat l_stat;
+            if(stat(m_log_name.c_str(), &l_stat))
             {
+                throw quicky_exception::quicky_runtime_exception(R"(Unable to get modification time of ")" + m_log_name + R"(")"
+                                                                ,__LINE__
+                                                                ,__FILE__
+                                                                );
+            }
+            m_verifier->set_log_time(l_stat.st_mtime);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    duplication_checker::read_log()
+    {
+        text_view l_line;
+        uint32_t l_ignore_index = sha1_ignore_list::m_not_found;
+        bool l_valid_group = true;
+        // Lines are given to statistics by blocks to keep loop cheap
+        uint64_t l_nb_lines = 0;
+        bool l_first_line = true;
+        while(!m_exit && read_line(l_line))
+        {
+            if(!l_line.empty() && '#' == *l_line.data())
+            {
+                // Only first line can give digest type, digests of a log
+                // cannot be mixed
+                if(!l_first_line || !digest::parse_header(l_line.to_string(), m_digest_type))
+                {
+                    throw quicky_exception::quicky_runtime_exception(R"(Unexpected header ")" + l_line.to_string() + R"(" in ")" + m_log_name + R"(")"
+                                                                    ,__LINE__
+                                                                    ,__FILE__
+                                                                    );
+                }
+                std::cout << "Log digest : " << to_string(m_digest_type) << std::endl;
+                warn_sha1_ignore_list();
+                l_first_line = false;
+            }
+            else if(!l_line.empty())
+            {
+                l_first_line = false;
+                if(!(++l_nb_lines & 0xFFFF) && m_statistics)
+                {
+                    m_statistics->add_lines(0x10000);
+                }
                 // Extract SHA1 and file name
                 size_t l_space_pos = l_line.find(' ');
                 assert(std::string::npos != l_space_pos);
-                std::string l_sha1 = l_line.substr(0, l_space_pos);
-                std::string l_complete_filename = l_line.substr(l_space_pos + 2);
-                //std::cout << "\"" << l_sha1 << "\"" << std::endl;
-                //std::cout << "\"" << l_complete_filename << "\"" << std::endl;
+                text_view l_sha1 = l_line.substr(0, l_space_pos);
+                text_view l_complete_filename = l_line.substr(l_space_pos + 2);
 
                 // Sha1 change detection
-                if(l_sha1 != l_previous_sha1)
+                if(l_sha1 != m_group_sha1)
                 {
-                    process_duplicated();
-                    l_previous_sha1 = l_sha1;
+                    end_group();
+                    m_group_sha1 = l_sha1;
+                    // sha1sum prefixes digest with a backslash when it
+                    // escapes file name
+                    l_valid_group = '\\' != *l_sha1.data();
+                    // Log without header is a SHA1 log
+                    if(l_valid_group)
+                    {
+                        if(2 * get_digest_size(m_digest_type) != l_sha1.size())
+                        {
+                            throw quicky_exception::quicky_runtime_exception(R"(Digest ")" + l_sha1.to_string() + R"(" of ")" + m_log_name + R"(" is not a )" + to_string(m_digest_type) + " digest, digests cannot be mixed"
+                                                                            ,__LINE__
+                                                                            ,__FILE__
+                                                                            );
+                        }
+                    }
+                    uint8_t l_digest[digest::m_max_size];
+                    l_valid_group = l_valid_group && digest::from_string(l_sha1.data(), l_sha1.size(), l_digest);
+                    if(digest_type::SHA1 == m_digest_type && l_valid_group)
+                    {
+                        l_ignore_index = m_sha1_ignore_list.find(l_digest);
+                        if(sha1_ignore_list::m_not_found != l_ignore_index && m_statistics)
+                        {
+                            m_statistics->add_ignored_sha1();
+                        }
+                    }
                 }
-                if(m_sha1_ignore_list.end() == m_sha1_ignore_list.find(l_sha1))
+                if(!l_valid_group)
                 {
-                    auto l_iter = std::find_if(m_path_ignore_list.begin()
-                                              ,m_path_ignore_list.end()
-                                              ,[&](const std::string & p_string) -> bool
-                                               {
-                                                  return std::string::npos != l_complete_filename.find(p_string);
-                                               }
-                                              );
-                    if(l_iter == m_path_ignore_list.end())
+                    std::cout << R"(WARNING : ignore ")" << l_complete_filename.to_string() << R"(" of ")" << m_log_name << ('\\' == *l_sha1.data() ? R"(" whose name is escaped by sha1sum)" : R"(" with invalid digest ")" + l_sha1.to_string() + R"(")") << std::endl;
+                }
+                else if(sha1_ignore_list::m_not_found == l_ignore_index)
+                {
+                    if(!m_path_ignore_matcher->match(l_complete_filename))
+                    {
+                        m_group_filenames.emplace_back(l_complete_filename);
+                    }
+                    else if(m_statistics)
                     {
-                        m_duplicated_items.emplace_back(l_sha1, l_complete_filename);
+                        m_statistics->add_ignored_path();
                     }
                 }
-                else if(m_sha1_ignore_list[l_sha1].empty())
+                else if(m_sha1_ignore_list.get_comment(l_ignore_index).empty())
                 {
-                    m_sha1_ignore_list[l_sha1] = l_complete_filename;
+                    m_sha1_ignore_list.set_comment(l_ignore_index, l_complete_filename.to_string());
                 }
             }
-            else if(m_duplicated_items.size() >= 2)
+            else if(m_group_filenames.size() >= 2)
             {
-                process_duplicated();
+                end_group();
             }
         }
+        if(m_statistics)
+        {
+            m_statistics->add_lines(l_nb_lines & 0xFFFF);
+        }
+    }
 
-        config_dumper::dump("updated_config.xml", m_rules, m_keep_only, m_sha1_ignore_list, m_path_ignore_list);
+    //-------------------------------------------------------------------------
+    void
+    duplication_checker::warn_sha1_ignore_list() const
+    {
+        if(digest_type::SHA1 != m_digest_type && m_sha1_ignore_list.size())
+        {
+            std::cout << "WARNING : SHA1 ignore list not applied to " << to_string(m_digest_type) << " digests" << std::endl;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    duplication_checker::read_index()
+    {
+        m_digest_type = m_index->get_digest_type();
+        if(digest_type::SHA1 != m_digest_type)
+        {
+            std::cout << "Index digest : " << to_string(m_digest_type) << std::endl;
+            warn_sha1_ignore_list();
+        }
+        // As when reading log, SHA1 to ignore without comment are commented
+        // with first file having this SHA1
+        std::vector<std::string> l_uncommented;
+        std::function<void(const std::string &, const std::string &)> l_collect = [&](const std::string & p_sha1, const std::string & p_comment)
+        {
+            if(p_comment.empty())
+            {
+                l_uncommented.emplace_back(p_sha1);
+            }
+        };
+        if(digest_type::SHA1 == m_digest_type)
+        {
+            m_sha1_ignore_list.apply(l_collect);
+        }
+        if(m_statistics)
+        {
+            m_statistics->add_lines(m_index->get_nb_files());
+        }
+        std::vector<std::string> l_paths;
+        for(const auto & l_iter: l_uncommented)
+        {
+            uint8_t l_digest[sha1::m_digest_size];
+            sha1::from_string(l_iter, l_digest);
+            uint64_t l_group = m_index->find(l_digest);
+            if(binary_index::m_not_found != l_group)
+            {
+                m_index->get_paths(l_group, l_paths);
+                m_sha1_ignore_list.set_comment(m_sha1_ignore_list.find(l_digest), l_paths.front());
+            }
+        }
+
+        for(uint64_t l_index = 0; !m_exit && l_index < m_index->get_nb_duplicated_groups(); ++l_index)
+        {
+            uint64_t l_group = m_index->get_duplicated_group(l_index);
+            const uint8_t * l_digest = m_index->get_digest(l_group);
+            if(digest_type::SHA1 == m_digest_type && sha1_ignore_list::m_not_found != m_sha1_ignore_list.find(l_digest))
+            {
+                if(m_statistics)
+                {
+                    m_statistics->add_ignored_sha1();
+                }
+                continue;
+            }
+            // Views on stored text stay valid until batch is written
+            m_group_sha1 = m_batch->store(digest::to_string(l_digest, get_digest_size(m_digest_type)));
+            m_index->get_paths(l_group, l_paths);
+            for(const auto & l_path: l_paths)
+            {
+                if(!m_path_ignore_matcher->match(text_view(l_path)))
+                {
+                    m_group_filenames.emplace_back(m_batch->store(l_path));
+                }
+                else if(m_statistics)
+                {
+                    m_statistics->add_ignored_path();
+                }
+            }
+            end_group();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    duplication_checker::read_line(text_view & p_line)
+    {
+        if(m_log_sorter)
+        {
+            return m_log_sorter->get_line(p_line);
+        }
+        return m_log_reader->get_line(p_line);
     }
 
     //-------------------------------------------------------------------------
     void
-    duplication_checker::generate_rm(const std::string & p_remove
+    duplication_checker::generate_rm(std::ostream & p_cmd
+                                    ,const std::string & p_remove
                                     ,const std::string & p_keep
                                     )
     {
-        m_output_cmd_file << "if [ ! -L " << p_keep << " -a -f " << p_keep << " ]" << std::endl;
-        m_output_cmd_file << "then" << std::endl;
-        m_output_cmd_file << "    rm " << p_remove << std::endl;
-        m_output_cmd_file << "elif [ -L " << p_keep << "  ]" << std::endl;
-        m_output_cmd_file << "then" << std::endl;
-        m_output_cmd_file << R"(    echo ")" << p_keep << R"(" is a link)" << std::endl;
-        m_output_cmd_file << "else" << std::endl;
-        m_output_cmd_file << R"(    echo ")" << p_keep << R"(" do not exist)" << std::endl;
-        m_output_cmd_file << "fi" << std::endl;
+        p_cmd << "if [ ! -L " << p_keep << " -a -f " << p_keep << " ]\n";
+        p_cmd << "then\n";
+        p_cmd << "    rm " << p_remove << "\n";
+        p_cmd << "elif [ -L " << p_keep << "  ]\n";
+        p_cmd << "then\n";
+        p_cmd << R"(    echo ")" << p_keep << R"(" is a link)" << "\n";
+        p_cmd << "else\n";
+        p_cmd << R"(    echo ")" << p_keep << R"(" do not exist)" << "\n";
+        p_cmd << "fi\n";
     }
 
     //-------------------------------------------------------------------------
     void
-    duplication_checker::generate_rm(const std::vector<std::string> & p_remove
+    duplication_checker::generate_rm(std::ostream & p_cmd
+                                    ,const std::vector<std::string> & p_remove
                                     ,const std::vector<std::string> & p_keep
                                     )
     {
-        m_output_cmd_file << "ok_to_rm=1" << std::endl;
+        p_cmd << "ok_to_rm=1\n";
         for(const auto & l_iter: p_keep)
         {
-            m_output_cmd_file << std::endl << R"(# Keep only : ")" << l_iter << R"(")" << std::endl;
-            m_output_cmd_file << "if [ ! -f " << l_iter << " -o -L " << l_iter << " ]" << std::endl;
-            m_output_cmd_file << "then" << std::endl;
-            m_output_cmd_file << "    ok_to_rm=0" << std::endl;
-            m_output_cmd_file << "    if [ ! -f " << l_iter << " ]" << std::endl;
-            m_output_cmd_file << "    then" << std::endl;
-            m_output_cmd_file << R"(        echo "File )" << l_iter << R"( is missing")" << std::endl;
-            m_output_cmd_file << "    else" << std::endl;
-            m_output_cmd_file << R"(        echo "File )" << l_iter << R"( is a link")" << std::endl;
-            m_output_cmd_file << "    fi" << std::endl;
-            m_output_cmd_file << "fi" << std::endl;
-        }
-        m_output_cmd_file << "if [ $ok_to_rm -eq 1  ]" << std::endl;
-        m_output_cmd_file << "then" << std::endl;
+            p_cmd << "\n" << R"(# Keep only : ")" << l_iter << R"(")" << "\n";
+            p_cmd << "if [ ! -f " << l_iter << " -o -L " << l_iter << " ]\n";
+            p_cmd << "then\n";
+            p_cmd << "    ok_to_rm=0\n";
+            p_cmd << "    if [ ! -f " << l_iter << " ]\n";
+            p_cmd << "    then\n";
+            p_cmd << R"(        echo "File )" << l_iter << R"( is missing")" << "\n";
+            p_cmd << "    else\n";
+            p_cmd << R"(        echo "File )" << l_iter << R"( is a link")" << "\n";
+            p_cmd << "    fi\n";
+            p_cmd << "fi\n";
+        }
+        p_cmd << "if [ $ok_to_rm -eq 1  ]\n";
+        p_cmd << "then\n";
         for(const auto & l_iter: p_remove)
         {
-            m_output_cmd_file << "    rm " << l_iter << std::endl;
+            p_cmd << "    rm " << l_iter << "\n";
         }
-        m_output_cmd_file << "fi" << std::endl;
+        p_cmd << "fi\n";
     }
 
     //-------------------------------------------------------------------------
     void
-    duplication_checker::process_duplicated()
+    duplication_checker::generate_link(std::ostream & p_cmd
+                                      ,const std::string & p_replace
+                                      ,const std::string & p_keep
+                                      ,link_type p_link_type
+                                      )
     {
-        // 2 items with same Sha1
-        if(2 == m_duplicated_items.size())
+        std::string l_temporary = p_replace + ".dc_tmp";
+        p_cmd << "if [ ! -L " << p_keep << " -a -f " << p_keep << " ]\n";
+        p_cmd << "then\n";
+        p_cmd << "    " << (link_type::HARD == p_link_type ? "ln -f " : "cp --reflink=always -p ") << p_keep << " " << l_temporary;
+        p_cmd << " && mv -f " << l_temporary << " " << p_replace << " || rm -f " << l_temporary << "\n";
+        p_cmd << "elif [ -L " << p_keep << "  ]\n";
+        p_cmd << "then\n";
+        p_cmd << R"(    echo ")" << p_keep << R"(" is a link)" << "\n";
+        p_cmd << "else\n";
+        p_cmd << R"(    echo ")" << p_keep << R"(" do not exist)" << "\n";
+        p_cmd << "fi\n";
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    duplication_checker::end_group()
+    {
+        if(m_group_filenames.size() >= 2)
+        {
+            m_batch->add_group(m_group_sha1, m_group_filenames);
+            if(!m_pipeline)
+            {
+                process_batch(*m_batch, m_path_table);
+                write_batch(*m_batch);
+                m_batch->clear();
+            }
+            else if(m_batch->size() >= m_batch_size)
+            {
+                m_pipeline->push(std::move(m_batch));
+                m_batch.reset(new group_batch());
+            }
+        }
+        m_group_filenames.clear();
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    duplication_checker::process_batch(group_batch & p_batch
+                                      ,path_table & p_path_table
+                                      )
+    {
+        run_statistics::timer l_start(m_statistics);
+        std::vector<item> l_items;
+        for(size_t l_index = 0; l_index < p_batch.size(); ++l_index)
+        {
+            const std::vector<text_view> & l_filenames = p_batch.get_filenames(l_index);
+            if(m_statistics)
+            {
+                m_statistics->add_group(l_filenames.size());
+            }
+            l_items.reserve(l_filenames.size());
+            for(const auto & l_iter: l_filenames)
+            {
+                l_items.emplace_back(p_batch.get_sha1(l_index), l_iter, p_path_table);
+            }
+            // 2 items with same Sha1
+            if(2 == l_items.size())
+            {
+                process_duplicated_couple(l_items, p_batch.get_output());
+            }
+            else
+            {
+                process_duplicated_list(l_items, p_batch.get_output());
+            }
+            l_items.clear();
+        }
+        if(m_statistics)
+        {
+            m_statistics->add_time(run_statistics::phase::GROUPS, l_start);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    duplication_checker::write_batch(group_batch & p_batch)
+    {
+        run_statistics::timer l_start(m_statistics);
+        group_output & l_output = p_batch.get_output();
+        l_output.write(*m_output_file, *m_output_cmd_file);
+        // If there were no rules propose 1 that do nothing
+        for(const auto & l_iter: l_output.get_proposed_rules())
         {
-            process_duplicated_couple();
+            if(m_proposed_rules.insert(l_iter).second)
+            {
+                std::cout << R"(<rule cmd="IGNORE" file1=")" << l_iter.first << R"(" file2=")" << l_iter.second << R"(" />)" << std::endl;
+            }
         }
-        else if(m_duplicated_items.size() >= 2)
+        for(const auto & l_iter: l_output.get_removals())
         {
-            process_duplicated_list();
+            m_removal_executor->add(l_iter.m_keep, l_iter.m_remove, l_iter.m_link);
         }
-        m_duplicated_items.clear();
+        if(m_statistics)
+        {
+            m_statistics->add_time(run_statistics::phase::OUTPUT, l_start);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    std::pair<uint64_t, uint64_t>
+    duplication_checker::get_processing_time() const
+    {
+        std::pair<uint64_t, uint64_t> l_groups = m_statistics->get_time(run_statistics::phase::GROUPS);
+        std::pair<uint64_t, uint64_t> l_output = m_statistics->get_time(run_statistics::phase::OUTPUT);
+        return std::make_pair(l_groups.first + l_output.first, l_groups.second + l_output.second);
     }
 
     //-------------------------------------------------------------------------
     void
-    duplication_checker::process_duplicated_couple()
+    duplication_checker::process_duplicated_couple(std::vector<item> & p_items
+                                                  ,group_output & p_output
+                                                  )
     {
-        assert(m_duplicated_items.size() == 2);
-        bool l_matched = false;
+        assert(p_items.size() == 2);
         // Search if there is a rule for this items
-        for(const auto & l_iter_rule: m_rules)
+        const rule * l_rule = m_rules.find(p_items[0].get_path(), p_items[1].get_path());
+        if(l_rule)
         {
-            if(l_iter_rule.match(m_duplicated_items[0].get_path(), m_duplicated_items[1].get_path()))
+            if(m_statistics)
             {
-                l_matched = true;
-                // Apply rule
-                switch(l_iter_rule.get_cmd())
-                {
-                    case rule::t_rule_cmd::RM_FIRST:
-                        m_output_cmd_file << std::endl << "# Rule : RM_FIRST \"" << l_iter_rule.get_path_1() << "\" \"" << l_iter_rule.get_path_2() << "\"" << std::endl;
-                        generate_rm(m_duplicated_items[0].get_despecialised_complete_filename()
-                                   , m_duplicated_items[1].get_despecialised_complete_filename()
+                m_statistics->add_rule_hit(l_rule->get_cmd());
+            }
+            if(m_rule_profile)
+            {
+                m_rule_profile->add_rule_hit(m_rules.index_of(l_rule));
+            }
+            // Apply rule
+            switch(l_rule->get_cmd())
+            {
+                case rule::t_rule_cmd::RM_FIRST:
+                    p_output.get_cmd() << "\n# Rule : RM_FIRST \"" << l_rule->get_path_1() << "\" \"" << l_rule->get_path_2() << "\"\n";
+                    if(verify(p_items[1].get_complete_filename(), p_items[0].get_complete_filename(), p_output))
+                    {
+                        generate_rm(p_output.get_cmd()
+                                   , p_items[0].get_despecialised_complete_filename()
+                                   , p_items[1].get_despecialised_complete_filename()
                                    );
-                        break;
-                    case rule::t_rule_cmd::RM_SECOND:
-                        m_output_cmd_file << std::endl << "# Rule : RM_SECOND \"" << l_iter_rule.get_path_1() << "\" \"" << l_iter_rule.get_path_2() << "\"" << std::endl;
-                        generate_rm(m_duplicated_items[1].get_despecialised_complete_filename()
-                                   , m_duplicated_items[0].get_despecialised_complete_filename()
+                        if(m_removal_executor)
+                        {
+                            p_output.add_removal(std::vector<std::string>(1, p_items[1].get_complete_filename())
+                                                ,std::vector<std::string>(1, p_items[0].get_complete_filename())
+                                                );
+                        }
+                    }
+                    break;
+                case rule::t_rule_cmd::RM_SECOND:
+                    p_output.get_cmd() << "\n# Rule : RM_SECOND \"" << l_rule->get_path_1() << "\" \"" << l_rule->get_path_2() << "\"\n";
+                    if(verify(p_items[0].get_complete_filename(), p_items[1].get_complete_filename(), p_output))
+                    {
+                        generate_rm(p_output.get_cmd()
+                                   , p_items[1].get_despecialised_complete_filename()
+                                   , p_items[0].get_despecialised_complete_filename()
                                    );
-                        break;
-                    case rule::t_rule_cmd::IGNORE:
-                        break;
-                    case rule::t_rule_cmd::SKIP:
-                        print_items(m_output_file, m_duplicated_items);
-                        break;
-                    default:
-                        throw quicky_exception::quicky_logic_exception(R"(Unkown value ")" + rule::to_string(l_iter_rule.get_cmd()) + R"(")"
-                                                                      ,__LINE__
-                                                                      ,__FILE__
-                                                                      );
-                }
-                m_duplicated_items.clear();
-                break;
+                        if(m_removal_executor)
+                        {
+                            p_output.add_removal(std::vector<std::string>(1, p_items[0].get_complete_filename())
+                                                ,std::vector<std::string>(1, p_items[1].get_complete_filename())
+                                                );
+                        }
+                    }
+                    break;
+                case rule::t_rule_cmd::LINK_FIRST:
+                    p_output.get_cmd() << "\n# Rule : LINK_FIRST \"" << l_rule->get_path_1() << "\" \"" << l_rule->get_path_2() << "\"\n";
+                    if(verify(p_items[1].get_complete_filename(), p_items[0].get_complete_filename(), p_output))
+                    {
+                        generate_link(p_output.get_cmd()
+                                     , p_items[0].get_despecialised_complete_filename()
+                                     , p_items[1].get_despecialised_complete_filename()
+                                     , m_link_type
+                                     );
+                        if(m_removal_executor)
+                        {
+                            p_output.add_removal(std::vector<std::string>(1, p_items[1].get_complete_filename())
+                                                ,std::vector<std::string>(1, p_items[0].get_complete_filename())
+                                                ,true
+                                                );
+                        }
+                    }
+                    break;
+                case rule::t_rule_cmd::LINK_SECOND:
+                    p_output.get_cmd() << "\n# Rule : LINK_SECOND \"" << l_rule->get_path_1() << "\" \"" << l_rule->get_path_2() << "\"\n";
+                    if(verify(p_items[0].get_complete_filename(), p_items[1].get_complete_filename(), p_output))
+                    {
+                        generate_link(p_output.get_cmd()
+                                     , p_items[1].get_despecialised_complete_filename()
+                                     , p_items[0].get_despecialised_complete_filename()
+                                     , m_link_type
+                                     );
+                        if(m_removal_executor)
+                        {
+                            p_output.add_removal(std::vector<std::string>(1, p_items[0].get_complete_filename())
+                                                ,std::vector<std::string>(1, p_items[1].get_complete_filename())
+                                                ,true
+                                                );
+                        }
+                    }
+                    break;
+                case rule::t_rule_cmd::IGNORE:
+                    break;
+                case rule::t_rule_cmd::SKIP:
+                    print_items(p_output.get_duplicata(), p_items);
+                    break;
+                default:
+                    throw quicky_exception::quicky_logic_exception(R"(Unkown value ")" + rule::to_string(l_rule->get_cmd()) + R"(")"
+                                                                  ,__LINE__
+                                                                  ,__FILE__
+                                                                  );
             }
+            p_items.clear();
         }
-        if(!l_matched)
+        else
         {
-            print_items(m_output_file, m_duplicated_items);
+            print_items(p_output.get_duplicata(), p_items);
             // No interactive mode when both have same path because it is not possible to know which one to choose based on the path !
-            if(m_interactive && m_duplicated_items[0].get_path() != m_duplicated_items[1].get_path())
+            if(m_interactive && p_items[0].get_path() != p_items[1].get_path())
             {
-                std::cout << m_duplicated_items[0].get_complete_filename() << std::endl;
-                std::cout << m_duplicated_items[1].get_complete_filename() << std::endl;
+                std::cout << p_items[0].get_complete_filename() << std::endl;
+                std::cout << p_items[1].get_complete_filename() << std::endl;
                 bool l_valid_cmd;
                 rule::t_rule_cmd l_cmd;
                 do
                 {
                     l_valid_cmd = true;
-                    std::cout << "Create a rule ? [s/i/rf/rs/q]" << std::endl;
+                    std::cout << "Create a rule ? [s/i/rf/rs/lf/ls/q]" << std::endl;
                     std::string l_choice;
                     std::cin >> l_choice;
                     if(l_choice == "s" || l_choice.empty())
@@ -356,6 +1158,14 @@ namespace duplication_checker
                     {
                         l_cmd = rule::t_rule_cmd::RM_SECOND;
                     }
+                    else if(l_choice == "lf")
+                    {
+                        l_cmd = rule::t_rule_cmd::LINK_FIRST;
+                    }
+                    else if(l_choice == "ls")
+                    {
+                        l_cmd = rule::t_rule_cmd::LINK_SECOND;
+                    }
                     else if(l_choice == "q")
                     {
                         m_exit = true;
@@ -366,62 +1176,87 @@ namespace duplication_checker
                         l_valid_cmd = false;
                     }
                 } while(!l_valid_cmd);
-                m_rules.emplace_back(l_cmd, m_duplicated_items[0].get_path(), m_duplicated_items[1].get_path());
+                m_rules.emplace_back(l_cmd, p_items[0].get_path(), p_items[1].get_path());
             }
             // If there were no rules propose 1 that do nothing
-            else if(m_proposed_rules.end() == m_proposed_rules.find(make_pair(m_duplicated_items[0].get_path(), m_duplicated_items[1].get_path())))
+            else
             {
-                std::cout << R"(<rule cmd="IGNORE" file1=")" << m_duplicated_items[0].get_path() << R"(" file2=")" << m_duplicated_items[1].get_path() << R"(" />)" << std::endl;
-                m_proposed_rules.insert(make_pair(m_duplicated_items[0].get_path(), m_duplicated_items[1].get_path()));
+                p_output.add_proposed_rule(p_items[0].get_path(), p_items[1].get_path());
             }
         }
     }
 
     //-------------------------------------------------------------------------
     void
-    duplication_checker::process_duplicated_list()
+    duplication_checker::process_duplicated_list(std::vector<item> & p_items
+                                                ,group_output & p_output
+                                                )
     {
-        assert(m_duplicated_items.size() > 2);
+        assert(p_items.size() > 2);
         // Create a list of paths corresponding to items
-        std::vector<std::string>  l_paths(m_duplicated_items.size());
+        std::vector<std::string>  l_paths(p_items.size());
         unsigned int l_index = 0;
-        for(auto const & l_iter:m_duplicated_items)
+        for(auto const & l_iter:p_items)
         {
             l_paths[l_index] = l_iter.get_path();
             ++l_index;
         }
-        bool l_matched = false;
         // Search for a rule corresponding to this list of path
-        for(auto l_iter: m_keep_only)
+        const keep_only * l_keep_only = m_keep_only.find(l_paths);
+        if(l_keep_only)
         {
-            if(l_iter.match(l_paths))
+            if(m_statistics)
+            {
+                m_statistics->add_keep_only_hit();
+            }
+            if(m_rule_profile)
             {
-                l_matched = true;
-                // If there is a rule generate the corresponding commands
-                std::vector<std::string> l_to_keep;
-                std::vector<std::string> l_to_remove;
-                for(auto const & l_iter_item:m_duplicated_items)
+                m_rule_profile->add_keep_only_hit(m_keep_only.index_of(l_keep_only));
+            }
+            // If there is a rule generate the corresponding commands
+            std::vector<std::string> l_to_keep;
+            std::vector<std::string> l_to_remove;
+            std::vector<std::string> l_files_to_keep;
+            std::vector<std::string> l_files_to_remove;
+            for(auto const & l_iter_item:p_items)
+            {
+                bool l_keep = l_keep_only->is_to_keep(l_iter_item.get_path());
+                (l_keep ? l_to_keep : l_to_remove).emplace_back(l_iter_item.get_despecialised_complete_filename());
+                if(m_removal_executor || m_verifier)
                 {
-                    if(l_iter.is_to_keep(l_iter_item.get_path()))
-                    {
-                        l_to_keep.emplace_back(l_iter_item.get_despecialised_complete_filename());
-                    }
-                    else
+                    (l_keep ? l_files_to_keep : l_files_to_remove).emplace_back(l_iter_item.get_complete_filename());
+                }
+            }
+            // When all files are removed they are checked against first one
+            bool l_verified = true;
+            if(m_verifier && !l_files_to_remove.empty())
+            {
+                const std::string & l_reference = l_files_to_keep.empty() ? l_files_to_remove.front() : l_files_to_keep.front();
+                for(const auto & l_iter: l_files_to_remove)
+                {
+                    if(&l_iter != &l_reference && !verify(l_reference, l_iter, p_output))
                     {
-                        l_to_remove.emplace_back(l_iter_item.get_despecialised_complete_filename());
+                        l_verified = false;
+                        break;
                     }
                 }
-                generate_rm(l_to_remove, l_to_keep);
-                break;
+            }
+            if(l_verified)
+            {
+                generate_rm(p_output.get_cmd(), l_to_remove, l_to_keep);
+                if(m_removal_executor)
+                {
+                    p_output.add_removal(std::move(l_files_to_keep), std::move(l_files_to_remove));
+                }
             }
         }
         // If there is no rule, log the items as duplicated
-        if(!l_matched)
+        else
         {
-            print_items(m_output_file, m_duplicated_items);
+            print_items(p_output.get_duplicata(), p_items);
             if(m_interactive)
             {
-                for(const auto & l_iter:m_duplicated_items)
+                for(const auto & l_iter:p_items)
                 {
                     std::cout << l_iter.get_sha1() << " " << l_iter.get_complete_filename() << std::endl;
                 }
@@ -445,10 +1280,13 @@ namespace duplication_checker
                     }
                     else if(l_choice == "i")
                     {
-                        m_sha1_ignore_list.insert(std::make_pair(m_duplicated_items[0].get_sha1()
-                                                                   ,m_duplicated_items[0].get_filename())
-                                                                   );
-                        return;
+                        if(sha1::m_digest_size == p_items[0].get_digest_size())
+                        {
+                            m_sha1_ignore_list.insert(p_items[0].get_sha1(), p_items[0].get_filename());
+                            return;
+                        }
+                        std::cout << "Only SHA1 can be ignored" << std::endl;
+                        l_valid_choice = false;
                     }
                     else if(l_choice == "s")
                     {
@@ -456,20 +1294,22 @@ namespace duplication_checker
                     }
                     else if(l_choice == "k")
                     {
-                        m_keep_only.emplace_back();
-                        for(const auto & l_iter: m_duplicated_items)
+                        keep_only l_new_keep_only;
+                        for(const auto & l_iter: p_items)
                         {
-                            m_keep_only.back().add_to_keep(l_iter.get_path());
+                            l_new_keep_only.add_to_keep(l_iter.get_path());
                         }
+                        m_keep_only.add(l_new_keep_only);
                         return;
                     }
                     else if(l_choice == "r")
                     {
-                        m_keep_only.emplace_back();
-                        for(const auto & l_iter: m_duplicated_items)
+                        keep_only l_new_keep_only;
+                        for(const auto & l_iter: p_items)
                         {
-                            m_keep_only.back().add_to_remove(l_iter.get_path());
+                            l_new_keep_only.add_to_remove(l_iter.get_path());
                         }
+                        m_keep_only.add(l_new_keep_only);
                         return;
                     }
                     else if(l_choice == "q")
@@ -483,9 +1323,9 @@ namespace duplication_checker
                     }
                 } while(!l_valid_choice);
                 // We are there if we have choosen to deal for each file
-                m_keep_only.emplace_back();
+                keep_only l_new_keep_only;
                 std::string l_choice;
-                for(const auto & l_iter: m_duplicated_items)
+                for(const auto & l_iter: p_items)
                 {
                     if(l_choice != "R" && l_choice != "K")
                     {
@@ -511,37 +1351,41 @@ namespace duplication_checker
                     }
                     if(l_choice == "R" || l_choice == "r")
                     {
-                        m_keep_only.back().add_to_remove(l_iter.get_path());
+                        l_new_keep_only.add_to_remove(l_iter.get_path());
                     }
                     if(l_choice == "K" || l_choice == "k")
                     {
-                        m_keep_only.back().add_to_keep(l_iter.get_path());
+                        l_new_keep_only.add_to_keep(l_iter.get_path());
                     }
                 }
+                m_keep_only.add(l_new_keep_only);
             }
         }
     }
 
     //-------------------------------------------------------------------------
     void
-    duplication_checker::print_items(std::ofstream & p_file
+    duplication_checker::print_items(std::ostream & p_stream
                                     ,const std::vector<item> & p_items
                                     )
     {
-        p_file << std::endl;
+        p_stream << "\n";
         for(const auto & l_iter:p_items)
         {
-            p_file << l_iter.get_sha1() << "  " << l_iter.get_complete_filename() << std::endl;
+            p_stream << l_iter.get_sha1() << "  " << l_iter.get_complete_filename() << "\n";
         }
     }
 
     //-------------------------------------------------------------------------
     duplication_checker::~duplication_checker()
     {
-        m_input_file.close();
-        m_output_file.close();
-        m_output_cmd_file << "#EOF" << std::endl;
-        m_output_cmd_file.close();
+        // Stop pipeline before outputs it writes to are closed
+        m_pipeline.reset();
+        // Outputs are still open if run has not completed
+        if(m_output_cmd_file && m_output_cmd_file->is_open())
+        {
+            m_output_cmd_file->write("#EOF\n");
+        }
     }
 }
 #endif //DUPLICATION_CHECKER_DUPLICATION_CHECKER_H
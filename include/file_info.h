@@ -0,0 +1,124 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_FILE_INFO_H
+#define DUPLICATION_CHECKER_FILE_INFO_H
+
+#include <sys/stat.h>
+#include <cstdint>
+#include <string>
+
+namespace duplication_checker
+{
+    /**
+     * File found when walking a directory tree with the metadata obtained
+     * from stat
+     */
+    class file_info
+    {
+      public:
+
+        inline
+        file_info(const std::string & p_name
+                 ,const struct stat & p_stat
+                 );
+
+        /**
+         * Name relative to walked directory
+         */
+        inline
+        const std::string & get_name() const;
+
+        inline
+        uint64_t get_size() const;
+
+        inline
+        uint64_t get_device() const;
+
+        inline
+        uint64_t get_inode() const;
+
+        /**
+         * Modification time in nanoseconds
+         */
+        inline
+        int64_t get_mtime_ns() const;
+
+      private:
+
+        std::string m_name;
+        uint64_t m_size;
+        uint64_t m_device;
+        uint64_t m_inode;
+        int64_t m_mtime_ns;
+    };
+
+    //-------------------------------------------------------------------------
+    file_info::file_info(const std::string & p_name
+                        ,const struct stat & p_stat
+                        )
+    :m_name{p_name}
+    ,m_size{(uint64_t)p_stat.st_size}
+    ,m_device{(uint64_t)p_stat.st_dev}
+    ,m_inode{(uint64_t)p_stat.st_ino}
+#ifdef __APPLE__
+    ,m_mtime_ns{(int64_t)p_stat.st_mtimespec.tv_sec * 1000000000 + p_stat.st_mtimespec.tv_nsec}
+#else // __APPLE__
+    ,m_mtime_ns{(int64_t)p_stat.st_mtim.tv_sec * 1000000000 + p_stat.st_mtim.tv_nsec}
+#endif // __APPLE__
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    const std::string &
+    file_info::get_name() const
+    {
+        return m_name;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    file_info::get_size() const
+    {
+        return m_size;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    file_info::get_device() const
+    {
+        return m_device;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    file_info::get_inode() const
+    {
+        return m_inode;
+    }
+
+    //-------------------------------------------------------------------------
+    int64_t
+    file_info::get_mtime_ns() const
+    {
+        return m_mtime_ns;
+    }
+
+}
+#endif //DUPLICATION_CHECKER_FILE_INFO_H
+// EOF
@@ -0,0 +1,264 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_FILE_VERIFIER_H
+#define DUPLICATION_CHECKER_FILE_VERIFIER_H
+
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <string>
+#include <utility>
+
+namespace duplication_checker
+{
+    /**
+     * Check that files considered as duplicated by log are still identical
+     * before one of them is removed. Files must not have been modified after
+     * log, must have same size and same content. Content is compared by large
+     * page aligned chunks and comparison stops at first difference.
+     * Several threads can verify files at the same time
+     */
+    class file_verifier
+    {
+      public:
+
+        inline
+        file_verifier();
+
+        /**
+         * @param p_log_time modification time of log, files modified after
+         * are rejected
+         */
+        inline
+        void
+        set_log_time(time_t p_log_time);
+
+        /**
+         * Compare p_other to p_reference
+         * @return empty string if files are identical otherwise reason why
+         * they are not
+         */
+        inline
+        std::string
+        verify(const std::string & p_reference
+              ,const std::string & p_other
+              );
+
+        /**
+         * Print counters of verifications
+         */
+        inline
+        void
+        print_statistics() const;
+
+      private:
+
+        /**
+         * Compare content of both files which have p_size bytes
+         * @return empty string if contents are identical otherwise reason why
+         * they are not
+         */
+        inline
+        std::string
+        compare(int p_fd_1
+               ,int p_fd_2
+               ,uint64_t p_size
+               );
+
+        /**
+         * Allocate read buffers of both files, 2 * m_chunk_size bytes aligned
+         * on m_alignment, to be released with free
+         */
+        static inline
+        char *
+        allocate_buffers();
+
+        time_t m_log_time;
+
+        std::atomic<uint64_t> m_nb_verified;
+
+        std::atomic<uint64_t> m_nb_rejected;
+
+        std::atomic<uint64_t> m_nb_bytes;
+
+        /**
+         * Time spent comparing files summed over threads in nanoseconds
+         */
+        std::atomic<uint64_t> m_duration;
+
+        /**
+         * Size of read chunks
+         */
+        static const size_t m_chunk_size = 1024 * 1024;
+
+        /**
+         * Alignment of read buffers, page size so that kernel copies whole
+         * pages
+         */
+        static const size_t m_alignment = 4096;
+    };
+
+    //-------------------------------------------------------------------------
+    file_verifier::file_verifier()
+    :m_log_time{0}
+    ,m_nb_verified{0}
+    ,m_nb_rejected{0}
+    ,m_nb_bytes{0}
+    ,m_duration{0}
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    file_verifier::set_log_time(time_t p_log_time)
+    {
+        m_log_time = p_log_time;
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    file_verifier::verify(const std::string & p_reference
+                         ,const std::string & p_other
+                         )
+    {
+        std::chrono::steady_clock::time_point l_start = std::chrono::steady_clock::now();
+        std::string l_reason;
+        int l_fd_1 = open(p_reference.c_str(), O_RDONLY);
+        int l_fd_2 = -1 == l_fd_1 ? -1 : open(p_other.c_str(), O_RDONLY);
+        struct stat l_stat_1;
+        struct stat l_stat_2;
+        if(-1 == l_fd_1 || -1 == l_fd_2 || fstat(l_fd_1, &l_stat_1) || fstat(l_fd_2, &l_stat_2))
+        {
+            l_reason = R"(cannot be read : )" + std::string(strerror(errno));
+        }
+        else if(l_stat_1.st_mtime > m_log_time || l_stat_2.st_mtime > m_log_time)
+        {
+            l_reason = "modified after log";
+        }
+        else if(l_stat_1.st_size != l_stat_2.st_size)
+        {
+            l_reason = "sizes differ";
+        }
+        // Files sharing same inode are identical
+        else if(l_stat_1.st_dev != l_stat_2.st_dev || l_stat_1.st_ino != l_stat_2.st_ino)
+        {
+            l_reason = compare(l_fd_1, l_fd_2, (uint64_t)l_stat_1.st_size);
+        }
+        if(-1 != l_fd_1)
+        {
+            close(l_fd_1);
+        }
+        if(-1 != l_fd_2)
+        {
+            close(l_fd_2);
+        }
+        ++m_nb_verified;
+        if(!l_reason.empty())
+        {
+            ++m_nb_rejected;
+        }
+        m_duration += (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - l_start).count();
+        return l_reason;
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    file_verifier::compare(int p_fd_1
+                          ,int p_fd_2
+                          ,uint64_t p_size
+                          )
+    {
+        // Buffers are reused by each thread across verifications
+        thread_local std::unique_ptr<char, void (*)(void *)> l_buffers(allocate_buffers(), &free);
+        char * l_buffer_1 = l_buffers.get();
+        char * l_buffer_2 = l_buffers.get() + m_chunk_size;
+#ifdef POSIX_FADV_SEQUENTIAL
+        posix_fadvise(p_fd_1, 0, 0, POSIX_FADV_SEQUENTIAL);
+        posix_fadvise(p_fd_2, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif // POSIX_FADV_SEQUENTIAL
+        uint64_t l_offset = 0;
+        while(l_offset < p_size)
+        {
+            size_t l_size = (size_t)std::min((uint64_t)m_chunk_size, p_size - l_offset);
+            for(auto l_iter: {std::make_pair(p_fd_1, l_buffer_1), std::make_pair(p_fd_2, l_buffer_2)})
+            {
+                size_t l_read = 0;
+                while(l_read < l_size)
+                {
+                    ssize_t l_result = pread(l_iter.first, l_iter.second + l_read, l_size - l_read, (off_t)(l_offset + l_read));
+                    if(-1 == l_result && EINTR == errno)
+                    {
+                        continue;
+                    }
+                    if(-1 == l_result)
+                    {
+                        return R"(cannot be read : )" + std::string(strerror(errno));
+                    }
+                    if(!l_result)
+                    {
+                        return "sizes differ";
+                    }
+                    l_read += (size_t)l_result;
+                }
+            }
+            m_nb_bytes += 2 * l_size;
+            if(memcmp(l_buffer_1, l_buffer_2, l_size))
+            {
+                return "contents differ";
+            }
+            l_offset += l_size;
+        }
+        return "";
+    }
+
+    //-------------------------------------------------------------------------
+    char *
+    file_verifier::allocate_buffers()
+    {
+        void * l_buffers;
+        if(posix_memalign(&l_buffers, m_alignment, 2 * m_chunk_size))
+        {
+            throw std::bad_alloc();
+        }
+        return static_cast<char *>(l_buffers);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    file_verifier::print_statistics() const
+    {
+        double l_duration = (double)m_duration / 1e9;
+        uint64_t l_throughput = l_duration > 0 ? (uint64_t)((double)m_nb_bytes / l_duration) : (uint64_t)m_nb_bytes;
+        std::cout << "Verification : " + std::to_string(m_nb_verified) + " files verified, " + std::to_string(m_nb_rejected) + " rejected, " + std::to_string(m_nb_bytes) + " bytes read at " + std::to_string(l_throughput) + " bytes/s per thread" << std::endl;
+    }
+
+}
+#endif //DUPLICATION_CHECKER_FILE_VERIFIER_H
+// EOF
@@ -0,0 +1,200 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_GROUP_BATCH_H
+#define DUPLICATION_CHECKER_GROUP_BATCH_H
+
+#include "group_output.h"
+#include "text_view.h"
+#include <algorithm>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Consecutive groups of files having same SHA1 and output produced by
+     * their processing. SHA1 and filenames are views on log content or on
+     * text stored by batch
+     */
+    class group_batch
+    {
+      public:
+
+        inline
+        group_batch();
+
+        /**
+         * Add a group, p_filenames content is taken and p_filenames is left
+         * empty
+         */
+        inline
+        void
+        add_group(const text_view & p_sha1
+                 ,std::vector<text_view> & p_filenames
+                 );
+
+        inline
+        size_t
+        size() const;
+
+        inline
+        const text_view &
+        get_sha1(size_t p_index) const;
+
+        inline
+        const std::vector<text_view> &
+        get_filenames(size_t p_index) const;
+
+        inline
+        group_output &
+        get_output();
+
+        /**
+         * Copy text in memory owned by batch so that a view on it stays valid
+         * until batch is cleared
+         */
+        inline
+        text_view
+        store(const std::string & p_text);
+
+        /**
+         * Remove groups and output, memory is kept to be reused
+         */
+        inline
+        void
+        clear();
+
+      private:
+
+        std::vector<std::pair<text_view, std::vector<text_view>>> m_groups;
+
+        /**
+         * Number of used elements of m_groups
+         */
+        size_t m_size;
+
+        group_output m_output;
+
+        /**
+         * Memory of stored texts with size of each chunk, chunks are kept
+         * when batch is cleared
+         */
+        std::vector<std::pair<std::unique_ptr<char[]>, size_t>> m_chunks;
+
+        /**
+         * Chunk being filled
+         */
+        size_t m_chunk_index;
+
+        /**
+         * Used size of chunk being filled
+         */
+        size_t m_chunk_position;
+
+        static const size_t m_chunk_size = 64 * 1024;
+    };
+
+    //-------------------------------------------------------------------------
+    group_batch::group_batch()
+    :m_size{0}
+    ,m_chunk_index{0}
+    ,m_chunk_position{0}
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    group_batch::add_group(const text_view & p_sha1
+                          ,std::vector<text_view> & p_filenames
+                          )
+    {
+        if(m_size == m_groups.size())
+        {
+            m_groups.emplace_back();
+        }
+        m_groups[m_size].first = p_sha1;
+        m_groups[m_size].second.swap(p_filenames);
+        p_filenames.clear();
+        ++m_size;
+    }
+
+    //-------------------------------------------------------------------------
+    size_t
+    group_batch::size() const
+    {
+        return m_size;
+    }
+
+    //-------------------------------------------------------------------------
+    const text_view &
+    group_batch::get_sha1(size_t p_index) const
+    {
+        return m_groups[p_index].first;
+    }
+
+    //-------------------------------------------------------------------------
+    const std::vector<text_view> &
+    group_batch::get_filenames(size_t p_index) const
+    {
+        return m_groups[p_index].second;
+    }
+
+    //-------------------------------------------------------------------------
+    group_output &
+    group_batch::get_output()
+    {
+        return m_output;
+    }
+
+    //-------------------------------------------------------------------------
+    text_view
+    group_batch::store(const std::string & p_text)
+    {
+        while(m_chunk_index < m_chunks.size() && m_chunk_position + p_text.size() > m_chunks[m_chunk_index].second)
+        {
+            ++m_chunk_index;
+            m_chunk_position = 0;
+        }
+        if(m_chunk_index == m_chunks.size())
+        {
+            size_t l_size = std::max((size_t)m_chunk_size, p_text.size());
+            m_chunks.emplace_back(std::unique_ptr<char[]>(new char[l_size]), l_size);
+        }
+        char * l_data = m_chunks[m_chunk_index].first.get() + m_chunk_position;
+        memcpy(l_data, p_text.data(), p_text.size());
+        m_chunk_position += p_text.size();
+        return text_view(l_data, p_text.size());
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    group_batch::clear()
+    {
+        m_size = 0;
+        m_output.clear();
+        m_chunk_index = 0;
+        m_chunk_position = 0;
+    }
+
+}
+#endif //DUPLICATION_CHECKER_GROUP_BATCH_H
+// EOF
@@ -0,0 +1,187 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_GROUP_OUTPUT_H
+#define DUPLICATION_CHECKER_GROUP_OUTPUT_H
+
+#include "output_sink.h"
+#include <ostream>
+#include <sstream>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Output produced by processing of groups of duplicated files.
+     * It is kept in memory until it can be written in order
+     */
+    class group_output
+    {
+      public:
+
+        /**
+         * Files to keep and files to remove of a removal decision. When
+         * m_link is set, files are replaced by a link to the single file to
+         * keep instead of being removed
+         */
+        struct t_removal
+        {
+            std::vector<std::string> m_keep;
+            std::vector<std::string> m_remove;
+            bool m_link;
+        };
+
+        /**
+         * Stream receiving content of duplicata.log
+         */
+        inline
+        std::ostream &
+        get_duplicata();
+
+        /**
+         * Stream receiving content of clean_cmd.bash
+         */
+        inline
+        std::ostream &
+        get_cmd();
+
+        /**
+         * Remember that an IGNORE rule should be proposed for these paths
+         */
+        inline
+        void
+        add_proposed_rule(const std::string & p_path_1
+                         ,const std::string & p_path_2
+                         );
+
+        inline
+        const std::vector<std::pair<std::string, std::string>> &
+        get_proposed_rules() const;
+
+        /**
+         * Remember a decision to remove files if files to keep are present
+         * @param p_link replace files by a link to file to keep instead of
+         * removing them
+         */
+        inline
+        void
+        add_removal(std::vector<std::string> && p_keep
+                   ,std::vector<std::string> && p_remove
+                   ,bool p_link = false
+                   );
+
+        inline
+        const std::vector<t_removal> &
+        get_removals() const;
+
+        /**
+         * Write content of duplicata.log and clean_cmd.bash
+         */
+        inline
+        void
+        write(output_sink & p_duplicata
+             ,output_sink & p_cmd
+             ) const;
+
+        inline
+        void
+        clear();
+
+      private:
+
+        std::ostringstream m_duplicata;
+
+        std::ostringstream m_cmd;
+
+        std::vector<std::pair<std::string, std::string>> m_proposed_rules;
+
+        std::vector<t_removal> m_removals;
+    };
+
+    //-------------------------------------------------------------------------
+    std::ostream &
+    group_output::get_duplicata()
+    {
+        return m_duplicata;
+    }
+
+    //-------------------------------------------------------------------------
+    std::ostream &
+    group_output::get_cmd()
+    {
+        return m_cmd;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    group_output::add_proposed_rule(const std::string & p_path_1
+                                   ,const std::string & p_path_2
+                                   )
+    {
+        m_proposed_rules.emplace_back(p_path_1, p_path_2);
+    }
+
+    //-------------------------------------------------------------------------
+    const std::vector<std::pair<std::string, std::string>> &
+    group_output::get_proposed_rules() const
+    {
+        return m_proposed_rules;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    group_output::add_removal(std::vector<std::string> && p_keep
+                             ,std::vector<std::string> && p_remove
+                             ,bool p_link
+                             )
+    {
+        m_removals.push_back(t_removal{std::move(p_keep), std::move(p_remove), p_link});
+    }
+
+    //-------------------------------------------------------------------------
+    const std::vector<group_output::t_removal> &
+    group_output::get_removals() const
+    {
+        return m_removals;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    group_output::write(output_sink & p_duplicata
+                       ,output_sink & p_cmd
+                       ) const
+    {
+        p_duplicata.write(m_duplicata.str());
+        p_cmd.write(m_cmd.str());
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    group_output::clear()
+    {
+        m_duplicata.str("");
+        m_cmd.str("");
+        m_proposed_rules.clear();
+        m_removals.clear();
+    }
+
+}
+#endif //DUPLICATION_CHECKER_GROUP_OUTPUT_H
+// EOF
@@ -0,0 +1,326 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_GROUP_PIPELINE_H
+#define DUPLICATION_CHECKER_GROUP_PIPELINE_H
+
+#include "group_batch.h"
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Process batches of groups with several worker threads and write their
+     * output with a writer thread in the order batches have been pushed.
+     * Number of batches being processed or waiting to be written is bounded
+     * so that memory stays under control when reader is faster than workers.
+     * An exception thrown by a worker or the writer stops the pipeline and
+     * is rethrown to the thread pushing batches
+     */
+    class group_pipeline
+    {
+      public:
+
+        /**
+         * Function processing a batch, second parameter is worker index
+         */
+        typedef std::function<void(group_batch &, unsigned int)> t_process;
+
+        typedef std::function<void(group_batch &)> t_write;
+
+        inline
+        group_pipeline(unsigned int p_nb_workers
+                      ,const t_process & p_process
+                      ,const t_write & p_write
+                      );
+
+        inline
+        ~group_pipeline();
+
+        group_pipeline(const group_pipeline &) = delete;
+        group_pipeline & operator=(const group_pipeline &) = delete;
+
+        /**
+         * Give batch to workers, block if too many batches are in progress
+         */
+        inline
+        void
+        push(std::unique_ptr<group_batch> && p_batch);
+
+        /**
+         * Wait until all batches have been written
+         */
+        inline
+        void
+        finish();
+
+      private:
+
+        inline
+        void
+        work(unsigned int p_worker_index);
+
+        inline
+        void
+        write();
+
+        /**
+         * Record exception and wake up everybody
+         */
+        inline
+        void
+        stop(std::exception_ptr p_exception);
+
+        inline
+        void
+        join();
+
+        inline
+        void
+        rethrow();
+
+        t_process m_process;
+
+        t_write m_write;
+
+        std::mutex m_mutex;
+
+        std::condition_variable m_condition;
+
+        /**
+         * Batches waiting for a worker with their sequence number
+         */
+        std::deque<std::pair<size_t, std::unique_ptr<group_batch>>> m_to_process;
+
+        /**
+         * Processed batches waiting for their turn to be written
+         */
+        std::map<size_t, std::unique_ptr<group_batch>> m_to_write;
+
+        size_t m_nb_pushed;
+
+        size_t m_nb_written;
+
+        size_t m_max_in_progress;
+
+        /**
+         * No more batches will be pushed
+         */
+        bool m_end;
+
+        /**
+         * Threads must return as soon as possible
+         */
+        bool m_abort;
+
+        std::exception_ptr m_exception;
+
+        std::vector<std::thread> m_workers;
+
+        std::thread m_writer;
+    };
+
+    //-------------------------------------------------------------------------
+    group_pipeline::group_pipeline(unsigned int p_nb_workers
+                                  ,const t_process & p_process
+                                  ,const t_write & p_write
+                                  )
+    :m_process(p_process)
+    ,m_write(p_write)
+    ,m_nb_pushed{0}
+    ,m_nb_written{0}
+    ,m_max_in_progress{4 * (size_t)p_nb_workers}
+    ,m_end{false}
+    ,m_abort{false}
+    {
+        for(unsigned int l_index = 0; l_index < p_nb_workers; ++l_index)
+        {
+            m_workers.emplace_back(&group_pipeline::work, this, l_index);
+        }
+        m_writer = std::thread(&group_pipeline::write, this);
+    }
+
+    //-------------------------------------------------------------------------
+    group_pipeline::~group_pipeline()
+    {
+        {
+            std::lock_guard<std::mutex> l_lock(m_mutex);
+            m_end = true;
+            m_abort = true;
+        }
+        m_condition.notify_all();
+        join();
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    group_pipeline::push(std::unique_ptr<group_batch> && p_batch)
+    {
+        std::unique_lock<std::mutex> l_lock(m_mutex);
+        m_condition.wait(l_lock, [&]{return m_abort || m_nb_pushed - m_nb_written < m_max_in_progress;});
+        if(m_abort)
+        {
+            l_lock.unlock();
+            rethrow();
+            return;
+        }
+        m_to_process.emplace_back(m_nb_pushed, std::move(p_batch));
+        ++m_nb_pushed;
+        l_lock.unlock();
+        m_condition.notify_all();
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    group_pipeline::finish()
+    {
+        {
+            std::lock_guard<std::mutex> l_lock(m_mutex);
+            m_end = true;
+        }
+        m_condition.notify_all();
+        join();
+        rethrow();
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    group_pipeline::work(unsigned int p_worker_index)
+    {
+        while(true)
+        {
+            std::unique_lock<std::mutex> l_lock(m_mutex);
+            m_condition.wait(l_lock, [&]{return m_abort || m_end || !m_to_process.empty();});
+            if(m_abort || m_to_process.empty())
+            {
+                return;
+            }
+            std::pair<size_t, std::unique_ptr<group_batch>> l_batch = std::move(m_to_process.front());
+            m_to_process.pop_front();
+            l_lock.unlock();
+            try
+            {
+                m_process(*l_batch.second, p_worker_index);
+            }
+            catch(...)
+            {
+                stop(std::current_exception());
+                return;
+            }
+            l_lock.lock();
+            m_to_write.emplace(l_batch.first, std::move(l_batch.second));
+            l_lock.unlock();
+            m_condition.notify_all();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    group_pipeline::write()
+    {
+        while(true)
+        {
+            std::unique_lock<std::mutex> l_lock(m_mutex);
+            m_condition.wait(l_lock
+                            ,[&]
+                             {
+                                 return m_abort ||
+                                        m_to_write.end() != m_to_write.find(m_nb_written) ||
+                                        (m_end && m_nb_written == m_nb_pushed);
+                             }
+                            );
+            auto l_iter = m_to_write.find(m_nb_written);
+            if(m_abort || m_to_write.end() == l_iter)
+            {
+                return;
+            }
+            std::unique_ptr<group_batch> l_batch = std::move(l_iter->second);
+            m_to_write.erase(l_iter);
+            l_lock.unlock();
+            try
+            {
+                m_write(*l_batch);
+            }
+            catch(...)
+            {
+                stop(std::current_exception());
+                return;
+            }
+            l_lock.lock();
+            ++m_nb_written;
+            l_lock.unlock();
+            m_condition.notify_all();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    group_pipeline::stop(std::exception_ptr p_exception)
+    {
+        {
+            std::lock_guard<std::mutex> l_lock(m_mutex);
+            if(!m_exception)
+            {
+                m_exception = p_exception;
+            }
+            m_abort = true;
+        }
+        m_condition.notify_all();
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    group_pipeline::join()
+    {
+        for(auto & l_iter: m_workers)
+        {
+            if(l_iter.joinable())
+            {
+                l_iter.join();
+            }
+        }
+        if(m_writer.joinable())
+        {
+            m_writer.join();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    group_pipeline::rethrow()
+    {
+        std::lock_guard<std::mutex> l_lock(m_mutex);
+        if(m_exception)
+        {
+            std::exception_ptr l_exception = m_exception;
+            m_exception = nullptr;
+            std::rethrow_exception(l_exception);
+        }
+    }
+
+}
+#endif //DUPLICATION_CHECKER_GROUP_PIPELINE_H
+// EOF
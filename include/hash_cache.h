@@ -0,0 +1,379 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_HASH_CACHE_H
+#define DUPLICATION_CHECKER_HASH_CACHE_H
+
+#include "file_info.h"
+#include "digest.h"
+#include "quicky_exception.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <tuple>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Persistent cache of digests keyed by device, inode, size and
+     * modification time so that unchanged files are not read again between
+     * two runs.
+     * File layout:
+     * - header: magic, version, record size, number of records
+     * - records sorted by key: device, inode, size, mtime in ns, digest
+     * Record size depends on digest type so a cache built with another
+     * digest type is ignored
+     * - end magic
+     * Cache file is memory mapped and records are found by binary search so
+     * opening it is cheap. A new cache is written in a temporary file which
+     * is renamed once complete so a truncated cache is never used, however
+     * cache with unexpected size or magic is ignored.
+     */
+    class hash_cache
+    {
+      public:
+
+        inline explicit
+        hash_cache(const std::string & p_file_name
+                  ,digest_type p_digest_type = digest_type::SHA1
+                  );
+
+        inline
+        ~hash_cache();
+
+        hash_cache(const hash_cache &) = delete;
+        hash_cache & operator=(const hash_cache &) = delete;
+
+        /**
+         * Search digest of file in cache
+         * @return true if found, digest is then stored in p_digest
+         */
+        inline
+        bool
+        find(const file_info & p_file
+            ,uint8_t * p_digest
+            ) const;
+
+        /**
+         * Record digest of file for next cache
+         */
+        inline
+        void
+        add(const file_info & p_file
+           ,const uint8_t * p_digest
+           );
+
+        /**
+         * Replace cache file by one containing records added since creation
+         */
+        inline
+        void
+        save();
+
+        inline
+        uint64_t
+        get_nb_records() const;
+
+      private:
+
+        typedef std::tuple<uint64_t, uint64_t, uint64_t, int64_t> t_key;
+
+        class record
+        {
+          public:
+
+            t_key m_key;
+            uint8_t m_digest[digest::m_max_size];
+
+            inline
+            bool
+            operator<(const record & p_record) const;
+        };
+
+        static inline
+        t_key
+        make_key(const file_info & p_file);
+
+        inline
+        t_key
+        get_key(uint64_t p_index) const;
+
+        inline
+        void
+        close_mapping();
+
+        /**
+         * "DCHCACHE" and "DCHC_END" when read as little endian
+         */
+        static const uint64_t m_magic = 0x4548434143484344ULL;
+        static const uint64_t m_end_magic = 0x444E455F43484344ULL;
+        static const uint32_t m_version = 1;
+        static const size_t m_header_size = 8 + 4 + 4 + 8;
+
+        std::string m_file_name;
+
+        size_t m_digest_size;
+
+        /**
+         * Key then digest
+         */
+        size_t m_record_size;
+
+        /**
+         * Mapped cache file, nullptr if there is no valid cache
+         */
+        const uint8_t * m_mapping;
+
+        size_t m_mapping_size;
+
+        uint64_t m_nb_records;
+
+        std::vector<record> m_new_records;
+    };
+
+    //-------------------------------------------------------------------------
+    hash_cache::hash_cache(const std::string & p_file_name
+                          ,digest_type p_digest_type
+                          )
+    :m_file_name{p_file_name}
+    ,m_digest_size{get_digest_size(p_digest_type)}
+    ,m_record_size{8 + 8 + 8 + 8 + m_digest_size}
+    ,m_mapping{nullptr}
+    ,m_mapping_size{0}
+    ,m_nb_records{0}
+    {
+        int l_fd = open(m_file_name.c_str(), O_RDONLY);
+        if(-1 == l_fd)
+        {
+            std::cout << R"(No hash cache ")" + m_file_name + R"(")" << std::endl;
+            return;
+        }
+        struct stat l_stat;
+        if(fstat(l_fd, &l_stat) || (size_t)l_stat.st_size < m_header_size + sizeof(uint64_t))
+        {
+            close(l_fd);
+            std::cout << R"(WARNING : ignore invalid hash cache ")" + m_file_name + R"(")" << std::endl;
+            return;
+        }
+        m_mapping_size = (size_t)l_stat.st_size;
+        void * l_mapping = mmap(nullptr, m_mapping_size, PROT_READ, MAP_PRIVATE, l_fd, 0);
+        close(l_fd);
+        if(MAP_FAILED == l_mapping)
+        {
+            std::cout << R"(WARNING : unable to map hash cache ")" + m_file_name + R"(")" << std::endl;
+            return;
+        }
+        m_mapping = static_cast<const uint8_t *>(l_mapping);
+
+        uint64_t l_magic;
+        uint32_t l_version;
+        uint32_t l_record_size;
+        uint64_t l_end_magic;
+        memcpy(&l_magic, m_mapping, sizeof(l_magic));
+        memcpy(&l_version, m_mapping + 8, sizeof(l_version));
+        memcpy(&l_record_size, m_mapping + 12, sizeof(l_record_size));
+        memcpy(&m_nb_records, m_mapping + 16, sizeof(m_nb_records));
+        memcpy(&l_end_magic, m_mapping + m_mapping_size - sizeof(l_end_magic), sizeof(l_end_magic));
+        if(m_magic == l_magic && m_version == l_version && m_record_size != l_record_size)
+        {
+            std::cout << R"(WARNING : ignore hash cache ")" + m_file_name + R"(" built with another digest)" << std::endl;
+            close_mapping();
+            return;
+        }
+        if(m_magic != l_magic ||
+           m_version != l_version ||
+           m_record_size != l_record_size ||
+           m_mapping_size != m_header_size + m_nb_records * m_record_size + sizeof(l_end_magic) ||
+           m_end_magic != l_end_magic
+          )
+        {
+            std::cout << R"(WARNING : ignore invalid hash cache ")" + m_file_name + R"(")" << std::endl;
+            close_mapping();
+            return;
+        }
+        std::cout << std::to_string(m_nb_records) + " records in hash cache" << std::endl;
+    }
+
+    //-------------------------------------------------------------------------
+    hash_cache::~hash_cache()
+    {
+        close_mapping();
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    hash_cache::find(const file_info & p_file
+                    ,uint8_t * p_digest
+                    ) const
+    {
+        t_key l_key = make_key(p_file);
+        uint64_t l_min = 0;
+        uint64_t l_max = m_nb_records;
+        while(l_min < l_max)
+        {
+            uint64_t l_middle = l_min + (l_max - l_min) / 2;
+            t_key l_middle_key = get_key(l_middle);
+            if(l_middle_key < l_key)
+            {
+                l_min = l_middle + 1;
+            }
+            else if(l_key < l_middle_key)
+            {
+                l_max = l_middle;
+            }
+            else
+            {
+                memcpy(p_digest, m_mapping + m_header_size + l_middle * m_record_size + 32, m_digest_size);
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    hash_cache::add(const file_info & p_file
+                   ,const uint8_t * p_digest
+                   )
+    {
+        m_new_records.emplace_back();
+        m_new_records.back().m_key = make_key(p_file);
+        memcpy(m_new_records.back().m_digest, p_digest, m_digest_size);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    hash_cache::save()
+    {
+        std::sort(m_new_records.begin(), m_new_records.end());
+        // Hard links share the same key so only one record is kept
+        m_new_records.erase(std::unique(m_new_records.begin()
+                                       ,m_new_records.end()
+                                       ,[](const record & p_first, const record & p_second) -> bool
+                                        {
+                                            return p_first.m_key == p_second.m_key;
+                                        }
+                                       )
+                           ,m_new_records.end()
+                           );
+
+        std::string l_tmp_file_name = m_file_name + ".tmp";
+        FILE * l_file = fopen(l_tmp_file_name.c_str(), "wb");
+        if(nullptr == l_file)
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error opening hash cache file ")" + l_tmp_file_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        uint64_t l_magic = m_magic;
+        uint32_t l_version = m_version;
+        uint32_t l_record_size = (uint32_t)m_record_size;
+        uint64_t l_nb_records = m_new_records.size();
+        uint64_t l_end_magic = m_end_magic;
+        bool l_ok = 1 == fwrite(&l_magic, sizeof(l_magic), 1, l_file);
+        l_ok &= 1 == fwrite(&l_version, sizeof(l_version), 1, l_file);
+        l_ok &= 1 == fwrite(&l_record_size, sizeof(l_record_size), 1, l_file);
+        l_ok &= 1 == fwrite(&l_nb_records, sizeof(l_nb_records), 1, l_file);
+        for(const auto & l_iter: m_new_records)
+        {
+            uint64_t l_device = std::get<0>(l_iter.m_key);
+            uint64_t l_inode = std::get<1>(l_iter.m_key);
+            uint64_t l_size = std::get<2>(l_iter.m_key);
+            int64_t l_mtime = std::get<3>(l_iter.m_key);
+            l_ok &= 1 == fwrite(&l_device, sizeof(l_device), 1, l_file);
+            l_ok &= 1 == fwrite(&l_inode, sizeof(l_inode), 1, l_file);
+            l_ok &= 1 == fwrite(&l_size, sizeof(l_size), 1, l_file);
+            l_ok &= 1 == fwrite(&l_mtime, sizeof(l_mtime), 1, l_file);
+            l_ok &= 1 == fwrite(l_iter.m_digest, m_digest_size, 1, l_file);
+        }
+        l_ok &= 1 == fwrite(&l_end_magic, sizeof(l_end_magic), 1, l_file);
+        l_ok &= 0 == fflush(l_file);
+        l_ok &= 0 == fsync(fileno(l_file));
+        l_ok &= 0 == fclose(l_file);
+        if(!l_ok || rename(l_tmp_file_name.c_str(), m_file_name.c_str()))
+        {
+            remove(l_tmp_file_name.c_str());
+            throw quicky_exception::quicky_runtime_exception(R"(Error writing hash cache file ")" + m_file_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        std::cout << std::to_string(l_nb_records) + " records saved in hash cache" << std::endl;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    hash_cache::get_nb_records() const
+    {
+        return m_nb_records;
+    }
+
+    //-------------------------------------------------------------------------
+    hash_cache::t_key
+    hash_cache::make_key(const file_info & p_file)
+    {
+        return std::make_tuple(p_file.get_device(), p_file.get_inode(), p_file.get_size(), p_file.get_mtime_ns());
+    }
+
+    //-------------------------------------------------------------------------
+    hash_cache::t_key
+    hash_cache::get_key(uint64_t p_index) const
+    {
+        const uint8_t * l_record = m_mapping + m_header_size + p_index * m_record_size;
+        uint64_t l_device;
+        uint64_t l_inode;
+        uint64_t l_size;
+        int64_t l_mtime;
+        memcpy(&l_device, l_record, sizeof(l_device));
+        memcpy(&l_inode, l_record + 8, sizeof(l_inode));
+        memcpy(&l_size, l_record + 16, sizeof(l_size));
+        memcpy(&l_mtime, l_record + 24, sizeof(l_mtime));
+        return std::make_tuple(l_device, l_inode, l_size, l_mtime);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    hash_cache::close_mapping()
+    {
+        if(m_mapping)
+        {
+            munmap(const_cast<uint8_t *>(m_mapping), m_mapping_size);
+            m_mapping = nullptr;
+            m_mapping_size = 0;
+            m_nb_records = 0;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    hash_cache::record::operator<(const record & p_record) const
+    {
+        return m_key < p_record.m_key;
+    }
+
+}
+#endif //DUPLICATION_CHECKER_HASH_CACHE_H
+// EOF
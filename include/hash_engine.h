@@ -0,0 +1,682 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_HASH_ENGINE_H
+#define DUPLICATION_CHECKER_HASH_ENGINE_H
+
+#include "digest.h"
+#include "hash_cache.h"
+#include "tree_walker.h"
+#include "quicky_exception.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <atomic>
+#include <cerrno>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_set>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Replace the sha1sum command file generated by check_duplication.bash:
+     * list files of a directory, compute their digest with a pool of threads
+     * and write them sorted in sha1sum format. Digest is SHA1 by default,
+     * with another type log starts with a header giving it.
+     * Hashing is done by stages, each stage only keeping files that can
+     * still be duplicated:
+     * - files whose size is shared with at least one other file
+     * - among them, big files whose first and last blocks are shared with
+     *   at least one other file of same size
+     * - full digest of remaining files. When SHA1 multi buffer kernel is
+     *   used, files of same size are read and hashed together
+     * When a hash cache is provided, digests of files which did not change
+     * since previous run are taken from the cache instead of being computed
+     */
+    class hash_engine
+    {
+      public:
+
+        /**
+         * @param p_cache cache of digests of same type, can be nullptr
+         */
+        inline
+        hash_engine(const std::string & p_root
+                   ,unsigned int p_nb_threads
+                   ,hash_cache * p_cache
+                   ,digest_type p_digest_type = digest_type::SHA1
+                   );
+
+        /**
+         * Hash all files and write result in p_output_file_name
+         */
+        inline
+        void
+        run(const std::string & p_output_file_name);
+
+        /**
+         * Compute digest of file in hexadecimal
+         * @param p_buffer read buffer, it must not be empty
+         * @return false if file cannot be read
+         */
+        static inline
+        bool
+        compute_digest(const std::string & p_file_name
+                      ,digest_type p_digest_type
+                      ,std::vector<uint8_t> & p_buffer
+                      ,std::string & p_digest
+                      );
+
+      private:
+
+        /**
+         * Keep in m_to_hash files whose size is shared with at least one
+         * other file. A file with a unique size cannot be duplicated so
+         * there is no need to read it.
+         * m_to_hash is sorted by size
+         */
+        inline
+        void
+        select_size_collisions();
+
+        /**
+         * Set digest of files of m_to_hash found in cache
+         */
+        inline
+        void
+        search_in_cache();
+
+        /**
+         * Compute digest of first and last blocks of big files and remove
+         * from m_to_hash the ones which are unique inside their size bucket.
+         * Size buckets containing files with cached digest are kept as is
+         * because partial digest of cached files is unknown
+         */
+        inline
+        void
+        select_partial_collisions();
+
+        /**
+         * Split m_to_hash in groups of files having same key and only keep
+         * groups with at least 2 files
+         * @param p_key function returning key of file
+         */
+        inline
+        void
+        keep_collisions(const std::function<std::pair<uint64_t, uint64_t>(size_t)> & p_key);
+
+        /**
+         * Call p_method with the files of p_indexes using the pool of threads.
+         * p_method receives index in m_files and a read buffer owned by the thread
+         */
+        inline
+        void
+        parallel_apply(const std::vector<size_t> & p_indexes
+                      ,void (hash_engine::*p_method)(size_t, std::vector<uint8_t> &)
+                      );
+
+        /**
+         * Store partial digest of file in m_partial_digests. A file which
+         * cannot be read is reported and flagged in m_unreadable
+         */
+        inline
+        void
+        partial_hash_file(size_t p_index
+                         ,std::vector<uint8_t> & p_buffer
+                         );
+
+        /**
+         * Store digest of file in m_digests
+         */
+        inline
+        void
+        hash_file(size_t p_index
+                 ,std::vector<uint8_t> & p_buffer
+                 );
+
+        /**
+         * Store SHA1 of files of m_batches[p_batch] in m_digests. Files are
+         * read by chunks at same offset and chunks are hashed together.
+         * Files which cannot be read or whose size changed are hashed one
+         * by one by hash_file
+         */
+        inline
+        void
+        hash_file_batch(size_t p_batch
+                       ,std::vector<uint8_t> & p_buffer
+                       );
+
+        /**
+         * Read until p_size bytes are read or end of file is reached
+         * @return number of bytes read
+         */
+        static inline
+        size_t
+        read_fully(int p_fd
+                  ,uint8_t * p_data
+                  ,size_t p_size
+                  );
+
+        /**
+         * FNV-1a hash, cheap enough for partial digest purpose
+         */
+        static inline
+        uint64_t
+        fnv1a(const uint8_t * p_data
+             ,size_t p_size
+             ,uint64_t p_hash
+             );
+
+        std::string m_root;
+
+        unsigned int m_nb_threads;
+
+        hash_cache * m_cache;
+
+        digest_type m_digest_type;
+
+        /**
+         * Files relative to root directory
+         */
+        std::vector<file_info> m_files;
+
+        /**
+         * Index in m_files of files still candidate to duplication
+         */
+        std::vector<size_t> m_to_hash;
+
+        /**
+         * Digest of first and last blocks, same index as m_files
+         */
+        std::vector<uint64_t> m_partial_digests;
+
+        /**
+         * Files whose partial digest cannot be computed, same index as
+         * m_files. Bytes instead of bool so that threads can set them
+         * concurrently
+         */
+        std::vector<uint8_t> m_unreadable;
+
+        /**
+         * Digests of files, same index as m_files. Empty if not hashed or if
+         * hash failed
+         */
+        std::vector<std::string> m_digests;
+
+        /**
+         * Indicate if digest comes from cache, same index as m_files
+         */
+        std::vector<bool> m_cached;
+
+        /**
+         * Indexes in m_files of files of same size hashed together, at most
+         * sha1::m_nb_lanes files by batch
+         */
+        std::vector<std::vector<size_t>> m_batches;
+
+        static const size_t m_read_size = 1024 * 1024;
+
+        /**
+         * Size of blocks read at beginning and end of files for partial digest
+         */
+        static const size_t m_partial_block_size = 4096;
+    };
+
+    //-------------------------------------------------------------------------
+    hash_engine::hash_engine(const std::string & p_root
+                            ,unsigned int p_nb_threads
+                            ,hash_cache * p_cache
+                            ,digest_type p_digest_type
+                            )
+    :m_root{p_root}
+    ,m_nb_threads{p_nb_threads ? p_nb_threads : 1}
+    ,m_cache{p_cache}
+    ,m_digest_type{p_digest_type}
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    hash_engine::run(const std::string & p_output_file_name)
+    {
+        tree_walker::walk(m_root, m_files);
+        select_size_collisions();
+        std::cout << std::to_string(m_files.size()) + " files found, " + std::to_string(m_to_hash.size()) + " with same size as another file" << std::endl;
+        m_digests.resize(m_files.size());
+        m_cached.resize(m_files.size(), false);
+        search_in_cache();
+        select_partial_collisions();
+
+        std::vector<size_t> l_not_cached;
+        for(auto l_index: m_to_hash)
+        {
+            if(!m_cached[l_index])
+            {
+                l_not_cached.emplace_back(l_index);
+            }
+        }
+        std::cout << std::to_string(m_to_hash.size() - l_not_cached.size()) + " files found in cache, " + std::to_string(l_not_cached.size()) + " files to hash with " + std::to_string(m_nb_threads) + " threads" << std::endl;
+        if(digest_type::SHA1 == m_digest_type && sha1::use_multi_buffer())
+        {
+            // Files to hash are sorted by size so files of same size are consecutive
+            std::vector<size_t> l_batch_indexes;
+            size_t l_start = 0;
+            while(l_start < l_not_cached.size())
+            {
+                size_t l_end = l_start + 1;
+                while(l_end < l_not_cached.size() && l_end - l_start < sha1::m_nb_lanes && m_files[l_not_cached[l_end]].get_size() == m_files[l_not_cached[l_start]].get_size())
+                {
+                    ++l_end;
+                }
+                l_batch_indexes.emplace_back(m_batches.size());
+                m_batches.emplace_back(l_not_cached.begin() + (std::ptrdiff_t)l_start, l_not_cached.begin() + (std::ptrdiff_t)l_end);
+                l_start = l_end;
+            }
+            parallel_apply(l_batch_indexes, &hash_engine::hash_file_batch);
+        }
+        else
+        {
+            parallel_apply(l_not_cached, &hash_engine::hash_file);
+        }
+
+        if(m_cache)
+        {
+            for(auto l_index: m_to_hash)
+            {
+                uint8_t l_digest[digest::m_max_size];
+                if(digest::from_string(m_digests[l_index].data(), m_digests[l_index].size(), l_digest))
+                {
+                    m_cache->add(m_files[l_index], l_digest);
+                }
+            }
+            m_cache->save();
+        }
+
+        // Output is sorted like "sort sha1sum.log" would do so that identical digests are adjacent
+        std::vector<size_t> l_order(m_to_hash);
+        std::sort(l_order.begin()
+                 ,l_order.end()
+                 ,[&](size_t p_first, size_t p_second) -> bool
+                  {
+                      return m_digests[p_first] != m_digests[p_second] ? m_digests[p_first] < m_digests[p_second] : m_files[p_first].get_name() < m_files[p_second].get_name();
+                  }
+                 );
+
+        std::ofstream l_output_file(p_output_file_name);
+        if(!l_output_file.is_open())
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error opening output file ")" + p_output_file_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        // Header sorts before digests, sha1sum logs have none
+        if(digest_type::SHA1 != m_digest_type)
+        {
+            l_output_file << digest::get_header(m_digest_type) << "\n";
+        }
+        for(auto l_index: l_order)
+        {
+            if(!m_digests[l_index].empty())
+            {
+                l_output_file << m_digests[l_index] << "  " << m_files[l_index].get_name() << "\n";
+            }
+        }
+        l_output_file.close();
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    hash_engine::select_size_collisions()
+    {
+        m_to_hash.resize(m_files.size());
+        for(size_t l_index = 0; l_index < m_to_hash.size(); ++l_index)
+        {
+            m_to_hash[l_index] = l_index;
+        }
+        keep_collisions([&](size_t p_index) -> std::pair<uint64_t, uint64_t>
+                        {
+                            return std::make_pair(m_files[p_index].get_size(), 0);
+                        }
+                       );
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    hash_engine::search_in_cache()
+    {
+        if(!m_cache)
+        {
+            return;
+        }
+        for(auto l_index: m_to_hash)
+        {
+            uint8_t l_digest[digest::m_max_size];
+            if(m_cache->find(m_files[l_index], l_digest))
+            {
+                m_digests[l_index] = digest::to_string(l_digest, get_digest_size(m_digest_type));
+                m_cached[l_index] = true;
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    hash_engine::select_partial_collisions()
+    {
+        std::unordered_set<uint64_t> l_cached_sizes;
+        for(auto l_index: m_to_hash)
+        {
+            if(m_cached[l_index])
+            {
+                l_cached_sizes.insert(m_files[l_index].get_size());
+            }
+        }
+        // When first and last blocks cover the whole file it is cheaper to directly compute full digest
+        std::vector<size_t> l_big_files;
+        for(auto l_index: m_to_hash)
+        {
+            if(m_files[l_index].get_size() > 2 * m_partial_block_size && l_cached_sizes.end() == l_cached_sizes.find(m_files[l_index].get_size()))
+            {
+                l_big_files.emplace_back(l_index);
+            }
+        }
+        m_partial_digests.resize(m_files.size(), 0);
+        m_unreadable.resize(m_files.size(), 0);
+        parallel_apply(l_big_files, &hash_engine::partial_hash_file);
+        // Unreadable files are already reported, they are not in log
+        m_to_hash.erase(std::remove_if(m_to_hash.begin()
+                                      ,m_to_hash.end()
+                                      ,[&](size_t p_index) -> bool
+                                       {
+                                           return m_unreadable[p_index];
+                                       }
+                                      )
+                       ,m_to_hash.end()
+                       );
+        keep_collisions([&](size_t p_index) -> std::pair<uint64_t, uint64_t>
+                        {
+                            return std::make_pair(m_files[p_index].get_size(), m_partial_digests[p_index]);
+                        }
+                       );
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    hash_engine::keep_collisions(const std::function<std::pair<uint64_t, uint64_t>(size_t)> & p_key)
+    {
+        std::vector<std::pair<std::pair<uint64_t, uint64_t>, size_t>> l_keys;
+        l_keys.reserve(m_to_hash.size());
+        for(auto l_index: m_to_hash)
+        {
+            l_keys.emplace_back(p_key(l_index), l_index);
+        }
+        std::sort(l_keys.begin(), l_keys.end());
+        m_to_hash.clear();
+        size_t l_group_start = 0;
+        while(l_group_start < l_keys.size())
+        {
+            size_t l_group_end = l_group_start + 1;
+            while(l_group_end < l_keys.size() && l_keys[l_group_end].first == l_keys[l_group_start].first)
+            {
+                ++l_group_end;
+            }
+            if(l_group_end - l_group_start > 1)
+            {
+                for(size_t l_index = l_group_start; l_index < l_group_end; ++l_index)
+                {
+                    m_to_hash.emplace_back(l_keys[l_index].second);
+                }
+            }
+            l_group_start = l_group_end;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    hash_engine::parallel_apply(const std::vector<size_t> & p_indexes
+                               ,void (hash_engine::*p_method)(size_t, std::vector<uint8_t> &)
+                               )
+    {
+        std::atomic<size_t> l_next_index{0};
+        auto l_thread_body = [&]()
+        {
+            std::vector<uint8_t> l_buffer(m_read_size);
+            size_t l_next;
+            while((l_next = l_next_index++) < p_indexes.size())
+            {
+                (this->*p_method)(p_indexes[l_next], l_buffer);
+            }
+        };
+        std::vector<std::thread> l_threads;
+        for(unsigned int l_index = 0; l_index < m_nb_threads; ++l_index)
+        {
+            l_threads.emplace_back(l_thread_body);
+        }
+        for(auto & l_iter: l_threads)
+        {
+            l_iter.join();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    hash_engine::partial_hash_file(size_t p_index
+                                  ,std::vector<uint8_t> & p_buffer
+                                  )
+    {
+        const file_info & l_file = m_files[p_index];
+        m_partial_digests[p_index] = 0;
+        int l_fd = open((m_root + "/" + l_file.get_name()).c_str(), O_RDONLY);
+        ssize_t l_head_size = -1;
+        ssize_t l_tail_size = -1;
+        if(-1 != l_fd)
+        {
+            do
+            {
+                l_head_size = pread(l_fd, p_buffer.data(), m_partial_block_size, 0);
+            } while(-1 == l_head_size && EINTR == errno);
+            do
+            {
+                l_tail_size = pread(l_fd, p_buffer.data() + m_partial_block_size, m_partial_block_size, (off_t)(l_file.get_size() - m_partial_block_size));
+            } while(-1 == l_tail_size && EINTR == errno);
+            close(l_fd);
+        }
+        if(l_head_size > 0 && l_tail_size > 0)
+        {
+            uint64_t l_hash = 0xcbf29ce484222325ULL;
+            l_hash = fnv1a(p_buffer.data(), (size_t)l_head_size, l_hash);
+            l_hash = fnv1a(p_buffer.data() + m_partial_block_size, (size_t)l_tail_size, l_hash);
+            m_partial_digests[p_index] = l_hash;
+        }
+        else
+        {
+            std::cerr << R"(WARNING : unable to read ")" + l_file.get_name() + R"(")" << std::endl;
+            m_unreadable[p_index] = 1;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    hash_engine::hash_file(size_t p_index
+                          ,std::vector<uint8_t> & p_buffer
+                          )
+    {
+        if(!compute_digest(m_root + "/" + m_files[p_index].get_name(), m_digest_type, p_buffer, m_digests[p_index]))
+        {
+            std::cerr << R"(WARNING : unable to read ")" + m_files[p_index].get_name() + R"(")" << std::endl;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    hash_engine::hash_file_batch(size_t p_batch
+                                ,std::vector<uint8_t> & p_buffer
+                                )
+    {
+        const std::vector<size_t> & l_batch = m_batches[p_batch];
+        uint64_t l_size = m_files[l_batch[0]].get_size();
+        // Each file gets its part of read buffer
+        size_t l_lane_size = p_buffer.size() / sha1::m_nb_lanes;
+        int l_fds[sha1::m_nb_lanes];
+        sha1 l_hashes[sha1::m_nb_lanes];
+        for(size_t l_lane = 0; l_lane < l_batch.size(); ++l_lane)
+        {
+            l_fds[l_lane] = open((m_root + "/" + m_files[l_batch[l_lane]].get_name()).c_str(), O_RDONLY);
+#ifdef POSIX_FADV_SEQUENTIAL
+            if(-1 != l_fds[l_lane])
+            {
+                posix_fadvise(l_fds[l_lane], 0, 0, POSIX_FADV_SEQUENTIAL);
+            }
+#endif // POSIX_FADV_SEQUENTIAL
+        }
+        for(uint64_t l_offset = 0; l_offset < l_size; l_offset += l_lane_size)
+        {
+            size_t l_read_size = (size_t)std::min((uint64_t)l_lane_size, l_size - l_offset);
+            sha1 * l_read_hashes[sha1::m_nb_lanes];
+            const uint8_t * l_read_data[sha1::m_nb_lanes];
+            size_t l_nb_read = 0;
+            for(size_t l_lane = 0; l_lane < l_batch.size(); ++l_lane)
+            {
+                if(-1 == l_fds[l_lane])
+                {
+                    continue;
+                }
+                uint8_t * l_data = p_buffer.data() + l_lane * l_lane_size;
+                if(l_read_size == read_fully(l_fds[l_lane], l_data, l_read_size))
+                {
+                    l_read_hashes[l_nb_read] = &l_hashes[l_lane];
+                    l_read_data[l_nb_read] = l_data;
+                    ++l_nb_read;
+                }
+                else
+                {
+                    close(l_fds[l_lane]);
+                    l_fds[l_lane] = -1;
+                }
+            }
+            sha1::update(l_read_hashes, l_read_data, l_nb_read, l_read_size);
+        }
+        std::vector<size_t> l_failed;
+        for(size_t l_lane = 0; l_lane < l_batch.size(); ++l_lane)
+        {
+            uint8_t l_byte;
+            if(-1 != l_fds[l_lane] && !read_fully(l_fds[l_lane], &l_byte, 1))
+            {
+                uint8_t l_digest[sha1::m_digest_size];
+                l_hashes[l_lane].finalize(l_digest);
+                m_digests[l_batch[l_lane]] = sha1::to_string(l_digest);
+            }
+            else
+            {
+                l_failed.emplace_back(l_batch[l_lane]);
+            }
+            if(-1 != l_fds[l_lane])
+            {
+                close(l_fds[l_lane]);
+            }
+        }
+        for(auto l_index: l_failed)
+        {
+            hash_file(l_index, p_buffer);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    size_t
+    hash_engine::read_fully(int p_fd
+                           ,uint8_t * p_data
+                           ,size_t p_size
+                           )
+    {
+        size_t l_total_size = 0;
+        while(l_total_size < p_size)
+        {
+            ssize_t l_read_size = read(p_fd, p_data + l_total_size, p_size - l_total_size);
+            if(l_read_size > 0)
+            {
+                l_total_size += (size_t)l_read_size;
+            }
+            // Signals received by watch mode can interrupt reads
+            else if(-1 != l_read_size || EINTR != errno)
+            {
+                break;
+            }
+        }
+        return l_total_size;
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    hash_engine::compute_digest(const std::string & p_file_name
+                               ,digest_type p_digest_type
+                               ,std::vector<uint8_t> & p_buffer
+                               ,std::string & p_digest
+                               )
+    {
+        int l_fd = open(p_file_name.c_str(), O_RDONLY);
+        if(-1 == l_fd)
+        {
+            return false;
+        }
+#ifdef POSIX_FADV_SEQUENTIAL
+        posix_fadvise(l_fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif // POSIX_FADV_SEQUENTIAL
+        digest l_digest(p_digest_type);
+        ssize_t l_read_size;
+        while((l_read_size = read(l_fd, p_buffer.data(), p_buffer.size())) > 0 || (-1 == l_read_size && EINTR == errno))
+        {
+            if(l_read_size > 0)
+            {
+                l_digest.update(p_buffer.data(), (size_t)l_read_size);
+            }
+        }
+        close(l_fd);
+        if(l_read_size < 0)
+        {
+            return false;
+        }
+        uint8_t l_result[digest::m_max_size];
+        l_digest.finalize(l_result);
+        p_digest = digest::to_string(l_result, get_digest_size(p_digest_type));
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    hash_engine::fnv1a(const uint8_t * p_data
+                      ,size_t p_size
+                      ,uint64_t p_hash
+                      )
+    {
+        for(size_t l_index = 0; l_index < p_size; ++l_index)
+        {
+            p_hash ^= p_data[l_index];
+            p_hash *= 0x100000001b3ULL;
+        }
+        return p_hash;
+    }
+
+}
+#endif //DUPLICATION_CHECKER_HASH_ENGINE_H
+// EOF
@@ -19,89 +19,148 @@
 #ifndef DUPLICATION_CHECKER_ITEM_H
 #define DUPLICATION_CHECKER_ITEM_H
 
+#include "path_table.h"
+#include "digest.h"
+#include "text_view.h"
+#include "quicky_exception.h"
+#include <cstdint>
+#include <cstring>
 #include <string>
 
+/**
+ * File of log.
+ * Digest, SHA1 or another type, is stored in binary form and directory as
+ * an index in a path table shared by all items. Complete filename is a view
+ * on log content so log must outlive item
+ */
 class item
 {
   public:
 
     inline
-    item( const std::string & p_sha1
-        , const std::string & p_complete_filename
+    item( const duplication_checker::text_view & p_sha1
+        , const duplication_checker::text_view & p_complete_filename
+        , duplication_checker::path_table & p_path_table
         );
 
     inline
-    const std::string & get_sha1() const;
+    std::string get_sha1() const;
 
     inline
-    const std::string & get_complete_filename() const;
+    const uint8_t * get_digest() const;
+
+    inline
+    size_t get_digest_size() const;
+
+    /**
+     * Compare digests of both items, digests of different types differ
+     */
+    inline
+    bool same_digest(const item & p_item) const;
+
+    inline
+    std::string get_complete_filename() const;
 
     inline
     const std::string & get_path() const;
 
     inline
-    const std::string & get_filename() const;
+    std::string get_filename() const;
 
     inline
     std::string get_despecialised_complete_filename() const;
 
   private:
 
-    std::string m_sha1;
-    std::string m_complete_filename;
-    std::string m_path;
-    std::string m_filename;
+    duplication_checker::text_view m_complete_filename;
+    const duplication_checker::path_table * m_path_table;
+    uint8_t m_digest[duplication_checker::digest::m_max_size];
+    uint8_t m_digest_size;
+    uint32_t m_path_id;
+
+    /**
+     * Position of filename in complete filename
+     */
+    uint32_t m_filename_pos;
 };
 
 //-----------------------------------------------------------------------------
-item::item( const std::string & p_sha1
-          , const std::string & p_complete_filename
+item::item( const duplication_checker::text_view & p_sha1
+          , const duplication_checker::text_view & p_complete_filename
+          , duplication_checker::path_table & p_path_table
           )
-: m_sha1(p_sha1)
-, m_complete_filename(p_complete_filename)
+: m_complete_filename(p_complete_filename)
+, m_path_table(&p_path_table)
+, m_digest_size(0)
+, m_path_id(0)
+, m_filename_pos(0)
 {
+    m_digest_size = (uint8_t)duplication_checker::digest::from_string(p_sha1.data(), p_sha1.size(), m_digest);
+    if(!m_digest_size)
+    {
+        throw quicky_exception::quicky_runtime_exception(R"(Invalid digest ")" + p_sha1.to_string() + R"(" for file ")" + p_complete_filename.to_string() + R"(")"
+                                                        ,__LINE__
+                                                        ,__FILE__
+                                                        );
+    }
     size_t l_last_separator_pos = m_complete_filename.rfind('/');
     if(std::string::npos != l_last_separator_pos)
     {
-        m_path = m_complete_filename.substr(0, l_last_separator_pos);
-        m_filename = m_complete_filename.substr(l_last_separator_pos + 1);
+        m_path_id = p_path_table.intern(m_complete_filename.substr(0, l_last_separator_pos));
+        m_filename_pos = (uint32_t)(l_last_separator_pos + 1);
     }
     else
     {
-        m_filename = m_complete_filename;
+        m_path_id = p_path_table.intern(duplication_checker::text_view());
     }
-    //std::cout << "\"" << m_path << "\"" << std::endl;
-    //std::cout << "\"" << m_filename << "\"" << std::endl;
 }
 
 //-----------------------------------------------------------------------------
-const std::string & item::get_sha1() const
+std::string item::get_sha1() const
+{
+    return duplication_checker::digest::to_string(m_digest, m_digest_size);
+}
+
+//-----------------------------------------------------------------------------
+const uint8_t * item::get_digest() const
+{
+    return m_digest;
+}
+
+//-----------------------------------------------------------------------------
+size_t item::get_digest_size() const
+{
+    return m_digest_size;
+}
+
+//-----------------------------------------------------------------------------
+bool item::same_digest(const item & p_item) const
 {
-    return m_sha1;
+    return m_digest_size == p_item.m_digest_size && !memcmp(m_digest, p_item.m_digest, m_digest_size);
 }
 
 //-----------------------------------------------------------------------------
-const std::string & item::get_complete_filename() const
+std::string item::get_complete_filename() const
 {
-    return m_complete_filename;
+    return m_complete_filename.to_string();
 }
 
 //-----------------------------------------------------------------------------
 const std::string & item::get_path() const
 {
-    return m_path;
+    return m_path_table->get(m_path_id);
 }
 
 //-----------------------------------------------------------------------------
-const std::string & item::get_filename() const
+std::string item::get_filename() const
 {
-    return m_filename;
+    return m_complete_filename.substr(m_filename_pos).to_string();
 }
 
 //-----------------------------------------------------------------------------
 std::string item::get_despecialised_complete_filename() const
 {
-    std::string l_result = m_complete_filename;
+    std::string l_result = get_complete_filename();
     size_t l_pos = l_result.size() - 1;
     while((l_pos = l_result.find_last_of("'` $()&;", l_pos)) != std::string::npos)
     {
@@ -111,4 +170,4 @@ std::string item::get_despecialised_complete_filename() const
 }
 
 #endif //DUPLICATION_CHECKER_ITEM_H
-// EOF
\ No newline at end of file
+// EOF
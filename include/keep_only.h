@@ -22,6 +22,7 @@
 #include <string>
 #include <vector>
 #include <set>
+#include <algorithm>
 #include <cassert>
 #include <functional>
 
@@ -42,7 +43,7 @@ namespace duplication_checker
         void add_to_keep(const std::string & p_name);
 
         inline
-        bool match(const std::vector<std::string> & p_list);
+        bool match(const std::vector<std::string> & p_list) const;
 
         inline
         bool is_to_keep(const std::string & p_name) const;
@@ -58,6 +59,21 @@ namespace duplication_checker
         void
         apply_to_keep(std::function<void(const std::string &)> & p_func) const;
 
+        /**
+         * Canonical representation of the sorted multiset of paths to keep
+         * and to remove
+         */
+        inline
+        std::string
+        get_signature() const;
+
+        /**
+         * Canonical representation of a sorted list of paths
+         */
+        static inline
+        std::string
+        get_signature(const std::vector<const std::string *> & p_sorted_list);
+
     private:
 
         /**
@@ -91,7 +107,7 @@ namespace duplication_checker
 
     //-------------------------------------------------------------------------
     bool
-    keep_only::match(const std::vector<std::string> & p_list)
+    keep_only::match(const std::vector<std::string> & p_list) const
     {
         if(p_list.size() != (m_to_remove.size() + m_to_keep.size()))
         {
@@ -141,5 +157,43 @@ namespace duplication_checker
         }
     }
 
+    //-------------------------------------------------------------------------
+    std::string
+    keep_only::get_signature() const
+    {
+        std::vector<const std::string *> l_list;
+        l_list.reserve(m_to_keep.size() + m_to_remove.size());
+        for(const auto & l_iter: m_to_keep)
+        {
+            l_list.emplace_back(&l_iter);
+        }
+        for(const auto & l_iter: m_to_remove)
+        {
+            l_list.emplace_back(&l_iter);
+        }
+        std::sort(l_list.begin()
+                 ,l_list.end()
+                 ,[](const std::string * p_first, const std::string * p_second) -> bool
+                  {
+                      return *p_first < *p_second;
+                  }
+                 );
+        return get_signature(l_list);
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    keep_only::get_signature(const std::vector<const std::string *> & p_sorted_list)
+    {
+        // Paths cannot contain null character so it is used as terminator
+        std::string l_signature;
+        for(auto l_iter: p_sorted_list)
+        {
+            l_signature += *l_iter;
+            l_signature.push_back('\0');
+        }
+        return l_signature;
+    }
+
 }
 #endif //DUPLICATION_CHECKER_KEEP_ONLY_H
@@ -0,0 +1,189 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_KEEP_ONLY_SET_H
+#define DUPLICATION_CHECKER_KEEP_ONLY_SET_H
+
+#include "keep_only.h"
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Keep only rules in declaration order indexed by their signature.
+     * When several rules have the same signature the first declared one is
+     * found
+     */
+    class keep_only_set
+    {
+      public:
+
+        typedef std::vector<keep_only>::const_iterator const_iterator;
+
+        inline
+        void
+        add(const keep_only & p_keep_only);
+
+        /**
+         * Search first rule matching paths of a group of files
+         * @return nullptr if no rule match
+         */
+        inline
+        const keep_only *
+        find(const std::vector<std::string> & p_paths) const;
+
+        /**
+         * Position in declaration order of a rule returned by find
+         */
+        inline
+        size_t
+        index_of(const keep_only * p_keep_only) const;
+
+        /**
+         * Allocate storage and index for p_nb rules
+         */
+        inline
+        void
+        reserve(size_t p_nb);
+
+        inline
+        size_t
+        size() const;
+
+        inline
+        bool
+        empty() const;
+
+        inline
+        const_iterator
+        begin() const;
+
+        inline
+        const_iterator
+        end() const;
+
+      private:
+
+        std::vector<keep_only> m_keep_only;
+
+        /**
+         * Index of first rule for each signature
+         */
+        std::unordered_map<std::string, size_t> m_index;
+    };
+
+    //-------------------------------------------------------------------------
+    void
+    keep_only_set::add(const keep_only & p_keep_only)
+    {
+        // Insertion does nothing if an older rule has same signature
+        m_index.emplace(p_keep_only.get_signature(), m_keep_only.size());
+        m_keep_only.emplace_back(p_keep_only);
+    }
+
+    //-------------------------------------------------------------------------
+    const keep_only *
+    keep_only_set::find(const std::vector<std::string> & p_paths) const
+    {
+        std::vector<const std::string *> l_sorted_paths;
+        l_sorted_paths.reserve(p_paths.size());
+        for(const auto & l_iter: p_paths)
+        {
+            l_sorted_paths.emplace_back(&l_iter);
+        }
+        std::sort(l_sorted_paths.begin()
+                 ,l_sorted_paths.end()
+                 ,[](const std::string * p_first, const std::string * p_second) -> bool
+                  {
+                      return *p_first < *p_second;
+                  }
+                 );
+        bool l_repeated = l_sorted_paths.end() != std::adjacent_find(l_sorted_paths.begin()
+                                                                    ,l_sorted_paths.end()
+                                                                    ,[](const std::string * p_first, const std::string * p_second) -> bool
+                                                                     {
+                                                                         return *p_first == *p_second;
+                                                                     }
+                                                                    );
+        if(!l_repeated)
+        {
+            // Paths are distinct so a matching rule contains exactly them
+            auto l_iter = m_index.find(keep_only::get_signature(l_sorted_paths));
+            return m_index.end() == l_iter ? nullptr : &m_keep_only[l_iter->second];
+        }
+        // Several files in same directory: a rule listing more paths than
+        // the group can match so signature cannot be used
+        for(const auto & l_iter: m_keep_only)
+        {
+            if(l_iter.match(p_paths))
+            {
+                return &l_iter;
+            }
+        }
+        return nullptr;
+    }
+
+    //-------------------------------------------------------------------------
+    size_t
+    keep_only_set::index_of(const keep_only * p_keep_only) const
+    {
+        return (size_t)(p_keep_only - m_keep_only.data());
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    keep_only_set::reserve(size_t p_nb)
+    {
+        m_keep_only.reserve(p_nb);
+        m_index.reserve(p_nb);
+    }
+
+    //-------------------------------------------------------------------------
+    size_t
+    keep_only_set::size() const
+    {
+        return m_keep_only.size();
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    keep_only_set::empty() const
+    {
+        return m_keep_only.empty();
+    }
+
+    //-------------------------------------------------------------------------
+    keep_only_set::const_iterator
+    keep_only_set::begin() const
+    {
+        return m_keep_only.begin();
+    }
+
+    //-------------------------------------------------------------------------
+    keep_only_set::const_iterator
+    keep_only_set::end() const
+    {
+        return m_keep_only.end();
+    }
+
+}
+#endif //DUPLICATION_CHECKER_KEEP_ONLY_SET_H
+// EOF
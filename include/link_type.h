@@ -0,0 +1,82 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_LINK_TYPE_H
+#define DUPLICATION_CHECKER_LINK_TYPE_H
+
+#include "quicky_exception.h"
+#include <string>
+
+namespace duplication_checker
+{
+    /**
+     * How LINK_FIRST and LINK_SECOND rules replace a duplicated file by the
+     * file to keep
+     */
+    enum class link_type
+    { HARD
+    , REFLINK
+    };
+
+    inline
+    link_type
+    to_link_type(const std::string & p_link_type_str);
+
+    inline
+    std::string
+    to_string(link_type p_link_type);
+
+    //-------------------------------------------------------------------------
+    link_type
+    to_link_type(const std::string & p_link_type_str)
+    {
+        if("hard" == p_link_type_str)
+        {
+            return link_type::HARD;
+        }
+        else if("reflink" == p_link_type_str)
+        {
+            return link_type::REFLINK;
+        }
+        throw quicky_exception::quicky_logic_exception(R"(Unknown link type ")" + p_link_type_str + R"(")"
+                                                      ,__LINE__
+                                                      ,__FILE__
+                                                      );
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    to_string(link_type p_link_type)
+    {
+        switch(p_link_type)
+        {
+            case link_type::HARD:
+                return "hard";
+            case link_type::REFLINK:
+                return "reflink";
+            default:
+                throw quicky_exception::quicky_logic_exception("Unknown link type value"
+                                                              ,__LINE__
+                                                              ,__FILE__
+                                                              );
+        }
+    }
+
+}
+#endif //DUPLICATION_CHECKER_LINK_TYPE_H
+// EOF
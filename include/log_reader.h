@@ -0,0 +1,93 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_LOG_READER_H
+#define DUPLICATION_CHECKER_LOG_READER_H
+
+#include "mapped_file.h"
+#include "text_view.h"
+#include <string>
+
+namespace duplication_checker
+{
+    /**
+     * Read lines of a memory mapped log without copying them.
+     * Lines are provided exactly as a loop calling getline until eof would
+     * get them: a file ending with a new line provides a last empty line
+     * Provided views stay valid as long as reader exists
+     */
+    class log_reader
+    {
+      public:
+
+        inline explicit
+        log_reader(const std::string & p_file_name);
+
+        /**
+         * Get next line
+         * @return false when end of file was reached by previous call
+         */
+        inline
+        bool
+        get_line(text_view & p_line);
+
+      private:
+
+        mapped_file m_file;
+
+        size_t m_position;
+
+        bool m_eof;
+    };
+
+    //-------------------------------------------------------------------------
+    log_reader::log_reader(const std::string & p_file_name)
+    :m_file(p_file_name)
+    ,m_position{0}
+    ,m_eof{false}
+    {
+        m_file.advise_sequential();
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    log_reader::get_line(text_view & p_line)
+    {
+        if(m_eof)
+        {
+            return false;
+        }
+        text_view l_remaining(m_file.data() + m_position, m_file.size() - m_position);
+        size_t l_end = l_remaining.find('\n');
+        if(std::string::npos != l_end)
+        {
+            p_line = l_remaining.substr(0, l_end);
+            m_position += l_end + 1;
+        }
+        else
+        {
+            p_line = l_remaining;
+            m_position = m_file.size();
+            m_eof = true;
+        }
+        return true;
+    }
+
+}
+#endif //DUPLICATION_CHECKER_LOG_READER_H
+// EOF
@@ -0,0 +1,508 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_LOG_SORTER_H
+#define DUPLICATION_CHECKER_LOG_SORTER_H
+
+#include "mapped_file.h"
+#include "text_view.h"
+#include "quicky_exception.h"
+#include <unistd.h>
+#include <algorithm>
+#include <condition_variable>
+#include <cstdio>
+#include <cstdlib>
+#include <exception>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Provide lines of an unsorted sha1sum log in the order "LC_ALL=C sort"
+     * would produce them so that identical SHA1 are adjacent.
+     * Log is memory mapped and lines are only manipulated as views.
+     * If log fits in memory budget its lines are sorted in place, the only
+     * memory used is then the array of views.
+     * Otherwise an external merge sort is performed: chunks fitting in memory
+     * budget are sorted by a fixed number of threads and stored in temporary
+     * files which are then mapped and merged. Temporary files are created in a
+     * directory with a unique name so that several sorts can run at same
+     * time, they are removed as soon as they are mapped.
+     * As with a sorted file read with getline, last provided line is empty.
+     * Provided views stay valid as long as sorter exists
+     */
+    class log_sorter
+    {
+      public:
+
+        /**
+         * @param p_file_name unsorted log
+         * @param p_max_memory memory budget in bytes
+         * @param p_nb_threads number of threads sorting chunks
+         * @param p_tmp_dir directory where the directory of temporary files
+         * is created
+         */
+        inline
+        log_sorter(const std::string & p_file_name
+                  ,size_t p_max_memory
+                  ,unsigned int p_nb_threads
+                  ,const std::string & p_tmp_dir = get_default_tmp_dir()
+                  );
+
+        inline
+        ~log_sorter();
+
+        log_sorter(const log_sorter &) = delete;
+        log_sorter & operator=(const log_sorter &) = delete;
+
+        /**
+         * Get next line in sorted order
+         * @return false when all lines have been provided
+         */
+        inline
+        bool
+        get_line(text_view & p_line);
+
+        /**
+         * @return TMPDIR environment variable if set, /tmp otherwise
+         */
+        static inline
+        std::string
+        get_default_tmp_dir();
+
+      private:
+
+        /**
+         * Remove temporary files which still exist and their directory
+         */
+        inline
+        void
+        remove_run_files();
+
+        /**
+         * Get next non empty line of p_file from p_position
+         * @param p_position read position, updated
+         * @return false if end of file has been reached before a line
+         */
+        static inline
+        bool
+        read_line(const mapped_file & p_file
+                 ,size_t & p_position
+                 ,text_view & p_line
+                 );
+
+        /**
+         * Collect non empty lines of p_file from p_position until memory
+         * budget is reached or end of file
+         * @param p_position read position, updated
+         * @return false if end of file has been reached
+         */
+        static inline
+        bool
+        read_chunk(const mapped_file & p_file
+                  ,size_t & p_position
+                  ,std::vector<text_view> & p_lines
+                  ,size_t p_budget
+                  );
+
+        /**
+         * Sort chunk and write it in temporary file p_file_name
+         */
+        static inline
+        void
+        write_run(std::vector<text_view> & p_lines
+                 ,const std::string & p_file_name
+                 );
+
+        /**
+         * Map temporary files and get their first line to prepare merge
+         */
+        inline
+        void
+        prepare_merge();
+
+        /**
+         * Push next line of temporary file p_run_index in merge heap
+         */
+        inline
+        void
+        push_next_line(size_t p_run_index);
+
+        mapped_file m_input_file;
+
+        /**
+         * Lines sorted in memory when log fits in budget
+         */
+        std::vector<text_view> m_lines;
+
+        size_t m_next_index;
+
+        /**
+         * Directory of temporary files, empty if not created
+         */
+        std::string m_run_dir_name;
+
+        /**
+         * Temporary files used by external sort
+         */
+        std::vector<std::string> m_run_file_names;
+
+        std::vector<std::unique_ptr<mapped_file>> m_run_files;
+
+        /**
+         * Read position in each temporary file
+         */
+        std::vector<size_t> m_run_positions;
+
+        /**
+         * Current line of each temporary file, the smallest is on top
+         */
+        typedef std::pair<text_view, size_t> t_merge_item;
+        std::priority_queue<t_merge_item, std::vector<t_merge_item>, std::function<bool(const t_merge_item &, const t_merge_item &)>> m_merge_heap;
+
+        bool m_external;
+
+        bool m_end_provided;
+    };
+
+    //-------------------------------------------------------------------------
+    log_sorter::log_sorter(const std::string & p_file_name
+                          ,size_t p_max_memory
+                          ,unsigned int p_nb_threads
+                          ,const std::string & p_tmp_dir
+                          )
+    :m_input_file(p_file_name)
+    ,m_next_index{0}
+    ,m_merge_heap([](const t_merge_item & p_first, const t_merge_item & p_second) -> bool
+                  {
+                      return p_second < p_first;
+                  }
+                 )
+    ,m_external{false}
+    ,m_end_provided{false}
+    {
+        if(!p_nb_threads)
+        {
+            p_nb_threads = 1;
+        }
+
+        m_input_file.advise_sequential();
+        size_t l_position = 0;
+        if(!read_chunk(m_input_file, l_position, m_lines, p_max_memory))
+        {
+            // Space following digest is lower than digest characters so
+            // comparing whole lines orders them by digest then path
+            std::sort(m_lines.begin(), m_lines.end());
+            return;
+        }
+
+        // Log does not fit in memory: each chunk gets a share of the budget
+        // so that chunk being read and chunks being sorted fit together
+        m_external = true;
+        size_t l_chunk_budget = p_max_memory / (p_nb_threads + 1);
+        std::cout << "Log does not fit in memory, use external sort" << std::endl;
+        std::string l_run_dir_template = p_tmp_dir + "/duplication_checker_sort_XXXXXX";
+        if(!mkdtemp(&l_run_dir_template[0]))
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error creating temporary directory in ")" + p_tmp_dir + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        m_run_dir_name = l_run_dir_template;
+
+        // Lines already read are split in chunks respecting chunk budget
+        std::vector<std::vector<text_view>> l_pending_chunks(p_nb_threads + 1);
+        for(size_t l_index = 0; l_index < m_lines.size(); ++l_index)
+        {
+            l_pending_chunks[l_index * l_pending_chunks.size() / m_lines.size()].emplace_back(m_lines[l_index]);
+        }
+        std::vector<text_view>().swap(m_lines);
+
+        // Chunks are given to a fixed pool of threads, at most one chunk per
+        // thread is waiting or being sorted while next one is read
+        std::mutex l_mutex;
+        std::condition_variable l_condition;
+        std::queue<std::pair<std::vector<text_view>, std::string>> l_runs;
+        unsigned int l_nb_pending = 0;
+        bool l_read_done = false;
+        std::exception_ptr l_exception;
+        auto l_worker = [&]()
+        {
+            std::unique_lock<std::mutex> l_lock(l_mutex);
+            while(true)
+            {
+                l_condition.wait(l_lock, [&]{return !l_runs.empty() || l_read_done;});
+                if(l_runs.empty())
+                {
+                    return;
+                }
+                std::pair<std::vector<text_view>, std::string> l_run = std::move(l_runs.front());
+                l_runs.pop();
+                l_lock.unlock();
+                try
+                {
+                    write_run(l_run.first, l_run.second);
+                }
+                catch(...)
+                {
+                    l_lock.lock();
+                    l_exception = std::current_exception();
+                    l_lock.unlock();
+                }
+                // Release memory before allowing another chunk
+                std::vector<text_view>().swap(l_run.first);
+                l_lock.lock();
+                --l_nb_pending;
+                l_condition.notify_all();
+            }
+        };
+        std::vector<std::thread> l_threads;
+        for(unsigned int l_index = 0; l_index < p_nb_threads; ++l_index)
+        {
+            l_threads.emplace_back(l_worker);
+        }
+        try
+        {
+            bool l_more = true;
+            while(!l_pending_chunks.empty() || l_more)
+            {
+                std::vector<text_view> l_chunk;
+                if(!l_pending_chunks.empty())
+                {
+                    l_chunk.swap(l_pending_chunks.back());
+                    l_pending_chunks.pop_back();
+                }
+                else
+                {
+                    l_more = read_chunk(m_input_file, l_position, l_chunk, l_chunk_budget);
+                }
+                if(l_chunk.empty())
+                {
+                    continue;
+                }
+                std::string l_run_file_name = m_run_dir_name + "/" + std::to_string(m_run_file_names.size()) + ".tmp";
+                m_run_file_names.emplace_back(l_run_file_name);
+                std::unique_lock<std::mutex> l_lock(l_mutex);
+                l_condition.wait(l_lock, [&]{return l_nb_pending < p_nb_threads;});
+                ++l_nb_pending;
+                l_runs.emplace(std::move(l_chunk), l_run_file_name);
+                l_condition.notify_all();
+            }
+        }
+        catch(...)
+        {
+            std::lock_guard<std::mutex> l_lock(l_mutex);
+            l_exception = std::current_exception();
+        }
+        {
+            std::lock_guard<std::mutex> l_lock(l_mutex);
+            l_read_done = true;
+            l_condition.notify_all();
+        }
+        for(auto & l_iter: l_threads)
+        {
+            l_iter.join();
+        }
+        if(l_exception)
+        {
+            remove_run_files();
+            std::rethrow_exception(l_exception);
+        }
+        try
+        {
+            prepare_merge();
+        }
+        catch(...)
+        {
+            m_run_files.clear();
+            remove_run_files();
+            throw;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    log_sorter::~log_sorter()
+    {
+        m_run_files.clear();
+        remove_run_files();
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    log_sorter::get_default_tmp_dir()
+    {
+        const char * l_tmp_dir = getenv("TMPDIR");
+        return l_tmp_dir && *l_tmp_dir ? l_tmp_dir : "/tmp";
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    log_sorter::remove_run_files()
+    {
+        for(const auto & l_iter: m_run_file_names)
+        {
+            remove(l_iter.c_str());
+        }
+        m_run_file_names.clear();
+        if(!m_run_dir_name.empty())
+        {
+            rmdir(m_run_dir_name.c_str());
+            m_run_dir_name.clear();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    log_sorter::get_line(text_view & p_line)
+    {
+        if(!m_external)
+        {
+            if(m_next_index < m_lines.size())
+            {
+                p_line = m_lines[m_next_index];
+                ++m_next_index;
+                return true;
+            }
+        }
+        else if(!m_merge_heap.empty())
+        {
+            t_merge_item l_item = m_merge_heap.top();
+            m_merge_heap.pop();
+            p_line = l_item.first;
+            push_next_line(l_item.second);
+            return true;
+        }
+        // Mimic the empty line read at end of a sorted file
+        if(!m_end_provided)
+        {
+            m_end_provided = true;
+            p_line = text_view();
+            return true;
+        }
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    log_sorter::read_line(const mapped_file & p_file
+                         ,size_t & p_position
+                         ,text_view & p_line
+                         )
+    {
+        while(p_position < p_file.size())
+        {
+            text_view l_remaining(p_file.data() + p_position, p_file.size() - p_position);
+            size_t l_end = l_remaining.find('\n');
+            p_line = l_remaining.substr(0, l_end);
+            p_position += std::string::npos == l_end ? l_remaining.size() : l_end + 1;
+            if(!p_line.empty())
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    log_sorter::read_chunk(const mapped_file & p_file
+                          ,size_t & p_position
+                          ,std::vector<text_view> & p_lines
+                          ,size_t p_budget
+                          )
+    {
+        size_t l_used = 0;
+        text_view l_line;
+        while(l_used < p_budget && read_line(p_file, p_position, l_line))
+        {
+            // Mapped bytes are paged in when lines are sorted
+            l_used += sizeof(text_view) + l_line.size();
+            p_lines.emplace_back(l_line);
+        }
+        return p_position < p_file.size();
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    log_sorter::write_run(std::vector<text_view> & p_lines
+                         ,const std::string & p_file_name
+                         )
+    {
+        std::sort(p_lines.begin(), p_lines.end());
+        std::ofstream l_run_file(p_file_name, std::ios::binary);
+        if(!l_run_file.is_open())
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error opening temporary file ")" + p_file_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        for(const auto & l_iter: p_lines)
+        {
+            l_run_file.write(l_iter.data(), (std::streamsize)l_iter.size());
+            l_run_file.put('\n');
+        }
+        if(!l_run_file)
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error writing temporary file ")" + p_file_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    log_sorter::prepare_merge()
+    {
+        m_run_positions.resize(m_run_file_names.size(), 0);
+        for(size_t l_index = 0; l_index < m_run_file_names.size(); ++l_index)
+        {
+            m_run_files.emplace_back(new mapped_file(m_run_file_names[l_index]));
+            m_run_files.back()->advise_sequential();
+            push_next_line(l_index);
+        }
+        // Mappings stay valid once files are removed, nothing is left on
+        // disk if process is killed during merge
+        remove_run_files();
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    log_sorter::push_next_line(size_t p_run_index)
+    {
+        text_view l_line;
+        if(read_line(*m_run_files[p_run_index], m_run_positions[p_run_index], l_line))
+        {
+            m_merge_heap.emplace(l_line, p_run_index);
+        }
+    }
+
+}
+#endif //DUPLICATION_CHECKER_LOG_SORTER_H
+// EOF
@@ -0,0 +1,147 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_MAPPED_FILE_H
+#define DUPLICATION_CHECKER_MAPPED_FILE_H
+
+#include "quicky_exception.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <string>
+
+namespace duplication_checker
+{
+    /**
+     * Read only memory mapping of a whole file
+     */
+    class mapped_file
+    {
+      public:
+
+        /**
+         * Map file, throw if file cannot be opened
+         */
+        inline explicit
+        mapped_file(const std::string & p_file_name);
+
+        inline
+        ~mapped_file();
+
+        mapped_file(const mapped_file &) = delete;
+        mapped_file & operator=(const mapped_file &) = delete;
+
+        /**
+         * Beginning of file content, nullptr if file is empty
+         */
+        inline
+        const char * data() const;
+
+        inline
+        size_t size() const;
+
+        /**
+         * Advise kernel that file will be read sequentially
+         */
+        inline
+        void advise_sequential() const;
+
+      private:
+
+        const char * m_data;
+
+        size_t m_size;
+    };
+
+    //-------------------------------------------------------------------------
+    mapped_file::mapped_file(const std::string & p_file_name)
+    :m_data{nullptr}
+    ,m_size{0}
+    {
+        int l_fd = open(p_file_name.c_str(), O_RDONLY);
+        if(-1 == l_fd)
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error opening input file ")" + p_file_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        struct stat l_stat;
+        if(fstat(l_fd, &l_stat))
+        {
+            close(l_fd);
+            throw quicky_exception::quicky_runtime_exception(R"(Error getting size of file ")" + p_file_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        m_size = (size_t)l_stat.st_size;
+        // Mapping of an empty file is not allowed
+        if(m_size)
+        {
+            void * l_mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, l_fd, 0);
+            if(MAP_FAILED == l_mapping)
+            {
+                close(l_fd);
+                throw quicky_exception::quicky_runtime_exception(R"(Error mapping file ")" + p_file_name + R"(")"
+                                                                ,__LINE__
+                                                                ,__FILE__
+                                                                );
+            }
+            m_data = static_cast<const char *>(l_mapping);
+        }
+        close(l_fd);
+    }
+
+    //-------------------------------------------------------------------------
+    mapped_file::~mapped_file()
+    {
+        if(m_data)
+        {
+            munmap(const_cast<char *>(m_data), m_size);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    const char *
+    mapped_file::data() const
+    {
+        return m_data;
+    }
+
+    //-------------------------------------------------------------------------
+    size_t
+    mapped_file::size() const
+    {
+        return m_size;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    mapped_file::advise_sequential() const
+    {
+        if(m_data)
+        {
+            madvise(const_cast<char *>(m_data), m_size, MADV_SEQUENTIAL);
+        }
+    }
+
+}
+#endif //DUPLICATION_CHECKER_MAPPED_FILE_H
+// EOF
@@ -0,0 +1,334 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_OUTPUT_SINK_H
+#define DUPLICATION_CHECKER_OUTPUT_SINK_H
+
+#include "quicky_exception.h"
+#include <fcntl.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Output file written by a background thread.
+     * Data is accumulated in a large buffer. When it is full it is given to
+     * the background thread and a second buffer is filled meanwhile.
+     * File is only synchronised on disk when closed, throughput of write and
+     * synchronisation is then reported
+     */
+    class output_sink
+    {
+      public:
+
+        /**
+         * Create or truncate file, throw if file cannot be opened
+         * @param p_buffer_size size of each of both buffers
+         */
+        inline explicit
+        output_sink(const std::string & p_file_name
+                   ,size_t p_buffer_size = 4 * 1024 * 1024
+                   );
+
+        /**
+         * Write remaining data and close file if not done, errors are
+         * ignored
+         */
+        inline
+        ~output_sink();
+
+        output_sink(const output_sink &) = delete;
+        output_sink & operator=(const output_sink &) = delete;
+
+        inline
+        void
+        write(const char * p_data
+             ,size_t p_size
+             );
+
+        inline
+        void
+        write(const std::string & p_string);
+
+        inline
+        bool
+        is_open() const;
+
+        /**
+         * Number of bytes given to write since creation
+         */
+        inline
+        uint64_t
+        get_nb_bytes() const;
+
+        /**
+         * Write remaining data, synchronise file on disk and close it.
+         * Throw if an error occurred while writing
+         */
+        inline
+        void
+        close();
+
+        /**
+         * Give buffer to background thread once it has written the previous
+         * one, without waiting for buffer to be full
+         */
+        inline
+        void
+        hand_over();
+
+      private:
+
+        /**
+         * Background thread writing buffers
+         */
+        inline
+        void
+        flush();
+
+        /**
+         * Stop background thread and close file
+         * @return error message, empty if there were no error
+         */
+        inline
+        std::string
+        terminate();
+
+        std::string m_file_name;
+
+        int m_fd;
+
+        size_t m_buffer_size;
+
+        /**
+         * Buffer being filled
+         */
+        std::vector<char> m_current;
+
+        /**
+         * Buffer being written by background thread
+         */
+        std::vector<char> m_pending;
+
+        bool m_has_pending;
+
+        bool m_stop;
+
+        /**
+         * First error met by background thread
+         */
+        std::string m_error;
+
+        std::mutex m_mutex;
+
+        std::condition_variable m_condition;
+
+        std::thread m_thread;
+
+        uint64_t m_nb_bytes;
+
+        /**
+         * Time spent in system calls writing file
+         */
+        std::chrono::steady_clock::duration m_io_duration;
+    };
+
+    //-------------------------------------------------------------------------
+    output_sink::output_sink(const std::string & p_file_name
+                            ,size_t p_buffer_size
+                            )
+    :m_file_name(p_file_name)
+    ,m_fd{open(p_file_name.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644)}
+    ,m_buffer_size{p_buffer_size ? p_buffer_size : 1}
+    ,m_has_pending{false}
+    ,m_stop{false}
+    ,m_nb_bytes{0}
+    ,m_io_duration(std::chrono::steady_clock::duration::zero())
+    {
+        if(-1 == m_fd)
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error opening output file ")" + p_file_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        m_current.reserve(m_buffer_size);
+        m_pending.reserve(m_buffer_size);
+        m_thread = std::thread(&output_sink::flush, this);
+    }
+
+    //-------------------------------------------------------------------------
+    output_sink::~output_sink()
+    {
+        if(is_open())
+        {
+            hand_over();
+            terminate();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    output_sink::write(const char * p_data
+                      ,size_t p_size
+                      )
+    {
+        m_nb_bytes += p_size;
+        while(p_size)
+        {
+            size_t l_size = std::min(p_size, m_buffer_size - m_current.size());
+            m_current.insert(m_current.end(), p_data, p_data + l_size);
+            p_data += l_size;
+            p_size -= l_size;
+            if(m_current.size() == m_buffer_size)
+            {
+                hand_over();
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    output_sink::write(const std::string & p_string)
+    {
+        write(p_string.data(), p_string.size());
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    output_sink::is_open() const
+    {
+        return -1 != m_fd;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    output_sink::get_nb_bytes() const
+    {
+        return m_nb_bytes;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    output_sink::close()
+    {
+        hand_over();
+        std::string l_error = terminate();
+        if(!l_error.empty())
+        {
+            throw quicky_exception::quicky_runtime_exception(l_error
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        double l_duration = std::chrono::duration<double>(m_io_duration).count();
+        uint64_t l_throughput = l_duration > 0 ? (uint64_t)((double)m_nb_bytes / l_duration) : m_nb_bytes;
+        std::cout << m_file_name + " : " + std::to_string(m_nb_bytes) + " bytes written at " + std::to_string(l_throughput) + " bytes/s" << std::endl;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    output_sink::hand_over()
+    {
+        std::unique_lock<std::mutex> l_lock(m_mutex);
+        m_condition.wait(l_lock, [&]{return !m_has_pending;});
+        m_current.swap(m_pending);
+        m_has_pending = true;
+        l_lock.unlock();
+        m_condition.notify_all();
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    output_sink::flush()
+    {
+        while(true)
+        {
+            std::unique_lock<std::mutex> l_lock(m_mutex);
+            m_condition.wait(l_lock, [&]{return m_has_pending || m_stop;});
+            if(!m_has_pending)
+            {
+                return;
+            }
+            l_lock.unlock();
+            std::chrono::steady_clock::time_point l_start = std::chrono::steady_clock::now();
+            const char * l_data = m_pending.data();
+            size_t l_size = m_pending.size();
+            while(l_size && m_error.empty())
+            {
+                ssize_t l_written = ::write(m_fd, l_data, l_size);
+                if(-1 == l_written)
+                {
+                    if(EINTR != errno)
+                    {
+                        m_error = R"(Error writing output file ")" + m_file_name + R"(" : )" + strerror(errno);
+                    }
+                    continue;
+                }
+                l_data += l_written;
+                l_size -= (size_t)l_written;
+            }
+            m_pending.clear();
+            m_io_duration += std::chrono::steady_clock::now() - l_start;
+            l_lock.lock();
+            m_has_pending = false;
+            l_lock.unlock();
+            m_condition.notify_all();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    output_sink::terminate()
+    {
+        {
+            std::lock_guard<std::mutex> l_lock(m_mutex);
+            m_stop = true;
+        }
+        m_condition.notify_all();
+        m_thread.join();
+        // Only data handed over to background thread has been written
+        std::string l_error = m_error;
+        std::chrono::steady_clock::time_point l_start = std::chrono::steady_clock::now();
+        if(l_error.empty() && fsync(m_fd))
+        {
+            l_error = R"(Error synchronising output file ")" + m_file_name + R"(" : )" + strerror(errno);
+        }
+        m_io_duration += std::chrono::steady_clock::now() - l_start;
+        if(::close(m_fd) && l_error.empty())
+        {
+            l_error = R"(Error closing output file ")" + m_file_name + R"(" : )" + strerror(errno);
+        }
+        m_fd = -1;
+        return l_error;
+    }
+
+}
+#endif //DUPLICATION_CHECKER_OUTPUT_SINK_H
+// EOF
@@ -0,0 +1,87 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_PATH_TABLE_H
+#define DUPLICATION_CHECKER_PATH_TABLE_H
+
+#include "text_view.h"
+#include <cstdint>
+#include <deque>
+#include <string>
+#include <unordered_map>
+
+namespace duplication_checker
+{
+    /**
+     * Store each directory path only once and identify it by an index
+     */
+    class path_table
+    {
+      public:
+
+        path_table() = default;
+
+        path_table(const path_table &) = delete;
+        path_table & operator=(const path_table &) = delete;
+
+        /**
+         * Get identifier of path, path is stored if not already known
+         */
+        inline
+        uint32_t
+        intern(const text_view & p_path);
+
+        inline
+        const std::string &
+        get(uint32_t p_id) const;
+
+      private:
+
+        /**
+         * Deque does not move stored strings so views on them stay valid
+         */
+        std::deque<std::string> m_paths;
+
+        std::unordered_map<text_view, uint32_t, text_view_hasher> m_ids;
+    };
+
+    //-------------------------------------------------------------------------
+    uint32_t
+    path_table::intern(const text_view & p_path)
+    {
+        auto l_iter = m_ids.find(p_path);
+        if(m_ids.end() != l_iter)
+        {
+            return l_iter->second;
+        }
+        uint32_t l_id = (uint32_t)m_paths.size();
+        m_paths.emplace_back(p_path.to_string());
+        m_ids.emplace(text_view(m_paths.back()), l_id);
+        return l_id;
+    }
+
+    //-------------------------------------------------------------------------
+    const std::string &
+    path_table::get(uint32_t p_id) const
+    {
+        return m_paths[p_id];
+    }
+
+}
+#endif //DUPLICATION_CHECKER_PATH_TABLE_H
+// EOF
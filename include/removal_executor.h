@@ -0,0 +1,464 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_REMOVAL_EXECUTOR_H
+#define DUPLICATION_CHECKER_REMOVAL_EXECUTOR_H
+
+#include "link_type.h"
+#include "output_sink.h"
+#include <fcntl.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <linux/fs.h>
+#include <sys/ioctl.h>
+#endif // __linux__
+#include <atomic>
+#include <cassert>
+#include <cerrno>
+#include <cstring>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Apply removal decisions in process instead of generating a script.
+     * As in generated script, files are only removed if all files to keep
+     * exist and are not symbolic links. Decisions are checked in the order
+     * they are given, files already scheduled for removal are considered as
+     * missing. Instead of being removed, a file can be replaced by a hard link
+     * or a reflink to the file to keep. Link is created with a temporary name
+     * in the same directory and then renamed over the file so that the file
+     * is never missing. A file which is already a hard link to the file to
+     * keep is left as is.
+     * Scheduled operations are performed in parallel, one directory per
+     * thread at a time, and each of them is recorded in a journal
+     */
+    class removal_executor
+    {
+      public:
+
+        /**
+         * @param p_dry_run only record what would be removed
+         * @param p_journal_name file recording removals
+         * @param p_nb_threads number of threads removing files
+         * @param p_link_type kind of link replacing files
+         */
+        inline
+        removal_executor(bool p_dry_run
+                        ,const std::string & p_journal_name
+                        ,unsigned int p_nb_threads
+                        ,link_type p_link_type = link_type::HARD
+                        );
+
+        /**
+         * Check files to keep and schedule removal of others if possible
+         * @param p_link replace files by a link to the single file to keep
+         * instead of removing them
+         */
+        inline
+        void
+        add(const std::vector<std::string> & p_keep
+           ,const std::vector<std::string> & p_remove
+           ,bool p_link = false
+           );
+
+        /**
+         * Perform scheduled removals, close journal and print summary
+         */
+        inline
+        void
+        finish();
+
+        /**
+         * Perform scheduled operations without waiting for more of them
+         */
+        inline
+        void
+        execute();
+
+      private:
+
+        /**
+         * Remove or replace files of a directory and store errno of each
+         * operation
+         */
+        inline
+        void
+        remove_in_directory(size_t p_directory_index);
+
+        /**
+         * Create a link to p_target named p_name in directory p_directory_fd
+         * @return errno of failing operation, 0 if link has been created
+         */
+        inline
+        int
+        create_link(int p_directory_fd
+                   ,const std::string & p_name
+                   ,const std::string & p_target
+                   ) const;
+
+        /**
+         * @return empty string if file can be kept otherwise reason why it
+         * cannot
+         */
+        inline
+        std::string
+        check_keep(const std::string & p_name) const;
+
+        bool m_dry_run;
+
+        unsigned int m_nb_threads;
+
+        link_type m_link_type;
+
+        output_sink m_journal;
+
+        /**
+         * Files scheduled for removal, kept for whole run in dry run mode as
+         * files are not really removed
+         */
+        std::unordered_set<std::string> m_scheduled;
+
+        /**
+         * Targets of pending links, they must exist until links are created
+         */
+        std::unordered_set<std::string> m_link_targets;
+
+        /**
+         * Files to remove grouped by directory with target of link replacing
+         * them, target is empty if file is only removed
+         */
+        std::vector<std::pair<std::string, std::vector<std::pair<std::string, std::string>>>> m_directories;
+
+        std::unordered_map<std::string, size_t> m_directory_indexes;
+
+        /**
+         * Result of removals, same layout as m_directories
+         */
+        std::vector<std::vector<int>> m_errors;
+
+        size_t m_nb_pending;
+
+        uint64_t m_nb_removed;
+
+        uint64_t m_nb_linked;
+
+        uint64_t m_nb_already_linked;
+
+        uint64_t m_nb_failed;
+
+        uint64_t m_nb_rejected;
+
+        /**
+         * Number of pending removals triggering their execution
+         */
+        static const size_t m_max_pending = 65536;
+
+        /**
+         * Result of an operation skipped because file and link target are
+         * already the same file, errno values are positive
+         */
+        static const int m_already_linked = -1;
+    };
+
+    //-------------------------------------------------------------------------
+    removal_executor::removal_executor(bool p_dry_run
+                                      ,const std::string & p_journal_name
+                                      ,unsigned int p_nb_threads
+                                      ,link_type p_link_type
+                                      )
+    :m_dry_run{p_dry_run}
+    ,m_nb_threads{p_nb_threads ? p_nb_threads : 1}
+    ,m_link_type{p_link_type}
+    ,m_journal(p_journal_name)
+    ,m_nb_pending{0}
+    ,m_nb_removed{0}
+    ,m_nb_linked{0}
+    ,m_nb_already_linked{0}
+    ,m_nb_failed{0}
+    ,m_nb_rejected{0}
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    removal_executor::add(const std::vector<std::string> & p_keep
+                         ,const std::vector<std::string> & p_remove
+                         ,bool p_link
+                         )
+    {
+        assert(!p_link || 1 == p_keep.size());
+        bool l_ok = true;
+        for(const auto & l_iter: p_keep)
+        {
+            std::string l_reason = check_keep(l_iter);
+            if(!l_reason.empty())
+            {
+                std::cout << R"(File ")" << l_iter << R"(" )" << l_reason << std::endl;
+                l_ok = false;
+            }
+        }
+        if(!l_ok)
+        {
+            m_nb_rejected += p_remove.size();
+            return;
+        }
+        // Removing or replacing a pending link target would race with
+        // creation of the link
+        for(const auto & l_iter: p_remove)
+        {
+            if(m_link_targets.end() != m_link_targets.find(l_iter))
+            {
+                execute();
+                break;
+            }
+        }
+        for(const auto & l_iter: p_remove)
+        {
+            // Replaced files are still present so they are not remembered but
+            // a file already scheduled for removal must not be recreated
+            if(p_link ? m_scheduled.end() != m_scheduled.find(l_iter) : !m_scheduled.insert(l_iter).second)
+            {
+                continue;
+            }
+            size_t l_separator_pos = l_iter.rfind('/');
+            std::string l_directory = std::string::npos == l_separator_pos ? "." : (l_separator_pos ? l_iter.substr(0, l_separator_pos) : "/");
+            std::string l_name = std::string::npos == l_separator_pos ? l_iter : l_iter.substr(l_separator_pos + 1);
+            auto l_insert = m_directory_indexes.emplace(l_directory, m_directories.size());
+            if(l_insert.second)
+            {
+                m_directories.emplace_back(l_directory, std::vector<std::pair<std::string, std::string>>());
+            }
+            m_directories[l_insert.first->second].second.emplace_back(l_name, p_link ? p_keep.front() : std::string());
+            ++m_nb_pending;
+        }
+        if(p_link && !p_remove.empty())
+        {
+            m_link_targets.insert(p_keep.front());
+        }
+        if(m_nb_pending >= m_max_pending)
+        {
+            execute();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    removal_executor::finish()
+    {
+        execute();
+        m_journal.close();
+        std::cout << std::to_string(m_nb_removed) + (m_dry_run ? " files would be removed, " : " files removed, ") + std::to_string(m_nb_linked) + (m_dry_run ? " files would be linked, " : " files linked, ") + std::to_string(m_nb_already_linked) + " already linked, " + std::to_string(m_nb_failed) + " failures, " + std::to_string(m_nb_rejected) + " removals cancelled" << std::endl;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    removal_executor::execute()
+    {
+        m_errors.assign(m_directories.size(), std::vector<int>());
+        if(!m_dry_run)
+        {
+            std::atomic<size_t> l_next_index{0};
+            auto l_thread_body = [&]()
+            {
+                size_t l_next;
+                while((l_next = l_next_index++) < m_directories.size())
+                {
+                    remove_in_directory(l_next);
+                }
+            };
+            std::vector<std::thread> l_threads;
+            for(unsigned int l_index = 0; l_index < m_nb_threads; ++l_index)
+            {
+                l_threads.emplace_back(l_thread_body);
+            }
+            for(auto & l_iter: l_threads)
+            {
+                l_iter.join();
+            }
+        }
+
+        // Journal is written in a deterministic order
+        for(size_t l_directory_index = 0; l_directory_index < m_directories.size(); ++l_directory_index)
+        {
+            const auto & l_directory = m_directories[l_directory_index];
+            std::string l_prefix = "." == l_directory.first ? "" : ("/" == l_directory.first ? "/" : l_directory.first + "/");
+            for(size_t l_index = 0; l_index < l_directory.second.size(); ++l_index)
+            {
+                std::string l_name = l_prefix + l_directory.second[l_index].first;
+                const std::string & l_target = l_directory.second[l_index].second;
+                int l_error = m_dry_run ? 0 : m_errors[l_directory_index][l_index];
+                if(!l_error && l_target.empty())
+                {
+                    m_journal.write((m_dry_run ? "would remove " : "removed ") + l_name + "\n");
+                    ++m_nb_removed;
+                }
+                else if(!l_error)
+                {
+                    m_journal.write((m_dry_run ? "would link " : "linked ") + l_name + " to " + l_target + "\n");
+                    ++m_nb_linked;
+                }
+                else if(m_already_linked == l_error)
+                {
+                    m_journal.write("already linked " + l_name + " to " + l_target + "\n");
+                    ++m_nb_already_linked;
+                }
+                else
+                {
+                    m_journal.write("failed " + l_name + " : " + strerror(l_error) + "\n");
+                    ++m_nb_failed;
+                }
+            }
+        }
+
+        m_directories.clear();
+        m_directory_indexes.clear();
+        m_link_targets.clear();
+        m_errors.clear();
+        m_nb_pending = 0;
+        // Once removed, files are really missing so they no longer need to
+        // be remembered
+        if(!m_dry_run)
+        {
+            m_scheduled.clear();
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    removal_executor::remove_in_directory(size_t p_directory_index)
+    {
+        const auto & l_directory = m_directories[p_directory_index];
+        std::vector<int> & l_errors = m_errors[p_directory_index];
+        l_errors.assign(l_directory.second.size(), 0);
+        int l_fd = open(l_directory.first.c_str(), O_RDONLY | O_DIRECTORY);
+        if(-1 == l_fd)
+        {
+            l_errors.assign(l_directory.second.size(), errno);
+            return;
+        }
+        for(size_t l_index = 0; l_index < l_directory.second.size(); ++l_index)
+        {
+            const std::string & l_name = l_directory.second[l_index].first;
+            const std::string & l_target = l_directory.second[l_index].second;
+            if(l_target.empty())
+            {
+                if(unlinkat(l_fd, l_name.c_str(), 0))
+                {
+                    l_errors[l_index] = errno;
+                }
+                continue;
+            }
+            // Renaming a link over another link to same file does nothing
+            // and would leave temporary name behind
+            struct stat l_target_stat;
+            struct stat l_stat;
+            if(!fstatat(AT_FDCWD, l_target.c_str(), &l_target_stat, 0) && !fstatat(l_fd, l_name.c_str(), &l_stat, AT_SYMLINK_NOFOLLOW) && l_target_stat.st_dev == l_stat.st_dev && l_target_stat.st_ino == l_stat.st_ino)
+            {
+                l_errors[l_index] = m_already_linked;
+                continue;
+            }
+            std::string l_temporary_name = l_name + ".dc_tmp";
+            l_errors[l_index] = create_link(l_fd, l_temporary_name, l_target);
+            if(!l_errors[l_index] && renameat(l_fd, l_temporary_name.c_str(), l_fd, l_name.c_str()))
+            {
+                l_errors[l_index] = errno;
+                unlinkat(l_fd, l_temporary_name.c_str(), 0);
+            }
+        }
+        close(l_fd);
+    }
+
+    //-------------------------------------------------------------------------
+    int
+    removal_executor::create_link(int p_directory_fd
+                                 ,const std::string & p_name
+                                 ,const std::string & p_target
+                                 ) const
+    {
+        if(link_type::HARD == m_link_type)
+        {
+            return linkat(AT_FDCWD, p_target.c_str(), p_directory_fd, p_name.c_str(), 0) ? errno : 0;
+        }
+#ifdef FICLONE
+        int l_source_fd = open(p_target.c_str(), O_RDONLY);
+        if(-1 == l_source_fd)
+        {
+            return errno;
+        }
+        int l_error = 0;
+        struct stat l_stat;
+        int l_fd = -1;
+        if(fstat(l_source_fd, &l_stat) || -1 == (l_fd = openat(p_directory_fd, p_name.c_str(), O_WRONLY | O_CREAT | O_EXCL, l_stat.st_mode & 07777)))
+        {
+            l_error = errno;
+        }
+        else
+        {
+            // Keep modification time of file as cp -p does
+            struct timespec l_times[2] = {l_stat.st_atim, l_stat.st_mtim};
+            if(ioctl(l_fd, FICLONE, l_source_fd) || futimens(l_fd, l_times))
+            {
+                l_error = errno;
+            }
+            close(l_fd);
+            if(l_error)
+            {
+                unlinkat(p_directory_fd, p_name.c_str(), 0);
+            }
+        }
+        close(l_source_fd);
+        return l_error;
+#else // FICLONE
+        return EOPNOTSUPP;
+#endif // FICLONE
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    removal_executor::check_keep(const std::string & p_name) const
+    {
+        if(m_scheduled.end() != m_scheduled.find(p_name))
+        {
+            return "is scheduled for removal";
+        }
+        struct stat l_stat;
+        if(fstatat(AT_FDCWD, p_name.c_str(), &l_stat, AT_SYMLINK_NOFOLLOW))
+        {
+            return "is missing";
+        }
+        if(S_ISLNK(l_stat.st_mode))
+        {
+            return "is a link";
+        }
+        if(!S_ISREG(l_stat.st_mode))
+        {
+            return "is not a regular file";
+        }
+        return "";
+    }
+
+}
+#endif //DUPLICATION_CHECKER_REMOVAL_EXECUTOR_H
+// EOF
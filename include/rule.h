@@ -31,6 +31,8 @@ class rule
     , RM_SECOND
     , IGNORE
     , SKIP
+    , LINK_FIRST
+    , LINK_SECOND
     } t_rule_cmd;
 
     inline
@@ -123,6 +125,14 @@ rule::to_rule_cmd(const std::string & p_cmd_str)
     {
         return t_rule_cmd::SKIP;
     }
+    else if("LINK_FIRST" == p_cmd_str)
+    {
+        return t_rule_cmd::LINK_FIRST;
+    }
+    else if("LINK_SECOND" == p_cmd_str)
+    {
+        return t_rule_cmd::LINK_SECOND;
+    }
     throw quicky_exception::quicky_logic_exception("String \"" + p_cmd_str +  "\" is not a correct rule cmd"
                                                   , __LINE__
                                                   , __FILE__
@@ -143,6 +153,10 @@ rule::to_string(const rule::t_rule_cmd p_rule_cmd)
             return "IGNORE";
         case t_rule_cmd::SKIP:
             return "SKIP";
+        case t_rule_cmd::LINK_FIRST:
+            return "LINK_FIRST";
+        case t_rule_cmd::LINK_SECOND:
+            return "LINK_SECOND";
         default:
             throw quicky_exception::quicky_logic_exception( "Unknown rule command value " + std::to_string((unsigned int)p_rule_cmd)
                                                           , __LINE__
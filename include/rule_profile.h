@@ -0,0 +1,527 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_RULE_PROFILE_H
+#define DUPLICATION_CHECKER_RULE_PROFILE_H
+
+#include "rule_set.h"
+#include "keep_only_set.h"
+#include "quicky_exception.h"
+#include <atomic>
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <functional>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Number of hits of each rule and keep only rule accumulated across runs.
+     * Profile is a text file:
+     * - header: "#rule_profile", version, number of runs
+     * - one line per rule: hits, number of consecutive runs without hit and
+     *   key made of rule content, separated by tabulations
+     * Rules are identified by their content so that profile remains valid
+     * when config is edited, unknown rules start with no hit.
+     * Optionally rules unused for a number of runs are removed from updated
+     * config, remaining ones keep their declaration order: rules are found
+     * through indexes so their order does not change lookup cost, whereas
+     * for groups with several files in a directory the first declared keep
+     * only rule matching wins so reordering could change decisions. A run
+     * which does not process all groups is not counted as unused for rules
+     * it did not hit since they may simply not have been reached
+     */
+    class rule_profile
+    {
+      public:
+
+        /**
+         * @param p_input_name profile of previous runs, ignored if missing
+         * @param p_output_name file where updated profile is written
+         * @param p_prune_threshold if not 0, rules without hit during this
+         * number of consecutive runs are removed from config
+         */
+        inline
+        rule_profile(const std::string & p_input_name
+                    ,const std::string & p_output_name
+                    ,unsigned int p_prune_threshold
+                    );
+
+        rule_profile(const rule_profile &) = delete;
+        rule_profile & operator=(const rule_profile &) = delete;
+
+        /**
+         * Associate history to rules loaded from config, must be called
+         * before any hit is recorded
+         */
+        inline
+        void
+        start(const rule_set & p_rules
+             ,const keep_only_set & p_keep_only
+             );
+
+        /**
+         * Thread safe, hits of rules added after start are not counted
+         */
+        inline
+        void
+        add_rule_hit(size_t p_index);
+
+        inline
+        void
+        add_keep_only_hit(size_t p_index);
+
+        /**
+         * Accumulate hits of this run, prune rules if requested then write
+         * updated profile
+         * @param p_complete false if run ended before all groups were
+         * processed, rules without hit are then not counted as unused
+         */
+        inline
+        void
+        finish(rule_set & p_rules
+              ,keep_only_set & p_keep_only
+              ,bool p_complete
+              );
+
+      private:
+
+        class record
+        {
+          public:
+
+            uint64_t m_nb_hits;
+
+            /**
+             * Number of consecutive runs without hit
+             */
+            uint64_t m_nb_unused_runs;
+        };
+
+        inline
+        void
+        load();
+
+        /**
+         * Remove first record of previous runs having this key
+         * @return record without hit if there is none
+         */
+        inline
+        record
+        take_history(const std::string & p_key);
+
+        /**
+         * Update record with hits of this run
+         * @return true if rule has to be kept
+         */
+        inline
+        bool
+        update(record & p_record
+              ,uint64_t p_nb_hits
+              ,bool p_complete
+              ) const;
+
+        inline
+        void
+        write_record(std::string & p_buffer
+                    ,const record & p_record
+                    ,const std::string & p_key
+                    ) const;
+
+        static inline
+        std::string
+        get_key(const rule & p_rule);
+
+        static inline
+        std::string
+        get_key(const keep_only & p_keep_only);
+
+        /**
+         * Escape tabulations, new lines and backslashes of path so that key
+         * fields are separated by tabulations
+         */
+        static inline
+        void
+        append_escaped(std::string & p_key
+                      ,const std::string & p_path
+                      );
+
+        std::string m_input_name;
+
+        std::string m_output_name;
+
+        unsigned int m_prune_threshold;
+
+        uint64_t m_nb_runs;
+
+        /**
+         * Records of previous runs indexed by key in file order, several
+         * rules can have same content. Released by start
+         */
+        std::unordered_map<std::string, std::vector<record>> m_history;
+
+        /**
+         * Records of rules in their order at start
+         */
+        std::vector<record> m_rule_records;
+
+        std::vector<record> m_keep_only_records;
+
+        std::unique_ptr<std::atomic<uint64_t>[]> m_rule_hits;
+
+        std::unique_ptr<std::atomic<uint64_t>[]> m_keep_only_hits;
+
+        static const unsigned int m_version = 1;
+    };
+
+    //-------------------------------------------------------------------------
+    rule_profile::rule_profile(const std::string & p_input_name
+                              ,const std::string & p_output_name
+                              ,unsigned int p_prune_threshold
+                              )
+    :m_input_name{p_input_name}
+    ,m_output_name{p_output_name}
+    ,m_prune_threshold{p_prune_threshold}
+    ,m_nb_runs{0}
+    {
+        load();
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    rule_profile::start(const rule_set & p_rules
+                       ,const keep_only_set & p_keep_only
+                       )
+    {
+        m_rule_records.reserve(p_rules.size());
+        for(const auto & l_iter: p_rules)
+        {
+            m_rule_records.emplace_back(take_history(get_key(l_iter)));
+        }
+        m_keep_only_records.reserve(p_keep_only.size());
+        for(const auto & l_iter: p_keep_only)
+        {
+            m_keep_only_records.emplace_back(take_history(get_key(l_iter)));
+        }
+        m_history.clear();
+
+        m_rule_hits.reset(new std::atomic<uint64_t>[m_rule_records.size()]);
+        for(size_t l_index = 0; l_index < m_rule_records.size(); ++l_index)
+        {
+            m_rule_hits[l_index] = 0;
+        }
+        m_keep_only_hits.reset(new std::atomic<uint64_t>[m_keep_only_records.size()]);
+        for(size_t l_index = 0; l_index < m_keep_only_records.size(); ++l_index)
+        {
+            m_keep_only_hits[l_index] = 0;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    rule_profile::add_rule_hit(size_t p_index)
+    {
+        if(p_index < m_rule_records.size())
+        {
+            m_rule_hits[p_index].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    rule_profile::add_keep_only_hit(size_t p_index)
+    {
+        if(p_index < m_keep_only_records.size())
+        {
+            m_keep_only_hits[p_index].fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    rule_profile::finish(rule_set & p_rules
+                        ,keep_only_set & p_keep_only
+                        ,bool p_complete
+                        )
+    {
+        ++m_nb_runs;
+        std::string l_buffer = "#rule_profile " + std::to_string(m_version) + " " + std::to_string(m_nb_runs) + "\n";
+
+        // Pruned rules are written after kept ones so that history of
+        // copies of a rule remains in declaration order of updated config
+        std::string l_pruned_buffer;
+
+        // Rules created interactively during this run start with no history
+        uint64_t l_nb_rule_hits = 0;
+        size_t l_nb_rules = p_rules.size();
+        std::vector<std::pair<const rule *, record>> l_rules;
+        l_rules.reserve(l_nb_rules);
+        size_t l_index = 0;
+        for(const auto & l_iter: p_rules)
+        {
+            record l_record{0, 0};
+            if(l_index < m_rule_records.size())
+            {
+                l_record = m_rule_records[l_index];
+                uint64_t l_nb_hits = m_rule_hits[l_index];
+                l_nb_rule_hits += l_nb_hits;
+                if(!update(l_record, l_nb_hits, p_complete))
+                {
+                    write_record(l_pruned_buffer, l_record, get_key(l_iter));
+                    ++l_index;
+                    continue;
+                }
+            }
+            l_rules.emplace_back(&l_iter, l_record);
+            ++l_index;
+        }
+
+        uint64_t l_nb_keep_only_hits = 0;
+        size_t l_nb_keep_only = p_keep_only.size();
+        std::vector<std::pair<const keep_only *, record>> l_keep_only;
+        l_keep_only.reserve(l_nb_keep_only);
+        l_index = 0;
+        for(const auto & l_iter: p_keep_only)
+        {
+            record l_record{0, 0};
+            if(l_index < m_keep_only_records.size())
+            {
+                l_record = m_keep_only_records[l_index];
+                uint64_t l_nb_hits = m_keep_only_hits[l_index];
+                l_nb_keep_only_hits += l_nb_hits;
+                if(!update(l_record, l_nb_hits, p_complete))
+                {
+                    write_record(l_pruned_buffer, l_record, get_key(l_iter));
+                    ++l_index;
+                    continue;
+                }
+            }
+            l_keep_only.emplace_back(&l_iter, l_record);
+            ++l_index;
+        }
+
+        for(const auto & l_iter: l_rules)
+        {
+            write_record(l_buffer, l_iter.second, get_key(*l_iter.first));
+        }
+        for(const auto & l_iter: l_keep_only)
+        {
+            write_record(l_buffer, l_iter.second, get_key(*l_iter.first));
+        }
+        l_buffer += l_pruned_buffer;
+
+        std::cout << "Rule profile : " + std::to_string(l_nb_rule_hits) + " rule hits, " + std::to_string(l_nb_keep_only_hits) + " keep only hits" + (p_complete ? "" : ", run incomplete so rules without hit are not counted as unused") << std::endl;
+        if(m_prune_threshold)
+        {
+            std::cout << std::to_string(l_nb_rules - l_rules.size()) + " rules and " + std::to_string(l_nb_keep_only - l_keep_only.size()) + " keep only unused for " + std::to_string(m_prune_threshold) + " runs pruned" << std::endl;
+
+            rule_set l_pruned_rules;
+            l_pruned_rules.reserve(l_rules.size());
+            for(const auto & l_iter: l_rules)
+            {
+                l_pruned_rules.emplace_back(l_iter.first->get_cmd(), l_iter.first->get_path_1(), l_iter.first->get_path_2());
+            }
+            keep_only_set l_pruned_keep_only;
+            l_pruned_keep_only.reserve(l_keep_only.size());
+            for(const auto & l_iter: l_keep_only)
+            {
+                l_pruned_keep_only.add(*l_iter.first);
+            }
+            p_rules = std::move(l_pruned_rules);
+            p_keep_only = std::move(l_pruned_keep_only);
+        }
+
+        std::string l_tmp_file_name = m_output_name + ".tmp";
+        std::ofstream l_file(l_tmp_file_name, std::ios::binary | std::ios::trunc);
+        if(!l_file.is_open())
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error opening rule profile file ")" + l_tmp_file_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        l_file.write(l_buffer.data(), (std::streamsize)l_buffer.size());
+        l_file.close();
+        if(l_file.fail() || rename(l_tmp_file_name.c_str(), m_output_name.c_str()))
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error writing rule profile file ")" + m_output_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    rule_profile::load()
+    {
+        std::ifstream l_file(m_input_name, std::ios::binary);
+        if(!l_file.is_open())
+        {
+            std::cout << R"(No rule profile ")" + m_input_name + R"(")" << std::endl;
+            return;
+        }
+        std::string l_line;
+        std::string l_header = "#rule_profile " + std::to_string(m_version) + " ";
+        if(!std::getline(l_file, l_line) || l_line.compare(0, l_header.size(), l_header))
+        {
+            std::cout << R"(WARNING : ignore invalid rule profile ")" + m_input_name + R"(")" << std::endl;
+            return;
+        }
+        try
+        {
+            m_nb_runs = std::stoull(l_line.substr(l_header.size()));
+            while(std::getline(l_file, l_line))
+            {
+                size_t l_first_tab = l_line.find('\t');
+                size_t l_second_tab = std::string::npos == l_first_tab ? std::string::npos : l_line.find('\t', l_first_tab + 1);
+                if(std::string::npos == l_second_tab)
+                {
+                    throw std::invalid_argument(l_line);
+                }
+                record l_record{std::stoull(l_line.substr(0, l_first_tab))
+                               ,std::stoull(l_line.substr(l_first_tab + 1, l_second_tab - l_first_tab - 1))
+                               };
+                m_history[l_line.substr(l_second_tab + 1)].emplace_back(l_record);
+            }
+        }
+        catch(const std::exception &)
+        {
+            std::cout << R"(WARNING : ignore invalid rule profile ")" + m_input_name + R"(")" << std::endl;
+            m_nb_runs = 0;
+            m_history.clear();
+            return;
+        }
+        std::cout << R"(Rule profile ")" + m_input_name + R"(" loaded)" << std::endl;
+    }
+
+    //-------------------------------------------------------------------------
+    rule_profile::record
+    rule_profile::take_history(const std::string & p_key)
+    {
+        auto l_iter = m_history.find(p_key);
+        if(m_history.end() == l_iter || l_iter->second.empty())
+        {
+            return record{0, 0};
+        }
+        // Copies of a rule are found in declaration order
+        record l_record = l_iter->second.front();
+        l_iter->second.erase(l_iter->second.begin());
+        return l_record;
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    rule_profile::update(record & p_record
+                        ,uint64_t p_nb_hits
+                        ,bool p_complete
+                        ) const
+    {
+        p_record.m_nb_hits += p_nb_hits;
+        if(p_nb_hits)
+        {
+            p_record.m_nb_unused_runs = 0;
+        }
+        else if(p_complete)
+        {
+            ++p_record.m_nb_unused_runs;
+        }
+        return !m_prune_threshold || p_record.m_nb_unused_runs < m_prune_threshold;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    rule_profile::write_record(std::string & p_buffer
+                              ,const record & p_record
+                              ,const std::string & p_key
+                              ) const
+    {
+        p_buffer += std::to_string(p_record.m_nb_hits);
+        p_buffer += '\t';
+        p_buffer += std::to_string(p_record.m_nb_unused_runs);
+        p_buffer += '\t';
+        p_buffer += p_key;
+        p_buffer += '\n';
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    rule_profile::get_key(const rule & p_rule)
+    {
+        std::string l_key = "rule\t" + rule::to_string(p_rule.get_cmd()) + "\t";
+        append_escaped(l_key, p_rule.get_path_1());
+        l_key += '\t';
+        append_escaped(l_key, p_rule.get_path_2());
+        return l_key;
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    rule_profile::get_key(const keep_only & p_keep_only)
+    {
+        // Paths to keep and to remove are both listed so two rules on same
+        // paths keeping different files have different keys
+        std::string l_key = "keep_only";
+        std::function<void(const std::string &)> l_add_keep = [&](const std::string & p_path) -> void
+        {
+            l_key += "\tkeep\t";
+            append_escaped(l_key, p_path);
+        };
+        std::function<void(const std::string &)> l_add_remove = [&](const std::string & p_path) -> void
+        {
+            l_key += "\tremove\t";
+            append_escaped(l_key, p_path);
+        };
+        p_keep_only.apply_to_keep(l_add_keep);
+        p_keep_only.apply_to_remove(l_add_remove);
+        return l_key;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    rule_profile::append_escaped(std::string & p_key
+                                ,const std::string & p_path
+                                )
+    {
+        for(auto l_char: p_path)
+        {
+            switch(l_char)
+            {
+                case '\\':
+                    p_key += "\\\\";
+                    break;
+                case '\t':
+                    p_key += "\\t";
+                    break;
+                case '\n':
+                    p_key += "\\n";
+                    break;
+                default:
+                    p_key += l_char;
+            }
+        }
+    }
+
+}
+#endif //DUPLICATION_CHECKER_RULE_PROFILE_H
+// EOF
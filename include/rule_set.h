@@ -0,0 +1,168 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_RULE_SET_H
+#define DUPLICATION_CHECKER_RULE_SET_H
+
+#include "rule.h"
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Rules in declaration order indexed by their couple of paths.
+     * When several rules have the same paths the first declared one is found
+     */
+    class rule_set
+    {
+      public:
+
+        typedef std::vector<rule>::const_iterator const_iterator;
+
+        inline
+        void
+        emplace_back(rule::t_rule_cmd p_cmd
+                    ,const std::string & p_path_1
+                    ,const std::string & p_path_2
+                    );
+
+        /**
+         * Search first rule matching paths
+         * @return nullptr if no rule match
+         */
+        inline
+        const rule *
+        find(const std::string & p_path_1
+            ,const std::string & p_path_2
+            ) const;
+
+        /**
+         * Position in declaration order of a rule returned by find
+         */
+        inline
+        size_t
+        index_of(const rule * p_rule) const;
+
+        /**
+         * Allocate storage and index for p_nb rules
+         */
+        inline
+        void
+        reserve(size_t p_nb);
+
+        inline
+        size_t
+        size() const;
+
+        inline
+        bool
+        empty() const;
+
+        inline
+        const_iterator
+        begin() const;
+
+        inline
+        const_iterator
+        end() const;
+
+      private:
+
+        std::vector<rule> m_rules;
+
+        /**
+         * Index of first rule for path_1 then path_2
+         */
+        std::unordered_map<std::string, std::unordered_map<std::string, size_t>> m_index;
+    };
+
+    //-------------------------------------------------------------------------
+    void
+    rule_set::emplace_back(rule::t_rule_cmd p_cmd
+                          ,const std::string & p_path_1
+                          ,const std::string & p_path_2
+                          )
+    {
+        // Insertion does nothing if an older rule has same paths
+        m_index[p_path_1].emplace(p_path_2, m_rules.size());
+        m_rules.emplace_back(p_cmd, p_path_1, p_path_2);
+    }
+
+    //-------------------------------------------------------------------------
+    const rule *
+    rule_set::find(const std::string & p_path_1
+                  ,const std::string & p_path_2
+                  ) const
+    {
+        auto l_iter_1 = m_index.find(p_path_1);
+        if(m_index.end() == l_iter_1)
+        {
+            return nullptr;
+        }
+        auto l_iter_2 = l_iter_1->second.find(p_path_2);
+        return l_iter_1->second.end() == l_iter_2 ? nullptr : &m_rules[l_iter_2->second];
+    }
+
+    //-------------------------------------------------------------------------
+    size_t
+    rule_set::index_of(const rule * p_rule) const
+    {
+        return (size_t)(p_rule - m_rules.data());
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    rule_set::reserve(size_t p_nb)
+    {
+        m_rules.reserve(p_nb);
+        m_index.reserve(p_nb);
+    }
+
+    //-------------------------------------------------------------------------
+    size_t
+    rule_set::size() const
+    {
+        return m_rules.size();
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    rule_set::empty() const
+    {
+        return m_rules.empty();
+    }
+
+    //-------------------------------------------------------------------------
+    rule_set::const_iterator
+    rule_set::begin() const
+    {
+        return m_rules.begin();
+    }
+
+    //-------------------------------------------------------------------------
+    rule_set::const_iterator
+    rule_set::end() const
+    {
+        return m_rules.end();
+    }
+
+}
+#endif //DUPLICATION_CHECKER_RULE_SET_H
+// EOF
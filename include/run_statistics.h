@@ -0,0 +1,471 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_RUN_STATISTICS_H
+#define DUPLICATION_CHECKER_RUN_STATISTICS_H
+
+#include "rule.h"
+#include "quicky_exception.h"
+#include <time.h>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <fstream>
+#include <iostream>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Wall and CPU time of run phases and counters of what has been done.
+     * Counters can be updated by several threads. Checker only owns an
+     * instance when statistics are requested so that disabled statistics
+     * cost a pointer test at places which are not executed for every line.
+     * Optionally a background thread prints progress periodically
+     */
+    class run_statistics
+    {
+      public:
+
+        enum class phase
+        { CONFIG
+        , INPUT
+        , GROUPS
+        , OUTPUT
+        , DUMP
+        };
+
+        /**
+         * Start point of a measure, created by thread doing measured work
+         * since CPU time is the one of calling thread
+         */
+        class timer
+        {
+          public:
+
+            /**
+             * Clocks are only read if statistics are enabled
+             */
+            inline explicit
+            timer(const run_statistics * p_statistics);
+
+            inline
+            uint64_t
+            get_wall() const;
+
+            inline
+            uint64_t
+            get_cpu() const;
+
+          private:
+
+            uint64_t m_wall;
+
+            uint64_t m_cpu;
+        };
+
+        /**
+         * @param p_period number of seconds between progress printings, 0
+         * to disable them
+         */
+        inline explicit
+        run_statistics(unsigned int p_period = 0);
+
+        inline
+        ~run_statistics();
+
+        run_statistics(const run_statistics &) = delete;
+        run_statistics & operator=(const run_statistics &) = delete;
+
+        /**
+         * Add time elapsed since p_start to phase minus p_excluded which
+         * has already been accounted in other phases
+         */
+        inline
+        void
+        add_time(phase p_phase
+                ,const timer & p_start
+                ,const std::pair<uint64_t, uint64_t> & p_excluded = std::pair<uint64_t, uint64_t>(0, 0)
+                );
+
+        /**
+         * Wall and CPU time accounted in p_phase
+         */
+        inline
+        std::pair<uint64_t, uint64_t>
+        get_time(phase p_phase) const;
+
+        inline
+        void
+        add_lines(uint64_t p_nb);
+
+        inline
+        void
+        add_group(size_t p_size);
+
+        inline
+        void
+        add_rule_hit(rule::t_rule_cmd p_cmd);
+
+        inline
+        void
+        add_keep_only_hit();
+
+        inline
+        void
+        add_ignored_sha1();
+
+        inline
+        void
+        add_ignored_path();
+
+        inline
+        void
+        add_bytes_written(const std::string & p_file_name
+                         ,uint64_t p_nb
+                         );
+
+        /**
+         * Stop progress printing and write statistics in JSON format
+         */
+        inline
+        void
+        write(const std::string & p_file_name);
+
+      private:
+
+        /**
+         * Background thread printing progress
+         */
+        inline
+        void
+        print_progress();
+
+        static inline
+        uint64_t
+        get_cpu_time(clockid_t p_clock);
+
+        static inline
+        uint64_t
+        get_wall_time();
+
+        inline
+        void
+        stop();
+
+        static const unsigned int m_nb_phases = 5;
+
+        static const unsigned int m_nb_rule_cmds = (unsigned int)rule::t_rule_cmd::LINK_SECOND + 1;
+
+        /**
+         * Groups are counted by power of 2 of their size minus 1
+         */
+        static const unsigned int m_nb_size_classes = 64;
+
+        uint64_t m_start_wall;
+
+        uint64_t m_start_cpu;
+
+        std::atomic<uint64_t> m_wall[m_nb_phases];
+
+        std::atomic<uint64_t> m_cpu[m_nb_phases];
+
+        std::atomic<uint64_t> m_nb_lines;
+
+        std::atomic<uint64_t> m_nb_groups;
+
+        std::atomic<uint64_t> m_groups_by_size[m_nb_size_classes];
+
+        std::atomic<uint64_t> m_rule_hits[m_nb_rule_cmds];
+
+        std::atomic<uint64_t> m_keep_only_hits;
+
+        std::atomic<uint64_t> m_ignored_sha1;
+
+        std::atomic<uint64_t> m_ignored_paths;
+
+        /**
+         * Files and their size, only filled at end of run
+         */
+        std::vector<std::pair<std::string, uint64_t>> m_bytes_written;
+
+        unsigned int m_period;
+
+        std::mutex m_mutex;
+
+        std::condition_variable m_condition;
+
+        bool m_stop;
+
+        std::thread m_progress_thread;
+    };
+
+    //-------------------------------------------------------------------------
+    run_statistics::timer::timer(const run_statistics * p_statistics)
+    :m_wall{p_statistics ? get_wall_time() : 0}
+    ,m_cpu{p_statistics ? get_cpu_time(CLOCK_THREAD_CPUTIME_ID) : 0}
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    run_statistics::timer::get_wall() const
+    {
+        return m_wall;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    run_statistics::timer::get_cpu() const
+    {
+        return m_cpu;
+    }
+
+    //-------------------------------------------------------------------------
+    run_statistics::run_statistics(unsigned int p_period)
+    :m_start_wall{get_wall_time()}
+    ,m_start_cpu{get_cpu_time(CLOCK_PROCESS_CPUTIME_ID)}
+    ,m_nb_lines{0}
+    ,m_nb_groups{0}
+    ,m_keep_only_hits{0}
+    ,m_ignored_sha1{0}
+    ,m_ignored_paths{0}
+    ,m_period{p_period}
+    ,m_stop{false}
+    {
+        for(unsigned int l_index = 0; l_index < m_nb_phases; ++l_index)
+        {
+            m_wall[l_index] = 0;
+            m_cpu[l_index] = 0;
+        }
+        for(auto & l_iter: m_groups_by_size)
+        {
+            l_iter = 0;
+        }
+        for(auto & l_iter: m_rule_hits)
+        {
+            l_iter = 0;
+        }
+        if(m_period)
+        {
+            m_progress_thread = std::thread(&run_statistics::print_progress, this);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    run_statistics::~run_statistics()
+    {
+        stop();
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    run_statistics::add_time(phase p_phase
+                            ,const timer & p_start
+                            ,const std::pair<uint64_t, uint64_t> & p_excluded
+                            )
+    {
+        timer l_end(this);
+        m_wall[(unsigned int)p_phase] += l_end.get_wall() - p_start.get_wall() - p_excluded.first;
+        m_cpu[(unsigned int)p_phase] += l_end.get_cpu() - p_start.get_cpu() - p_excluded.second;
+    }
+
+    //-------------------------------------------------------------------------
+    std::pair<uint64_t, uint64_t>
+    run_statistics::get_time(phase p_phase) const
+    {
+        return std::make_pair(m_wall[(unsigned int)p_phase].load(), m_cpu[(unsigned int)p_phase].load());
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    run_statistics::add_lines(uint64_t p_nb)
+    {
+        m_nb_lines.fetch_add(p_nb, std::memory_order_relaxed);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    run_statistics::add_group(size_t p_size)
+    {
+        unsigned int l_class = 0;
+        for(size_t l_size = p_size - 1; l_size > 1; l_size = (l_size + 1) / 2)
+        {
+            ++l_class;
+        }
+        m_nb_groups.fetch_add(1, std::memory_order_relaxed);
+        m_groups_by_size[l_class].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    run_statistics::add_rule_hit(rule::t_rule_cmd p_cmd)
+    {
+        m_rule_hits[(unsigned int)p_cmd].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    run_statistics::add_keep_only_hit()
+    {
+        m_keep_only_hits.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    run_statistics::add_ignored_sha1()
+    {
+        m_ignored_sha1.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    run_statistics::add_ignored_path()
+    {
+        m_ignored_paths.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    run_statistics::add_bytes_written(const std::string & p_file_name
+                                     ,uint64_t p_nb
+                                     )
+    {
+        m_bytes_written.emplace_back(p_file_name, p_nb);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    run_statistics::write(const std::string & p_file_name)
+    {
+        stop();
+        std::ofstream l_output(p_file_name);
+        if(!l_output.is_open())
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error opening output file ")" + p_file_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        const char * l_phase_names[m_nb_phases] = {"config_parse", "input_scan", "group_processing", "output_writing", "config_dump"};
+        l_output << "{\n";
+        l_output << R"(  "wall_ns": )" << get_wall_time() - m_start_wall << ",\n";
+        l_output << R"(  "cpu_ns": )" << get_cpu_time(CLOCK_PROCESS_CPUTIME_ID) - m_start_cpu << ",\n";
+        l_output << R"(  "phases": {)";
+        for(unsigned int l_index = 0; l_index < m_nb_phases; ++l_index)
+        {
+            l_output << (l_index ? "," : "") << "\n    \"" << l_phase_names[l_index] << R"(": {"wall_ns": )" << m_wall[l_index] << R"(, "cpu_ns": )" << m_cpu[l_index] << "}";
+        }
+        l_output << "\n  },\n";
+        l_output << R"(  "lines_read": )" << m_nb_lines << ",\n";
+        l_output << R"(  "groups": )" << m_nb_groups << ",\n";
+        l_output << R"(  "groups_by_size": {)";
+        bool l_first = true;
+        for(unsigned int l_class = 0; l_class < m_nb_size_classes; ++l_class)
+        {
+            if(m_groups_by_size[l_class])
+            {
+                // Class 0 is 2 files, class N is 2^(N-1)+2 to 2^N+1 files
+                uint64_t l_max = ((uint64_t)1 << l_class) + 1;
+                uint64_t l_min = l_class ? ((uint64_t)1 << (l_class - 1)) + 2 : 2;
+                l_output << (l_first ? "" : ",") << "\n    \"" << (l_min == l_max ? std::to_string(l_min) : std::to_string(l_min) + "-" + std::to_string(l_max)) << R"(": )" << m_groups_by_size[l_class];
+                l_first = false;
+            }
+        }
+        l_output << "\n  },\n";
+        l_output << R"(  "rule_hits": {)";
+        for(unsigned int l_index = 0; l_index < m_nb_rule_cmds; ++l_index)
+        {
+            l_output << (l_index ? "," : "") << "\n    \"" << rule::to_string((rule::t_rule_cmd)l_index) << R"(": )" << m_rule_hits[l_index];
+        }
+        l_output << "\n  },\n";
+        l_output << R"(  "keep_only_hits": )" << m_keep_only_hits << ",\n";
+        l_output << R"(  "ignored_sha1": )" << m_ignored_sha1 << ",\n";
+        l_output << R"(  "ignored_paths": )" << m_ignored_paths << ",\n";
+        l_output << R"(  "bytes_written": {)";
+        for(size_t l_index = 0; l_index < m_bytes_written.size(); ++l_index)
+        {
+            l_output << (l_index ? "," : "") << "\n    \"" << m_bytes_written[l_index].first << R"(": )" << m_bytes_written[l_index].second;
+        }
+        l_output << "\n  }\n}\n";
+        l_output.close();
+        if(l_output.fail())
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error writing ")" + p_file_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    run_statistics::print_progress()
+    {
+        std::unique_lock<std::mutex> l_lock(m_mutex);
+        while(!m_condition.wait_for(l_lock, std::chrono::seconds(m_period), [&]{return m_stop;}))
+        {
+            uint64_t l_nb_rule_hits = 0;
+            for(const auto & l_iter: m_rule_hits)
+            {
+                l_nb_rule_hits += l_iter;
+            }
+            uint64_t l_elapsed = (get_wall_time() - m_start_wall) / 1000000000;
+            std::cout << "Progress after " + std::to_string(l_elapsed) + "s : " + std::to_string(m_nb_lines) + " lines read, " + std::to_string(m_nb_groups) + " groups, " + std::to_string(l_nb_rule_hits) + " rule hits, " + std::to_string(m_keep_only_hits) + " keep only hits" << std::endl;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    run_statistics::get_cpu_time(clockid_t p_clock)
+    {
+        struct timespec l_time;
+        clock_gettime(p_clock, &l_time);
+        return (uint64_t)l_time.tv_sec * 1000000000 + (uint64_t)l_time.tv_nsec;
+    }
+
+    //-------------------------------------------------------------------------
+    uint64_t
+    run_statistics::get_wall_time()
+    {
+        return (uint64_t)std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    run_statistics::stop()
+    {
+        {
+            std::lock_guard<std::mutex> l_lock(m_mutex);
+            m_stop = true;
+        }
+        m_condition.notify_all();
+        if(m_progress_thread.joinable())
+        {
+            m_progress_thread.join();
+        }
+    }
+
+}
+#endif //DUPLICATION_CHECKER_RUN_STATISTICS_H
+// EOF
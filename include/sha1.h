@@ -0,0 +1,793 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_SHA1_H
+#define DUPLICATION_CHECKER_SHA1_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#include <cpuid.h>
+#include <immintrin.h>
+#endif // x86 with GCC or clang
+
+namespace duplication_checker
+{
+    /**
+     * Incremental SHA1 computation producing the same digest as sha1sum.
+     * Blocks are processed by the fastest kernel supported by the CPU,
+     * chosen at first use: SHA extensions, then portable code. Several
+     * messages of same size can also be hashed together, which uses an
+     * AVX2 kernel processing 8 messages at once when CPU has AVX2 but no
+     * SHA extensions
+     */
+    class sha1
+    {
+      public:
+
+        static const size_t m_digest_size = 20;
+
+        /**
+         * Number of messages hashed at once by multi buffer kernel
+         */
+        static const size_t m_nb_lanes = 8;
+
+        inline
+        sha1();
+
+        inline
+        void
+        update(const uint8_t * p_data
+              ,size_t p_size
+              );
+
+        /**
+         * Complete computation and store digest in p_digest which must be
+         * at least m_digest_size bytes long
+         */
+        inline
+        void
+        finalize(uint8_t * p_digest);
+
+        /**
+         * Update p_nb hashes with data of same size, p_hashes[i] receives
+         * p_data[i]. Hashes must have been updated with same sizes before
+         */
+        static inline
+        void
+        update(sha1 * const * p_hashes
+              ,const uint8_t * const * p_data
+              ,size_t p_nb
+              ,size_t p_size
+              );
+
+        /**
+         * @return true if hashing several messages of same size with
+         * update of several hashes is faster than hashing them one by one
+         */
+        static inline
+        bool
+        use_multi_buffer();
+
+        /**
+         * Lower case hexadecimal representation as printed by sha1sum
+         */
+        static inline
+        std::string
+        to_string(const uint8_t * p_digest);
+
+        /**
+         * Convert hexadecimal representation to digest
+         * @return false if p_string is not a valid SHA1 representation
+         */
+        static inline
+        bool
+        from_string(const std::string & p_string
+                   ,uint8_t * p_digest
+                   );
+
+        /**
+         * Convert hexadecimal representation of p_size characters to digest
+         * @return false if characters are not a valid SHA1 representation
+         */
+        static inline
+        bool
+        from_string(const char * p_data
+                   ,size_t p_size
+                   ,uint8_t * p_digest
+                   );
+
+      private:
+
+        typedef void (*block_function)(uint32_t * p_state
+                                      ,const uint8_t * p_data
+                                      ,size_t p_nb_blocks
+                                      );
+
+        typedef void (*multi_block_function)(uint32_t (* p_states)[5]
+                                            ,const uint8_t * const * p_data
+                                            ,size_t p_nb_blocks
+                                            );
+
+        /**
+         * Kernel processing consecutive blocks of a message, selected once
+         */
+        static inline
+        block_function
+        get_block_function();
+
+        /**
+         * Kernel processing blocks of m_nb_lanes messages, selected once
+         * @return nullptr if multi buffer processing is not worth it
+         */
+        static inline
+        multi_block_function
+        get_multi_block_function();
+
+        static inline
+        uint32_t
+        rotate_left(uint32_t p_value
+                   ,unsigned int p_shift
+                   );
+
+        /**
+         * Compute word of round p_index if needed, p_words contains the 16
+         * previous words
+         */
+        static inline
+        uint32_t
+        schedule(uint32_t (& p_words)[16]
+                ,unsigned int p_index
+                );
+
+        /**
+         * Portable kernel
+         */
+        static inline
+        void
+        process_blocks(uint32_t * p_state
+                      ,const uint8_t * p_data
+                      ,size_t p_nb_blocks
+                      );
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+        /**
+         * @return true if CPU has SHA extensions and SSE4.1 used with them
+         */
+        static inline
+        bool
+        has_sha_extensions();
+
+        /**
+         * Process rounds 4 * t_group to 4 * t_group + 3 with SHA
+         * extensions and prepare words of next rounds
+         * @param p_e E values, p_e[t_group % 2] is the one of these rounds
+         * @param p_words words of rounds, p_words[t_group % 4] is the one
+         * of these rounds
+         */
+        template <unsigned int t_group>
+        __attribute__((target("sha,sse4.1")))
+        static inline
+        void
+        sha_rounds(__m128i & p_abcd
+                  ,__m128i (& p_e)[2]
+                  ,__m128i (& p_words)[4]
+                  );
+
+        __attribute__((target("sha,sse4.1")))
+        static inline
+        void
+        process_blocks_sha(uint32_t * p_state
+                          ,const uint8_t * p_data
+                          ,size_t p_nb_blocks
+                          );
+
+        template <int t_shift>
+        __attribute__((target("avx2")))
+        static inline
+        __m256i
+        rotate_left_avx2(__m256i p_value);
+
+        __attribute__((target("avx2")))
+        static inline
+        __m256i
+        schedule_avx2(__m256i (& p_words)[16]
+                     ,unsigned int p_index
+                     );
+
+        /**
+         * Load 8 words at p_offset of each message
+         */
+        __attribute__((target("avx2")))
+        static inline
+        void
+        load_words_avx2(const uint8_t * const * p_data
+                       ,size_t p_offset
+                       ,__m256i * p_words
+                       );
+
+        /**
+         * Kernel processing m_nb_lanes messages, p_states[i] and p_data[i]
+         * are those of message i
+         */
+        __attribute__((target("avx2")))
+        static inline
+        void
+        process_blocks_avx2(uint32_t (* p_states)[5]
+                           ,const uint8_t * const * p_data
+                           ,size_t p_nb_blocks
+                           );
+#endif // x86 with GCC or clang
+
+        uint32_t m_state[5];
+
+        uint64_t m_total_size;
+
+        uint8_t m_buffer[64];
+
+        size_t m_buffer_size;
+    };
+
+    //-------------------------------------------------------------------------
+    sha1::sha1()
+    :m_state{0x67452301, 0xEFCDAB89, 0x98BADCFE, 0x10325476, 0xC3D2E1F0}
+    ,m_total_size{0}
+    ,m_buffer{}
+    ,m_buffer_size{0}
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    sha1::update(const uint8_t * p_data
+                ,size_t p_size
+                )
+    {
+        m_total_size += p_size;
+        if(m_buffer_size)
+        {
+            size_t l_size = std::min(p_size, sizeof(m_buffer) - m_buffer_size);
+            memcpy(m_buffer + m_buffer_size, p_data, l_size);
+            m_buffer_size += l_size;
+            p_data += l_size;
+            p_size -= l_size;
+            if(sizeof(m_buffer) != m_buffer_size)
+            {
+                return;
+            }
+            get_block_function()(m_state, m_buffer, 1);
+            m_buffer_size = 0;
+        }
+        size_t l_nb_blocks = p_size / sizeof(m_buffer);
+        if(l_nb_blocks)
+        {
+            get_block_function()(m_state, p_data, l_nb_blocks);
+            p_data += l_nb_blocks * sizeof(m_buffer);
+            p_size -= l_nb_blocks * sizeof(m_buffer);
+        }
+        memcpy(m_buffer, p_data, p_size);
+        m_buffer_size = p_size;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    sha1::finalize(uint8_t * p_digest)
+    {
+        uint64_t l_bit_size = m_total_size * 8;
+        m_buffer[m_buffer_size++] = 0x80;
+        if(m_buffer_size > 56)
+        {
+            memset(m_buffer + m_buffer_size, 0, sizeof(m_buffer) - m_buffer_size);
+            get_block_function()(m_state, m_buffer, 1);
+            m_buffer_size = 0;
+        }
+        memset(m_buffer + m_buffer_size, 0, 56 - m_buffer_size);
+        for(unsigned int l_index = 0; l_index < 8; ++l_index)
+        {
+            m_buffer[63 - l_index] = (uint8_t)(l_bit_size >> (8 * l_index));
+        }
+        get_block_function()(m_state, m_buffer, 1);
+        for(unsigned int l_index = 0; l_index < 5; ++l_index)
+        {
+            p_digest[4 * l_index] = (uint8_t)(m_state[l_index] >> 24);
+            p_digest[4 * l_index + 1] = (uint8_t)(m_state[l_index] >> 16);
+            p_digest[4 * l_index + 2] = (uint8_t)(m_state[l_index] >> 8);
+            p_digest[4 * l_index + 3] = (uint8_t)m_state[l_index];
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    sha1::update(sha1 * const * p_hashes
+                ,const uint8_t * const * p_data
+                ,size_t p_nb
+                ,size_t p_size
+                )
+    {
+        if(!p_nb)
+        {
+            return;
+        }
+        // Data completing partial blocks and data of last partial block
+        // are buffered by each hash, only full blocks are processed together
+        size_t l_head_size = p_hashes[0]->m_buffer_size ? std::min(p_size, sizeof(m_buffer) - p_hashes[0]->m_buffer_size) : 0;
+        size_t l_nb_blocks = (p_size - l_head_size) / sizeof(m_buffer);
+        size_t l_tail_offset = l_head_size + l_nb_blocks * sizeof(m_buffer);
+        multi_block_function l_multi_block_function = get_multi_block_function();
+        for(size_t l_first = 0; l_first < p_nb; l_first += m_nb_lanes)
+        {
+            size_t l_nb = std::min((size_t)m_nb_lanes, p_nb - l_first);
+            for(size_t l_index = l_first; l_index < l_first + l_nb; ++l_index)
+            {
+                p_hashes[l_index]->update(p_data[l_index], l_head_size);
+            }
+            if(l_nb_blocks && l_multi_block_function && l_nb > 1)
+            {
+                // Missing lanes repeat first message and their result is dropped
+                uint32_t l_states[m_nb_lanes][5];
+                const uint8_t * l_data[m_nb_lanes];
+                for(size_t l_lane = 0; l_lane < m_nb_lanes; ++l_lane)
+                {
+                    size_t l_index = l_first + (l_lane < l_nb ? l_lane : 0);
+                    memcpy(l_states[l_lane], p_hashes[l_index]->m_state, sizeof(l_states[l_lane]));
+                    l_data[l_lane] = p_data[l_index] + l_head_size;
+                }
+                l_multi_block_function(l_states, l_data, l_nb_blocks);
+                for(size_t l_lane = 0; l_lane < l_nb; ++l_lane)
+                {
+                    memcpy(p_hashes[l_first + l_lane]->m_state, l_states[l_lane], sizeof(l_states[l_lane]));
+                    p_hashes[l_first + l_lane]->m_total_size += l_nb_blocks * sizeof(m_buffer);
+                }
+            }
+            else if(l_nb_blocks)
+            {
+                for(size_t l_index = l_first; l_index < l_first + l_nb; ++l_index)
+                {
+                    p_hashes[l_index]->update(p_data[l_index] + l_head_size, l_nb_blocks * sizeof(m_buffer));
+                }
+            }
+            for(size_t l_index = l_first; l_index < l_first + l_nb; ++l_index)
+            {
+                p_hashes[l_index]->update(p_data[l_index] + l_tail_offset, p_size - l_tail_offset);
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    sha1::use_multi_buffer()
+    {
+        return nullptr != get_multi_block_function();
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    sha1::to_string(const uint8_t * p_digest)
+    {
+        static const char l_hexa[] = "0123456789abcdef";
+        std::string l_result(2 * m_digest_size, '0');
+        for(unsigned int l_index = 0; l_index < m_digest_size; ++l_index)
+        {
+            l_result[2 * l_index] = l_hexa[p_digest[l_index] >> 4];
+            l_result[2 * l_index + 1] = l_hexa[p_digest[l_index] & 0xF];
+        }
+        return l_result;
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    sha1::from_string(const std::string & p_string
+                     ,uint8_t * p_digest
+                     )
+    {
+        return from_string(p_string.data(), p_string.size(), p_digest);
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    sha1::from_string(const char * p_data
+                     ,size_t p_size
+                     ,uint8_t * p_digest
+                     )
+    {
+        if(2 * m_digest_size != p_size)
+        {
+            return false;
+        }
+        for(unsigned int l_index = 0; l_index < 2 * m_digest_size; ++l_index)
+        {
+            char l_char = p_data[l_index];
+            uint8_t l_value;
+            if('0' <= l_char && l_char <= '9')
+            {
+                l_value = (uint8_t)(l_char - '0');
+            }
+            else if('a' <= l_char && l_char <= 'f')
+            {
+                l_value = (uint8_t)(l_char - 'a' + 10);
+            }
+            else if('A' <= l_char && l_char <= 'F')
+            {
+                l_value = (uint8_t)(l_char - 'A' + 10);
+            }
+            else
+            {
+                return false;
+            }
+            p_digest[l_index / 2] = l_index % 2 ? (uint8_t)(p_digest[l_index / 2] | l_value) : (uint8_t)(l_value << 4);
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    sha1::block_function
+    sha1::get_block_function()
+    {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+        static const block_function l_function = has_sha_extensions() ? &process_blocks_sha : &process_blocks;
+#else // x86 with GCC or clang
+        static const block_function l_function = &process_blocks;
+#endif // x86 with GCC or clang
+        return l_function;
+    }
+
+    //-------------------------------------------------------------------------
+    sha1::multi_block_function
+    sha1::get_multi_block_function()
+    {
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+        // SHA extensions hash one message faster than AVX2 hashes 8 of them
+        static const multi_block_function l_function = !has_sha_extensions() && __builtin_cpu_supports("avx2") ? &process_blocks_avx2 : nullptr;
+        return l_function;
+#else // x86 with GCC or clang
+        return nullptr;
+#endif // x86 with GCC or clang
+    }
+
+    //-------------------------------------------------------------------------
+    uint32_t
+    sha1::rotate_left(uint32_t p_value
+                     ,unsigned int p_shift
+                     )
+    {
+        return (p_value << p_shift) | (p_value >> (32 - p_shift));
+    }
+
+    //-------------------------------------------------------------------------
+    uint32_t
+    sha1::schedule(uint32_t (& p_words)[16]
+                  ,unsigned int p_index
+                  )
+    {
+        if(p_index >= 16)
+        {
+            p_words[p_index & 15] = rotate_left(p_words[(p_index + 13) & 15] ^ p_words[(p_index + 8) & 15] ^ p_words[(p_index + 2) & 15] ^ p_words[p_index & 15], 1);
+        }
+        return p_words[p_index & 15];
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    sha1::process_blocks(uint32_t * p_state
+                        ,const uint8_t * p_data
+                        ,size_t p_nb_blocks
+                        )
+    {
+        for(; p_nb_blocks; --p_nb_blocks, p_data += 64)
+        {
+            // Only the 16 previous words are needed to compute a word
+            uint32_t l_words[16];
+            for(unsigned int l_index = 0; l_index < 16; ++l_index)
+            {
+                l_words[l_index] = ((uint32_t)p_data[4 * l_index] << 24) |
+                                   ((uint32_t)p_data[4 * l_index + 1] << 16) |
+                                   ((uint32_t)p_data[4 * l_index + 2] << 8) |
+                                   ((uint32_t)p_data[4 * l_index + 3]);
+            }
+
+            uint32_t l_a = p_state[0];
+            uint32_t l_b = p_state[1];
+            uint32_t l_c = p_state[2];
+            uint32_t l_d = p_state[3];
+            uint32_t l_e = p_state[4];
+            uint32_t l_temp;
+            for(unsigned int l_index = 0; l_index < 20; ++l_index)
+            {
+                l_temp = rotate_left(l_a, 5) + (l_d ^ (l_b & (l_c ^ l_d))) + l_e + 0x5A827999 + schedule(l_words, l_index);
+                l_e = l_d;
+                l_d = l_c;
+                l_c = rotate_left(l_b, 30);
+                l_b = l_a;
+                l_a = l_temp;
+            }
+            for(unsigned int l_index = 20; l_index < 40; ++l_index)
+            {
+                l_temp = rotate_left(l_a, 5) + (l_b ^ l_c ^ l_d) + l_e + 0x6ED9EBA1 + schedule(l_words, l_index);
+                l_e = l_d;
+                l_d = l_c;
+                l_c = rotate_left(l_b, 30);
+                l_b = l_a;
+                l_a = l_temp;
+            }
+            for(unsigned int l_index = 40; l_index < 60; ++l_index)
+            {
+                l_temp = rotate_left(l_a, 5) + ((l_b & l_c) | (l_d & (l_b | l_c))) + l_e + 0x8F1BBCDC + schedule(l_words, l_index);
+                l_e = l_d;
+                l_d = l_c;
+                l_c = rotate_left(l_b, 30);
+                l_b = l_a;
+                l_a = l_temp;
+            }
+            for(unsigned int l_index = 60; l_index < 80; ++l_index)
+            {
+                l_temp = rotate_left(l_a, 5) + (l_b ^ l_c ^ l_d) + l_e + 0xCA62C1D6 + schedule(l_words, l_index);
+                l_e = l_d;
+                l_d = l_c;
+                l_c = rotate_left(l_b, 30);
+                l_b = l_a;
+                l_a = l_temp;
+            }
+            p_state[0] += l_a;
+            p_state[1] += l_b;
+            p_state[2] += l_c;
+            p_state[3] += l_d;
+            p_state[4] += l_e;
+        }
+    }
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+    //-------------------------------------------------------------------------
+    bool
+    sha1::has_sha_extensions()
+    {
+        unsigned int l_eax;
+        unsigned int l_ebx;
+        unsigned int l_ecx;
+        unsigned int l_edx;
+        if(!__get_cpuid(1, &l_eax, &l_ebx, &l_ecx, &l_edx) || !(l_ecx & bit_SSSE3) || !(l_ecx & bit_SSE4_1) || __get_cpuid_max(0, nullptr) < 7)
+        {
+            return false;
+        }
+        __cpuid_count(7, 0, l_eax, l_ebx, l_ecx, l_edx);
+        // SHA extensions are bit 29 of EBX
+        return l_ebx & (1u << 29);
+    }
+
+    //-------------------------------------------------------------------------
+    template <unsigned int t_group>
+    void
+    sha1::sha_rounds(__m128i & p_abcd
+                    ,__m128i (& p_e)[2]
+                    ,__m128i (& p_words)[4]
+                    )
+    {
+        const __m128i & l_words = p_words[t_group % 4];
+        __m128i & l_e = p_e[t_group % 2];
+        // E of these rounds is A of 4 rounds before rotated, except at first rounds
+        l_e = t_group ? _mm_sha1nexte_epu32(l_e, l_words) : _mm_add_epi32(l_e, l_words);
+        p_e[(t_group + 1) % 2] = p_abcd;
+        p_abcd = _mm_sha1rnds4_epu32(p_abcd, l_e, t_group / 5);
+        // Each group of 4 words needs 3 steps to compute next group using it
+        if(1 <= t_group && t_group <= 16)
+        {
+            p_words[(t_group + 3) % 4] = _mm_sha1msg1_epu32(p_words[(t_group + 3) % 4], l_words);
+        }
+        if(2 <= t_group && t_group <= 17)
+        {
+            p_words[(t_group + 2) % 4] = _mm_xor_si128(p_words[(t_group + 2) % 4], l_words);
+        }
+        if(3 <= t_group && t_group <= 18)
+        {
+            p_words[(t_group + 1) % 4] = _mm_sha1msg2_epu32(p_words[(t_group + 1) % 4], l_words);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    sha1::process_blocks_sha(uint32_t * p_state
+                            ,const uint8_t * p_data
+                            ,size_t p_nb_blocks
+                            )
+    {
+        // Words are big endian and A is expected in highest lane
+        const __m128i l_byte_order = _mm_set_epi64x(0x0001020304050607ULL, 0x08090a0b0c0d0e0fULL);
+        __m128i l_abcd = _mm_shuffle_epi32(_mm_loadu_si128((const __m128i *)p_state), 0x1B);
+        __m128i l_e = _mm_set_epi32((int)p_state[4], 0, 0, 0);
+        for(; p_nb_blocks; --p_nb_blocks, p_data += 64)
+        {
+            __m128i l_abcd_save = l_abcd;
+            __m128i l_rounds_e[2] = {l_e, _mm_setzero_si128()};
+            __m128i l_words[4];
+            for(unsigned int l_index = 0; l_index < 4; ++l_index)
+            {
+                l_words[l_index] = _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)(p_data + 16 * l_index)), l_byte_order);
+            }
+            sha_rounds<0>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<1>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<2>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<3>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<4>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<5>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<6>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<7>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<8>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<9>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<10>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<11>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<12>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<13>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<14>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<15>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<16>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<17>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<18>(l_abcd, l_rounds_e, l_words);
+            sha_rounds<19>(l_abcd, l_rounds_e, l_words);
+            l_e = _mm_sha1nexte_epu32(l_rounds_e[0], l_e);
+            l_abcd = _mm_add_epi32(l_abcd, l_abcd_save);
+        }
+        _mm_storeu_si128((__m128i *)p_state, _mm_shuffle_epi32(l_abcd, 0x1B));
+        p_state[4] = (uint32_t)_mm_extract_epi32(l_e, 3);
+    }
+
+    //-------------------------------------------------------------------------
+    template <int t_shift>
+    __m256i
+    sha1::rotate_left_avx2(__m256i p_value)
+    {
+        return _mm256_or_si256(_mm256_slli_epi32(p_value, t_shift), _mm256_srli_epi32(p_value, 32 - t_shift));
+    }
+
+    //-------------------------------------------------------------------------
+    __m256i
+    sha1::schedule_avx2(__m256i (& p_words)[16]
+                       ,unsigned int p_index
+                       )
+    {
+        if(p_index >= 16)
+        {
+            __m256i l_xor = _mm256_xor_si256(_mm256_xor_si256(p_words[(p_index + 13) & 15], p_words[(p_index + 8) & 15])
+                                            ,_mm256_xor_si256(p_words[(p_index + 2) & 15], p_words[p_index & 15])
+                                            );
+            p_words[p_index & 15] = rotate_left_avx2<1>(l_xor);
+        }
+        return p_words[p_index & 15];
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    sha1::load_words_avx2(const uint8_t * const * p_data
+                         ,size_t p_offset
+                         ,__m256i * p_words
+                         )
+    {
+        // Rows of 8 words of each message are transposed so that lane i of
+        // each word belongs to message i
+        const __m256i l_byte_order = _mm256_set_epi8(12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3
+                                                    ,12, 13, 14, 15, 8, 9, 10, 11, 4, 5, 6, 7, 0, 1, 2, 3
+                                                    );
+        __m256i l_rows[m_nb_lanes];
+        for(unsigned int l_lane = 0; l_lane < m_nb_lanes; ++l_lane)
+        {
+            l_rows[l_lane] = _mm256_shuffle_epi8(_mm256_loadu_si256((const __m256i *)(p_data[l_lane] + p_offset)), l_byte_order);
+        }
+        __m256i l_pairs[m_nb_lanes];
+        for(unsigned int l_lane = 0; l_lane < m_nb_lanes; l_lane += 2)
+        {
+            l_pairs[l_lane] = _mm256_unpacklo_epi32(l_rows[l_lane], l_rows[l_lane + 1]);
+            l_pairs[l_lane + 1] = _mm256_unpackhi_epi32(l_rows[l_lane], l_rows[l_lane + 1]);
+        }
+        __m256i l_quads[m_nb_lanes];
+        for(unsigned int l_lane = 0; l_lane < m_nb_lanes; l_lane += 4)
+        {
+            l_quads[l_lane] = _mm256_unpacklo_epi64(l_pairs[l_lane], l_pairs[l_lane + 2]);
+            l_quads[l_lane + 1] = _mm256_unpackhi_epi64(l_pairs[l_lane], l_pairs[l_lane + 2]);
+            l_quads[l_lane + 2] = _mm256_unpacklo_epi64(l_pairs[l_lane + 1], l_pairs[l_lane + 3]);
+            l_quads[l_lane + 3] = _mm256_unpackhi_epi64(l_pairs[l_lane + 1], l_pairs[l_lane + 3]);
+        }
+        for(unsigned int l_index = 0; l_index < 4; ++l_index)
+        {
+            p_words[l_index] = _mm256_permute2x128_si256(l_quads[l_index], l_quads[l_index + 4], 0x20);
+            p_words[l_index + 4] = _mm256_permute2x128_si256(l_quads[l_index], l_quads[l_index + 4], 0x31);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    sha1::process_blocks_avx2(uint32_t (* p_states)[5]
+                             ,const uint8_t * const * p_data
+                             ,size_t p_nb_blocks
+                             )
+    {
+        __m256i l_state[5];
+        for(unsigned int l_index = 0; l_index < 5; ++l_index)
+        {
+            l_state[l_index] = _mm256_set_epi32((int)p_states[7][l_index], (int)p_states[6][l_index], (int)p_states[5][l_index], (int)p_states[4][l_index]
+                                               ,(int)p_states[3][l_index], (int)p_states[2][l_index], (int)p_states[1][l_index], (int)p_states[0][l_index]
+                                               );
+        }
+        for(size_t l_block = 0; l_block < p_nb_blocks; ++l_block)
+        {
+            __m256i l_words[16];
+            load_words_avx2(p_data, 64 * l_block, l_words);
+            load_words_avx2(p_data, 64 * l_block + 32, l_words + 8);
+
+            __m256i l_a = l_state[0];
+            __m256i l_b = l_state[1];
+            __m256i l_c = l_state[2];
+            __m256i l_d = l_state[3];
+            __m256i l_e = l_state[4];
+            __m256i l_f;
+            __m256i l_k = _mm256_set1_epi32(0x5A827999);
+            for(unsigned int l_index = 0; l_index < 80; ++l_index)
+            {
+                if(l_index < 20)
+                {
+                    l_f = _mm256_xor_si256(l_d, _mm256_and_si256(l_b, _mm256_xor_si256(l_c, l_d)));
+                }
+                else if(l_index < 40 || l_index >= 60)
+                {
+                    l_f = _mm256_xor_si256(_mm256_xor_si256(l_b, l_c), l_d);
+                }
+                else
+                {
+                    l_f = _mm256_or_si256(_mm256_and_si256(l_b, l_c), _mm256_and_si256(l_d, _mm256_or_si256(l_b, l_c)));
+                }
+                if(20 == l_index)
+                {
+                    l_k = _mm256_set1_epi32(0x6ED9EBA1);
+                }
+                else if(40 == l_index)
+                {
+                    l_k = _mm256_set1_epi32((int)0x8F1BBCDC);
+                }
+                else if(60 == l_index)
+                {
+                    l_k = _mm256_set1_epi32((int)0xCA62C1D6);
+                }
+                __m256i l_temp = _mm256_add_epi32(_mm256_add_epi32(rotate_left_avx2<5>(l_a), l_f)
+                                                 ,_mm256_add_epi32(_mm256_add_epi32(l_e, l_k), schedule_avx2(l_words, l_index))
+                                                 );
+                l_e = l_d;
+                l_d = l_c;
+                l_c = rotate_left_avx2<30>(l_b);
+                l_b = l_a;
+                l_a = l_temp;
+            }
+            l_state[0] = _mm256_add_epi32(l_state[0], l_a);
+            l_state[1] = _mm256_add_epi32(l_state[1], l_b);
+            l_state[2] = _mm256_add_epi32(l_state[2], l_c);
+            l_state[3] = _mm256_add_epi32(l_state[3], l_d);
+            l_state[4] = _mm256_add_epi32(l_state[4], l_e);
+        }
+        for(unsigned int l_index = 0; l_index < 5; ++l_index)
+        {
+            uint32_t l_values[m_nb_lanes];
+            _mm256_storeu_si256((__m256i *)l_values, l_state[l_index]);
+            for(unsigned int l_lane = 0; l_lane < m_nb_lanes; ++l_lane)
+            {
+                p_states[l_lane][l_index] = l_values[l_lane];
+            }
+        }
+    }
+#endif // x86 with GCC or clang
+
+}
+#endif //DUPLICATION_CHECKER_SHA1_H
+// EOF
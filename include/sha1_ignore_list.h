@@ -0,0 +1,365 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_SHA1_IGNORE_LIST_H
+#define DUPLICATION_CHECKER_SHA1_IGNORE_LIST_H
+
+#include "sha1.h"
+#include "quicky_exception.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <string>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * SHA1 to ignore with their comment.
+     * Digests are stored in binary form in an open addressing hash table.
+     * A Bloom filter in front of the table answers most negative queries
+     * without accessing it.
+     * SHA1 text and comments are only needed to dump configuration so they
+     * are kept apart from the table
+     */
+    class sha1_ignore_list
+    {
+      public:
+
+        inline
+        sha1_ignore_list();
+
+        /**
+         * Add SHA1 if not already present, throw if p_sha1 is not a valid
+         * SHA1 representation
+         * @return true if SHA1 has been added
+         */
+        inline
+        bool
+        insert(const std::string & p_sha1
+              ,const std::string & p_comment
+              );
+
+        /**
+         * Add binary digest whose text representation is p_sha1 if not
+         * already present
+         * @return true if SHA1 has been added
+         */
+        inline
+        bool
+        insert(const uint8_t * p_digest
+              ,const std::string & p_sha1
+              ,const std::string & p_comment
+              );
+
+        /**
+         * Size table for p_nb SHA1 so that inserting them does not rehash
+         */
+        inline
+        void
+        reserve(size_t p_nb);
+
+        /**
+         * Search digest
+         * @return index of digest or m_not_found
+         */
+        inline
+        uint32_t
+        find(const uint8_t * p_digest) const;
+
+        inline
+        const std::string &
+        get_comment(uint32_t p_index) const;
+
+        inline
+        void
+        set_comment(uint32_t p_index
+                   ,const std::string & p_comment
+                   );
+
+        inline
+        size_t
+        size() const;
+
+        inline
+        bool
+        empty() const;
+
+        /**
+         * Apply function to SHA1 and comment in SHA1 text order
+         */
+        inline
+        void
+        apply(std::function<void(const std::string &, const std::string &)> & p_func) const;
+
+        static const uint32_t m_not_found = UINT32_MAX;
+
+      private:
+
+        /**
+         * Bucket of hash table, m_index is m_not_found if bucket is free
+         */
+        class bucket
+        {
+          public:
+
+            uint8_t m_digest[sha1::m_digest_size];
+            uint32_t m_index;
+        };
+
+        /**
+         * Rebuild hash table and Bloom filter for p_capacity buckets
+         */
+        inline
+        void
+        rehash(size_t p_capacity);
+
+        inline
+        void
+        insert_in_table(const uint8_t * p_digest
+                       ,uint32_t p_index
+                       );
+
+        /**
+         * Get a 32 bits word of digest, digest is uniform so no hash is needed
+         */
+        static inline
+        uint32_t
+        get_word(const uint8_t * p_digest
+                ,unsigned int p_word_index
+                );
+
+        std::vector<bucket> m_table;
+
+        /**
+         * Bloom filter with m_bloom_hashes bits per digest
+         */
+        std::vector<uint64_t> m_bloom;
+
+        static const unsigned int m_bloom_hashes = 3;
+
+        /**
+         * Digests in insertion order, index in this vector is stored in table
+         */
+        std::vector<uint8_t> m_digests;
+
+        /**
+         * Cold data: SHA1 text and comment of each digest
+         */
+        std::vector<std::pair<std::string, std::string>> m_texts;
+    };
+
+    //-------------------------------------------------------------------------
+    sha1_ignore_list::sha1_ignore_list()
+    {
+        rehash(16);
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    sha1_ignore_list::insert(const std::string & p_sha1
+                            ,const std::string & p_comment
+                            )
+    {
+        uint8_t l_digest[sha1::m_digest_size];
+        if(!sha1::from_string(p_sha1, l_digest))
+        {
+            throw quicky_exception::quicky_logic_exception(R"(Invalid SHA1 ")" + p_sha1 + R"(" in ignore list)"
+                                                          ,__LINE__
+                                                          ,__FILE__
+                                                          );
+        }
+        return insert(l_digest, p_sha1, p_comment);
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    sha1_ignore_list::insert(const uint8_t * p_digest
+                            ,const std::string & p_sha1
+                            ,const std::string & p_comment
+                            )
+    {
+        if(m_not_found != find(p_digest))
+        {
+            return false;
+        }
+        uint32_t l_index = (uint32_t)m_texts.size();
+        m_texts.emplace_back(p_sha1, p_comment);
+        m_digests.insert(m_digests.end(), p_digest, p_digest + sha1::m_digest_size);
+        // Keep load factor under 1/2
+        if(2 * m_texts.size() > m_table.size())
+        {
+            rehash(2 * m_table.size());
+        }
+        else
+        {
+            insert_in_table(p_digest, l_index);
+        }
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    sha1_ignore_list::reserve(size_t p_nb)
+    {
+        size_t l_capacity = m_table.size();
+        while(2 * p_nb > l_capacity)
+        {
+            l_capacity *= 2;
+        }
+        if(l_capacity != m_table.size())
+        {
+            rehash(l_capacity);
+        }
+        m_texts.reserve(p_nb);
+        m_digests.reserve(p_nb * sha1::m_digest_size);
+    }
+
+    //-------------------------------------------------------------------------
+    uint32_t
+    sha1_ignore_list::find(const uint8_t * p_digest) const
+    {
+        size_t l_nb_bits = 64 * m_bloom.size();
+        for(unsigned int l_hash = 0; l_hash < m_bloom_hashes; ++l_hash)
+        {
+            size_t l_bit = get_word(p_digest, l_hash + 1) & (l_nb_bits - 1);
+            if(!(m_bloom[l_bit / 64] & (((uint64_t)1) << (l_bit % 64))))
+            {
+                return m_not_found;
+            }
+        }
+        size_t l_mask = m_table.size() - 1;
+        for(size_t l_position = get_word(p_digest, 0) & l_mask; ; l_position = (l_position + 1) & l_mask)
+        {
+            const bucket & l_bucket = m_table[l_position];
+            if(m_not_found == l_bucket.m_index)
+            {
+                return m_not_found;
+            }
+            if(!memcmp(l_bucket.m_digest, p_digest, sha1::m_digest_size))
+            {
+                return l_bucket.m_index;
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    const std::string &
+    sha1_ignore_list::get_comment(uint32_t p_index) const
+    {
+        return m_texts[p_index].second;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    sha1_ignore_list::set_comment(uint32_t p_index
+                                 ,const std::string & p_comment
+                                 )
+    {
+        m_texts[p_index].second = p_comment;
+    }
+
+    //-------------------------------------------------------------------------
+    size_t
+    sha1_ignore_list::size() const
+    {
+        return m_texts.size();
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    sha1_ignore_list::empty() const
+    {
+        return m_texts.empty();
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    sha1_ignore_list::apply(std::function<void(const std::string &, const std::string &)> & p_func) const
+    {
+        std::vector<uint32_t> l_order(m_texts.size());
+        for(uint32_t l_index = 0; l_index < l_order.size(); ++l_index)
+        {
+            l_order[l_index] = l_index;
+        }
+        std::sort(l_order.begin()
+                 ,l_order.end()
+                 ,[&](uint32_t p_first, uint32_t p_second) -> bool
+                  {
+                      return m_texts[p_first].first < m_texts[p_second].first;
+                  }
+                 );
+        for(auto l_index: l_order)
+        {
+            p_func(m_texts[l_index].first, m_texts[l_index].second);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    sha1_ignore_list::rehash(size_t p_capacity)
+    {
+        bucket l_free_bucket;
+        memset(l_free_bucket.m_digest, 0, sizeof(l_free_bucket.m_digest));
+        l_free_bucket.m_index = m_not_found;
+        m_table.assign(p_capacity, l_free_bucket);
+        // 16 bits per digest give less than 1% false positive with 3 hashes
+        m_bloom.assign(std::max((size_t)16, p_capacity / 8), 0);
+        for(uint32_t l_index = 0; l_index < m_texts.size(); ++l_index)
+        {
+            insert_in_table(&m_digests[l_index * sha1::m_digest_size], l_index);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    sha1_ignore_list::insert_in_table(const uint8_t * p_digest
+                                     ,uint32_t p_index
+                                     )
+    {
+        size_t l_nb_bits = 64 * m_bloom.size();
+        for(unsigned int l_hash = 0; l_hash < m_bloom_hashes; ++l_hash)
+        {
+            size_t l_bit = get_word(p_digest, l_hash + 1) & (l_nb_bits - 1);
+            m_bloom[l_bit / 64] |= ((uint64_t)1) << (l_bit % 64);
+        }
+        size_t l_mask = m_table.size() - 1;
+        size_t l_position = get_word(p_digest, 0) & l_mask;
+        while(m_not_found != m_table[l_position].m_index)
+        {
+            l_position = (l_position + 1) & l_mask;
+        }
+        memcpy(m_table[l_position].m_digest, p_digest, sha1::m_digest_size);
+        m_table[l_position].m_index = p_index;
+    }
+
+    //-------------------------------------------------------------------------
+    uint32_t
+    sha1_ignore_list::get_word(const uint8_t * p_digest
+                              ,unsigned int p_word_index
+                              )
+    {
+        uint32_t l_word;
+        memcpy(&l_word, p_digest + 4 * p_word_index, sizeof(l_word));
+        return l_word;
+    }
+
+}
+#endif //DUPLICATION_CHECKER_SHA1_IGNORE_LIST_H
+// EOF
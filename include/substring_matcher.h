@@ -0,0 +1,194 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_SUBSTRING_MATCHER_H
+#define DUPLICATION_CHECKER_SUBSTRING_MATCHER_H
+
+#include "text_view.h"
+#include <cstdint>
+#include <queue>
+#include <set>
+#include <string>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Check in a single pass if a text contains at least one of several
+     * patterns. Patterns are compiled in an Aho-Corasick automaton whose
+     * failure links are resolved in a complete transition table.
+     * Bytes that do not appear in any pattern share the same column of the
+     * table to keep it small.
+     * As with std::string::find an empty pattern is found in any text
+     */
+    class substring_matcher
+    {
+      public:
+
+        inline explicit
+        substring_matcher(const std::set<std::string> & p_patterns);
+
+        /**
+         * @return true if p_text contains at least one pattern
+         */
+        inline
+        bool
+        match(const text_view & p_text) const;
+
+      private:
+
+        static const uint32_t m_root = 0;
+
+        /**
+         * Column of transition table used by each byte
+         */
+        uint16_t m_byte_classes[256];
+
+        unsigned int m_nb_classes;
+
+        /**
+         * Next state for each state and byte class
+         */
+        std::vector<uint32_t> m_transitions;
+
+        /**
+         * Indicate if a pattern ends in state or in one of its suffixes
+         */
+        std::vector<bool> m_accepting;
+
+        bool m_match_all;
+
+        bool m_match_none;
+    };
+
+    //-------------------------------------------------------------------------
+    substring_matcher::substring_matcher(const std::set<std::string> & p_patterns)
+    :m_nb_classes{1}
+    ,m_match_all{false}
+    ,m_match_none{p_patterns.empty()}
+    {
+        // Class 0 is used for bytes not present in patterns
+        for(auto & l_iter: m_byte_classes)
+        {
+            l_iter = 0;
+        }
+        for(const auto & l_iter: p_patterns)
+        {
+            if(l_iter.empty())
+            {
+                m_match_all = true;
+            }
+            for(auto l_char: l_iter)
+            {
+                uint16_t & l_class = m_byte_classes[(uint8_t)l_char];
+                if(!l_class)
+                {
+                    l_class = (uint16_t)m_nb_classes;
+                    ++m_nb_classes;
+                }
+            }
+        }
+        if(m_match_all || m_match_none)
+        {
+            return;
+        }
+
+        // Build trie, 0 means no transition as root cannot be a child
+        m_transitions.assign(m_nb_classes, 0);
+        m_accepting.assign(1, false);
+        for(const auto & l_iter: p_patterns)
+        {
+            uint32_t l_state = m_root;
+            for(auto l_char: l_iter)
+            {
+                size_t l_index = l_state * m_nb_classes + m_byte_classes[(uint8_t)l_char];
+                if(!m_transitions[l_index])
+                {
+                    uint32_t l_new_state = (uint32_t)m_accepting.size();
+                    m_transitions[l_index] = l_new_state;
+                    m_transitions.resize(m_transitions.size() + m_nb_classes, 0);
+                    m_accepting.push_back(false);
+                }
+                l_state = m_transitions[l_index];
+            }
+            m_accepting[l_state] = true;
+        }
+
+        // Breadth first traversal to replace missing transitions by the
+        // transition of the failure state
+        std::vector<uint32_t> l_failure(m_accepting.size(), 0);
+        std::queue<uint32_t> l_queue;
+        for(unsigned int l_class = 0; l_class < m_nb_classes; ++l_class)
+        {
+            uint32_t l_child = m_transitions[l_class];
+            if(l_child)
+            {
+                l_queue.push(l_child);
+            }
+        }
+        while(!l_queue.empty())
+        {
+            uint32_t l_state = l_queue.front();
+            l_queue.pop();
+            uint32_t l_fail = l_failure[l_state];
+            if(m_accepting[l_fail])
+            {
+                m_accepting[l_state] = true;
+            }
+            for(unsigned int l_class = 0; l_class < m_nb_classes; ++l_class)
+            {
+                size_t l_index = l_state * m_nb_classes + l_class;
+                uint32_t l_child = m_transitions[l_index];
+                uint32_t l_fail_next = m_transitions[l_fail * m_nb_classes + l_class];
+                if(l_child)
+                {
+                    l_failure[l_child] = l_fail_next;
+                    l_queue.push(l_child);
+                }
+                else
+                {
+                    m_transitions[l_index] = l_fail_next;
+                }
+            }
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    substring_matcher::match(const text_view & p_text) const
+    {
+        if(m_match_all || m_match_none)
+        {
+            return m_match_all;
+        }
+        uint32_t l_state = m_root;
+        const char * l_data = p_text.data();
+        for(size_t l_index = 0; l_index < p_text.size(); ++l_index)
+        {
+            l_state = m_transitions[l_state * m_nb_classes + m_byte_classes[(uint8_t)l_data[l_index]]];
+            if(m_accepting[l_state])
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+}
+#endif //DUPLICATION_CHECKER_SUBSTRING_MATCHER_H
+// EOF
@@ -0,0 +1,247 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_TEXT_VIEW_H
+#define DUPLICATION_CHECKER_TEXT_VIEW_H
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <string>
+
+namespace duplication_checker
+{
+    /**
+     * Non owning view on characters, typically located in a mapped file.
+     * Only what is needed to parse logs without allocation is provided
+     */
+    class text_view
+    {
+      public:
+
+        inline
+        text_view();
+
+        inline
+        text_view(const char * p_data
+                 ,size_t p_size
+                 );
+
+        inline explicit
+        text_view(const std::string & p_string);
+
+        inline
+        const char * data() const;
+
+        inline
+        size_t size() const;
+
+        inline
+        bool empty() const;
+
+        /**
+         * Same semantic as std::string::find
+         */
+        inline
+        size_t find(char p_char) const;
+
+        /**
+         * Same semantic as std::string::find
+         */
+        inline
+        size_t find(const std::string & p_string) const;
+
+        /**
+         * Same semantic as std::string::rfind
+         */
+        inline
+        size_t rfind(char p_char) const;
+
+        /**
+         * Same semantic as std::string::substr except that position is
+         * clamped instead of throwing
+         */
+        inline
+        text_view substr(size_t p_pos
+                        ,size_t p_size = std::string::npos
+                        ) const;
+
+        inline
+        std::string to_string() const;
+
+        inline
+        bool operator==(const text_view & p_view) const;
+
+        inline
+        bool operator!=(const text_view & p_view) const;
+
+        /**
+         * Compare characters as unsigned like std::string does
+         */
+        inline
+        bool operator<(const text_view & p_view) const;
+
+      private:
+
+        const char * m_data;
+        size_t m_size;
+    };
+
+    /**
+     * Hash functor to use text_view as key of unordered containers
+     */
+    class text_view_hasher
+    {
+      public:
+
+        inline
+        size_t operator()(const text_view & p_view) const;
+    };
+
+    //-------------------------------------------------------------------------
+    text_view::text_view()
+    :m_data{nullptr}
+    ,m_size{0}
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    text_view::text_view(const char * p_data
+                        ,size_t p_size
+                        )
+    :m_data{p_data}
+    ,m_size{p_size}
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    text_view::text_view(const std::string & p_string)
+    :m_data{p_string.data()}
+    ,m_size{p_string.size()}
+    {
+    }
+
+    //-------------------------------------------------------------------------
+    const char *
+    text_view::data() const
+    {
+        return m_data;
+    }
+
+    //-------------------------------------------------------------------------
+    size_t
+    text_view::size() const
+    {
+        return m_size;
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    text_view::empty() const
+    {
+        return !m_size;
+    }
+
+    //-------------------------------------------------------------------------
+    size_t
+    text_view::find(char p_char) const
+    {
+        const void * l_pos = m_size ? memchr(m_data, p_char, m_size) : nullptr;
+        return l_pos ? (size_t)(static_cast<const char *>(l_pos) - m_data) : std::string::npos;
+    }
+
+    //-------------------------------------------------------------------------
+    size_t
+    text_view::find(const std::string & p_string) const
+    {
+        const char * l_end = m_data + m_size;
+        const char * l_pos = std::search(m_data, l_end, p_string.begin(), p_string.end());
+        return l_pos == l_end && !p_string.empty() ? std::string::npos : (size_t)(l_pos - m_data);
+    }
+
+    //-------------------------------------------------------------------------
+    size_t
+    text_view::rfind(char p_char) const
+    {
+        for(size_t l_index = m_size; l_index; --l_index)
+        {
+            if(p_char == m_data[l_index - 1])
+            {
+                return l_index - 1;
+            }
+        }
+        return std::string::npos;
+    }
+
+    //-------------------------------------------------------------------------
+    text_view
+    text_view::substr(size_t p_pos
+                     ,size_t p_size
+                     ) const
+    {
+        p_pos = std::min(p_pos, m_size);
+        return text_view(m_data + p_pos, std::min(p_size, m_size - p_pos));
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    text_view::to_string() const
+    {
+        return std::string(m_data, m_size);
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    text_view::operator==(const text_view & p_view) const
+    {
+        return m_size == p_view.m_size && (!m_size || !memcmp(m_data, p_view.m_data, m_size));
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    text_view::operator!=(const text_view & p_view) const
+    {
+        return !(*this == p_view);
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    text_view::operator<(const text_view & p_view) const
+    {
+        size_t l_size = std::min(m_size, p_view.m_size);
+        int l_result = l_size ? memcmp(m_data, p_view.m_data, l_size) : 0;
+        return l_result ? l_result < 0 : m_size < p_view.m_size;
+    }
+
+    //-------------------------------------------------------------------------
+    size_t
+    text_view_hasher::operator()(const text_view & p_view) const
+    {
+        // FNV-1a
+        uint64_t l_hash = 0xcbf29ce484222325ULL;
+        for(size_t l_index = 0; l_index < p_view.size(); ++l_index)
+        {
+            l_hash ^= (uint8_t)p_view.data()[l_index];
+            l_hash *= 0x100000001b3ULL;
+        }
+        return (size_t)l_hash;
+    }
+
+}
+#endif //DUPLICATION_CHECKER_TEXT_VIEW_H
+// EOF
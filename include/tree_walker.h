@@ -0,0 +1,128 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_TREE_WALKER_H
+#define DUPLICATION_CHECKER_TREE_WALKER_H
+
+#include "file_info.h"
+#include "quicky_exception.h"
+#include <dirent.h>
+#include <sys/stat.h>
+#include <string>
+#include <vector>
+#include <iostream>
+
+namespace duplication_checker
+{
+    /**
+     * List regular files located under a root directory like
+     * "find * -type f" would do: symbolic links are not followed and
+     * returned names are relative to root directory
+     */
+    class tree_walker
+    {
+      public:
+
+        static inline
+        void
+        walk(const std::string & p_root
+            ,std::vector<file_info> & p_files
+            );
+
+      private:
+
+        static inline
+        void
+        walk_directory(const std::string & p_root
+                      ,const std::string & p_relative_dir
+                      ,std::vector<file_info> & p_files
+                      );
+    };
+
+    //-------------------------------------------------------------------------
+    void
+    tree_walker::walk(const std::string & p_root
+                     ,std::vector<file_info> & p_files
+                     )
+    {
+        struct stat l_stat;
+        if(stat(p_root.c_str(), &l_stat) || !S_ISDIR(l_stat.st_mode))
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(")" + p_root + R"(" is not a directory)"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        walk_directory(p_root, "", p_files);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    tree_walker::walk_directory(const std::string & p_root
+                               ,const std::string & p_relative_dir
+                               ,std::vector<file_info> & p_files
+                               )
+    {
+        std::string l_dir_name = p_relative_dir.empty() ? p_root : p_root + "/" + p_relative_dir;
+        DIR * l_dir = opendir(l_dir_name.c_str());
+        if(nullptr == l_dir)
+        {
+            std::cerr << R"(WARNING : unable to open directory ")" << l_dir_name << R"(")" << std::endl;
+            return;
+        }
+        std::vector<std::string> l_sub_dirs;
+        while(struct dirent * l_entry = readdir(l_dir))
+        {
+            std::string l_name = l_entry->d_name;
+            if("." == l_name || ".." == l_name)
+            {
+                continue;
+            }
+            std::string l_relative_name = p_relative_dir.empty() ? l_name : p_relative_dir + "/" + l_name;
+            struct stat l_stat;
+            if(lstat((p_root + "/" + l_relative_name).c_str(), &l_stat))
+            {
+                std::cerr << R"(WARNING : unable to stat ")" << l_relative_name << R"(")" << std::endl;
+                continue;
+            }
+            if(S_ISDIR(l_stat.st_mode))
+            {
+                l_sub_dirs.emplace_back(l_relative_name);
+            }
+            else if(S_ISREG(l_stat.st_mode))
+            {
+                // Log format is line based so such names cannot be represented
+                if(std::string::npos != l_relative_name.find('\n'))
+                {
+                    std::cerr << R"(WARNING : ignore file with new line in its name ")" << l_relative_name << R"(")" << std::endl;
+                    continue;
+                }
+                p_files.emplace_back(l_relative_name, l_stat);
+            }
+        }
+        closedir(l_dir);
+        // Directory is closed before recursion to avoid exhausting file descriptors
+        for(const auto & l_iter: l_sub_dirs)
+        {
+            walk_directory(p_root, l_iter, p_files);
+        }
+    }
+
+}
+#endif //DUPLICATION_CHECKER_TREE_WALKER_H
+// EOF
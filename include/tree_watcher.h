@@ -0,0 +1,654 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_TREE_WATCHER_H
+#define DUPLICATION_CHECKER_TREE_WATCHER_H
+
+#ifdef __linux__
+#include "hash_engine.h"
+#include "quicky_exception.h"
+#include <dirent.h>
+#include <poll.h>
+#include <pthread.h>
+#include <signal.h>
+#include <sys/inotify.h>
+#include <sys/signalfd.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdlib>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Keep an index of regular files located under a root directory up to
+     * date with inotify and report groups of duplicated files as soon as they
+     * appear.
+     * Index stores size and modification time of files. Digest of a file is
+     * only computed once another file has same size, and computed again only
+     * when file is modified. Changes are processed once no event has been
+     * received for a short delay so that a file being written is hashed once.
+     * Duplicated files already present when watch starts are not reported,
+     * batch mode is meant for them.
+     * Reported names are relative to root directory and removals are
+     * applied to these names so current directory has to be root directory.
+     * Watch runs until SIGINT or SIGTERM is received. These signals are
+     * blocked by constructor so watcher has to be created before any thread
+     * for them to be received by watcher
+     */
+    class tree_watcher
+    {
+      public:
+
+        /**
+         * Function receiving digest and sorted names of a group of duplicated
+         * files. Names are relative to root directory which is also current
+         * directory
+         */
+        typedef std::function<void(const std::string &, const std::vector<std::string> &)> t_listener;
+
+        /**
+         * @throw runtime exception if p_root is not current directory
+         */
+        inline explicit
+        tree_watcher(const std::string & p_root
+                    ,digest_type p_digest_type = digest_type::SHA1
+                    );
+
+        inline
+        ~tree_watcher();
+
+        tree_watcher(const tree_watcher &) = delete;
+        tree_watcher & operator=(const tree_watcher &) = delete;
+
+        /**
+         * Index files then report duplicated files resulting of changes to
+         * p_listener until interrupted
+         */
+        inline
+        void
+        run(const t_listener & p_listener);
+
+      private:
+
+        struct t_entry
+        {
+            uint64_t m_size;
+            int64_t m_mtime_ns;
+            /**
+             * Empty until computed
+             */
+            std::string m_digest;
+        };
+
+        /**
+         * Watch directory and its sub-directories and index their files.
+         * Once initial index is built, these files are considered as changed
+         */
+        inline
+        void
+        add_directory(const std::string & p_relative_dir);
+
+        /**
+         * Stop watching directory and its sub-directories and remove their
+         * files from index
+         */
+        inline
+        void
+        remove_directory(const std::string & p_relative_dir);
+
+        /**
+         * Insert or update file in index
+         * @return false if file was already indexed with same size and
+         * modification time
+         */
+        inline
+        bool
+        update_file(const std::string & p_name
+                   ,const struct stat & p_stat
+                   );
+
+        inline
+        void
+        remove_file(const std::string & p_name);
+
+        /**
+         * Compute digest of indexed file if not already known
+         */
+        inline
+        void
+        hash_file(const std::string & p_name
+                 ,t_entry & p_entry
+                 );
+
+        inline
+        void
+        read_events();
+
+        /**
+         * Update index with changed files and report groups they belong to
+         */
+        inline
+        void
+        process_changes();
+
+        inline
+        std::string
+        get_full_name(const std::string & p_name) const;
+
+        static inline
+        std::string
+        join(const std::string & p_relative_dir
+            ,const std::string & p_name
+            );
+
+        std::string m_root;
+
+        t_listener m_listener;
+
+        int m_inotify_fd;
+
+        /**
+         * Receive SIGINT and SIGTERM which are blocked while watching
+         */
+        int m_signal_fd;
+
+        sigset_t m_previous_mask;
+
+        /**
+         * Directory relative to root of each inotify watch
+         */
+        std::unordered_map<int, std::string> m_watches;
+
+        std::unordered_map<std::string, t_entry> m_files;
+
+        /**
+         * Names of indexed files by size
+         */
+        std::unordered_map<uint64_t, std::unordered_set<std::string>> m_sizes;
+
+        /**
+         * Names of hashed files by digest
+         */
+        std::unordered_map<std::string, std::set<std::string>> m_digests;
+
+        /**
+         * Files created or modified since changes were processed
+         */
+        std::set<std::string> m_changed;
+
+        std::chrono::steady_clock::time_point m_first_change;
+
+        /**
+         * Files found while building initial index are not changed files
+         */
+        bool m_indexing;
+
+        std::vector<uint8_t> m_buffer;
+
+        digest_type m_digest_type;
+
+        /**
+         * Delay without events in ms before changes are processed
+         */
+        static const int m_quiet_delay = 500;
+
+        /**
+         * Maximum delay in ms before changes are processed when events keep
+         * coming
+         */
+        static const int m_max_delay = 5000;
+
+        static const uint32_t m_event_mask = IN_CREATE | IN_CLOSE_WRITE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE;
+    };
+
+    //-------------------------------------------------------------------------
+    tree_watcher::tree_watcher(const std::string & p_root
+                              ,digest_type p_digest_type
+                              )
+    :m_root{p_root}
+    ,m_inotify_fd{-1}
+    ,m_signal_fd{-1}
+    ,m_indexing{false}
+    ,m_buffer(1024 * 1024)
+    ,m_digest_type{p_digest_type}
+    {
+        // Names are reported relative to root so they only designate the
+        // right files if root is current directory
+        char * l_root_path = realpath(p_root.c_str(), nullptr);
+        char * l_current_path = realpath(".", nullptr);
+        bool l_same = l_root_path && l_current_path && !strcmp(l_root_path, l_current_path);
+        free(l_root_path);
+        free(l_current_path);
+        if(!l_same)
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Watched directory ")" + p_root + R"(" is not current directory, run watch mode from it)"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        m_inotify_fd = inotify_init1(IN_CLOEXEC);
+        if(-1 == m_inotify_fd)
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Unable to initialise inotify : )" + std::string(strerror(errno))
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        // Signals are blocked so that they can be read with other events,
+        // threads created afterwards inherit this mask
+        sigset_t l_mask;
+        sigemptyset(&l_mask);
+        sigaddset(&l_mask, SIGINT);
+        sigaddset(&l_mask, SIGTERM);
+        pthread_sigmask(SIG_BLOCK, &l_mask, &m_previous_mask);
+        m_signal_fd = signalfd(-1, &l_mask, SFD_CLOEXEC);
+        if(-1 == m_signal_fd)
+        {
+            close(m_inotify_fd);
+            pthread_sigmask(SIG_SETMASK, &m_previous_mask, nullptr);
+            throw quicky_exception::quicky_runtime_exception(R"(Unable to create signal file descriptor : )" + std::string(strerror(errno))
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    tree_watcher::~tree_watcher()
+    {
+        close(m_signal_fd);
+        close(m_inotify_fd);
+        pthread_sigmask(SIG_SETMASK, &m_previous_mask, nullptr);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    tree_watcher::run(const t_listener & p_listener)
+    {
+        m_listener = p_listener;
+        struct stat l_stat;
+        if(stat(m_root.c_str(), &l_stat) || !S_ISDIR(l_stat.st_mode))
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(")" + m_root + R"(" is not a directory)"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        m_indexing = true;
+        add_directory("");
+        m_indexing = false;
+        std::cout << std::to_string(m_files.size()) + " files indexed, watching " + std::to_string(m_watches.size()) + " directories" << std::endl;
+
+        while(true)
+        {
+            int l_timeout = -1;
+            if(!m_changed.empty())
+            {
+                int l_elapsed = (int)std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - m_first_change).count();
+                l_timeout = std::max(0, std::min((int)m_quiet_delay, m_max_delay - l_elapsed));
+            }
+            struct pollfd l_fds[2] = {{m_inotify_fd, POLLIN, 0}, {m_signal_fd, POLLIN, 0}};
+            int l_result = poll(l_fds, 2, l_timeout);
+            if(-1 == l_result)
+            {
+                if(EINTR == errno)
+                {
+                    continue;
+                }
+                throw quicky_exception::quicky_runtime_exception(R"(Error waiting for events : )" + std::string(strerror(errno))
+                                                                ,__LINE__
+                                                                ,__FILE__
+                                                                );
+            }
+            if(l_fds[1].revents & POLLIN)
+            {
+                // Signal is consumed so that it is not delivered once unblocked
+                struct signalfd_siginfo l_info;
+                if(read(m_signal_fd, &l_info, sizeof(l_info)) > 0)
+                {
+                    std::cout << "Signal " + std::to_string(l_info.ssi_signo) + " received" << std::endl;
+                }
+                break;
+            }
+            if(l_fds[0].revents & POLLIN)
+            {
+                read_events();
+            }
+            if(!m_changed.empty() && (!l_result || std::chrono::steady_clock::now() - m_first_change >= std::chrono::milliseconds((int)m_max_delay)))
+            {
+                process_changes();
+            }
+        }
+        process_changes();
+        std::cout << "Watch stopped, " + std::to_string(m_files.size()) + " files indexed" << std::endl;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    tree_watcher::add_directory(const std::string & p_relative_dir)
+    {
+        std::string l_dir_name = get_full_name(p_relative_dir);
+        int l_watch = inotify_add_watch(m_inotify_fd, l_dir_name.c_str(), m_event_mask | IN_ONLYDIR);
+        if(-1 == l_watch)
+        {
+            std::cerr << R"(WARNING : unable to watch directory ")" << l_dir_name << R"(" : )" << strerror(errno) << std::endl;
+            return;
+        }
+        m_watches[l_watch] = p_relative_dir;
+        // Watch is added before listing so that no file created meanwhile
+        // is missed
+        DIR * l_dir = opendir(l_dir_name.c_str());
+        if(nullptr == l_dir)
+        {
+            std::cerr << R"(WARNING : unable to open directory ")" << l_dir_name << R"(")" << std::endl;
+            return;
+        }
+        std::vector<std::string> l_sub_dirs;
+        while(struct dirent * l_entry = readdir(l_dir))
+        {
+            std::string l_name = l_entry->d_name;
+            if("." == l_name || ".." == l_name)
+            {
+                continue;
+            }
+            std::string l_relative_name = join(p_relative_dir, l_name);
+            struct stat l_stat;
+            if(lstat(get_full_name(l_relative_name).c_str(), &l_stat))
+            {
+                continue;
+            }
+            if(S_ISDIR(l_stat.st_mode))
+            {
+                l_sub_dirs.emplace_back(l_relative_name);
+            }
+            // Log format is line based so such names cannot be represented
+            else if(S_ISREG(l_stat.st_mode) && std::string::npos == l_relative_name.find('\n'))
+            {
+                if(m_indexing)
+                {
+                    update_file(l_relative_name, l_stat);
+                }
+                else
+                {
+                    if(m_changed.empty())
+                    {
+                        m_first_change = std::chrono::steady_clock::now();
+                    }
+                    m_changed.insert(l_relative_name);
+                }
+            }
+        }
+        closedir(l_dir);
+        for(const auto & l_iter: l_sub_dirs)
+        {
+            add_directory(l_iter);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    tree_watcher::remove_directory(const std::string & p_relative_dir)
+    {
+        std::string l_prefix = p_relative_dir + "/";
+        for(auto l_iter = m_watches.begin(); l_iter != m_watches.end();)
+        {
+            if(l_iter->second == p_relative_dir || !l_iter->second.compare(0, l_prefix.size(), l_prefix))
+            {
+                inotify_rm_watch(m_inotify_fd, l_iter->first);
+                l_iter = m_watches.erase(l_iter);
+            }
+            else
+            {
+                ++l_iter;
+            }
+        }
+        std::vector<std::string> l_names;
+        for(const auto & l_iter: m_files)
+        {
+            if(!l_iter.first.compare(0, l_prefix.size(), l_prefix))
+            {
+                l_names.emplace_back(l_iter.first);
+            }
+        }
+        for(const auto & l_iter: l_names)
+        {
+            remove_file(l_iter);
+        }
+        for(auto l_iter = m_changed.lower_bound(l_prefix); l_iter != m_changed.end() && !l_iter->compare(0, l_prefix.size(), l_prefix);)
+        {
+            l_iter = m_changed.erase(l_iter);
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    bool
+    tree_watcher::update_file(const std::string & p_name
+                             ,const struct stat & p_stat
+                             )
+    {
+        int64_t l_mtime_ns = (int64_t)p_stat.st_mtim.tv_sec * 1000000000 + p_stat.st_mtim.tv_nsec;
+        auto l_iter = m_files.find(p_name);
+        if(m_files.end() != l_iter)
+        {
+            if(l_iter->second.m_size == (uint64_t)p_stat.st_size && l_iter->second.m_mtime_ns == l_mtime_ns)
+            {
+                return false;
+            }
+            remove_file(p_name);
+        }
+        m_files.emplace(p_name, t_entry{(uint64_t)p_stat.st_size, l_mtime_ns, ""});
+        m_sizes[(uint64_t)p_stat.st_size].insert(p_name);
+        return true;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    tree_watcher::remove_file(const std::string & p_name)
+    {
+        auto l_iter = m_files.find(p_name);
+        if(m_files.end() == l_iter)
+        {
+            return;
+        }
+        auto l_size_iter = m_sizes.find(l_iter->second.m_size);
+        l_size_iter->second.erase(p_name);
+        if(l_size_iter->second.empty())
+        {
+            m_sizes.erase(l_size_iter);
+        }
+        if(!l_iter->second.m_digest.empty())
+        {
+            auto l_digest_iter = m_digests.find(l_iter->second.m_digest);
+            l_digest_iter->second.erase(p_name);
+            if(l_digest_iter->second.empty())
+            {
+                m_digests.erase(l_digest_iter);
+            }
+        }
+        m_files.erase(l_iter);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    tree_watcher::hash_file(const std::string & p_name
+                           ,t_entry & p_entry
+                           )
+    {
+        if(!p_entry.m_digest.empty())
+        {
+            return;
+        }
+        if(!hash_engine::compute_digest(get_full_name(p_name), m_digest_type, m_buffer, p_entry.m_digest))
+        {
+            std::cerr << R"(WARNING : unable to read ")" + p_name + R"(")" << std::endl;
+            p_entry.m_digest.clear();
+            return;
+        }
+        m_digests[p_entry.m_digest].insert(p_name);
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    tree_watcher::read_events()
+    {
+        alignas(struct inotify_event) char l_buffer[64 * 1024];
+        ssize_t l_size = read(m_inotify_fd, l_buffer, sizeof(l_buffer));
+        if(l_size <= 0)
+        {
+            return;
+        }
+        bool l_overflow = false;
+        for(char * l_pointer = l_buffer; l_pointer < l_buffer + l_size;)
+        {
+            const struct inotify_event * l_event = reinterpret_cast<const struct inotify_event *>(l_pointer);
+            l_pointer += sizeof(struct inotify_event) + l_event->len;
+            if(l_event->mask & IN_Q_OVERFLOW)
+            {
+                l_overflow = true;
+                continue;
+            }
+            if(l_event->mask & IN_IGNORED)
+            {
+                m_watches.erase(l_event->wd);
+                continue;
+            }
+            auto l_iter = m_watches.find(l_event->wd);
+            if(m_watches.end() == l_iter || !l_event->len)
+            {
+                continue;
+            }
+            std::string l_name = join(l_iter->second, l_event->name);
+            if(std::string::npos != l_name.find('\n'))
+            {
+                continue;
+            }
+            if(l_event->mask & IN_ISDIR)
+            {
+                if(l_event->mask & (IN_CREATE | IN_MOVED_TO))
+                {
+                    add_directory(l_name);
+                }
+                else if(l_event->mask & (IN_DELETE | IN_MOVED_FROM))
+                {
+                    remove_directory(l_name);
+                }
+            }
+            else if(l_event->mask & (IN_DELETE | IN_MOVED_FROM))
+            {
+                remove_file(l_name);
+                m_changed.erase(l_name);
+            }
+            else
+            {
+                if(m_changed.empty())
+                {
+                    m_first_change = std::chrono::steady_clock::now();
+                }
+                m_changed.insert(l_name);
+            }
+        }
+        // Some events are lost so all files are checked again, only the ones
+        // whose size or modification time changed are hashed
+        if(l_overflow)
+        {
+            std::cerr << "WARNING : inotify events lost, checking all files" << std::endl;
+            for(const auto & l_iter: m_files)
+            {
+                m_changed.insert(l_iter.first);
+            }
+            add_directory("");
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    tree_watcher::process_changes()
+    {
+        std::vector<std::string> l_updated;
+        for(const auto & l_iter: m_changed)
+        {
+            struct stat l_stat;
+            if(lstat(get_full_name(l_iter).c_str(), &l_stat) || !S_ISREG(l_stat.st_mode))
+            {
+                remove_file(l_iter);
+            }
+            else if(update_file(l_iter, l_stat))
+            {
+                l_updated.emplace_back(l_iter);
+            }
+        }
+        m_changed.clear();
+
+        // Groups are reported in digest order like in sorted log
+        std::set<std::string> l_groups;
+        for(const auto & l_iter: l_updated)
+        {
+            auto l_file_iter = m_files.find(l_iter);
+            const std::unordered_set<std::string> & l_same_size = m_sizes[l_file_iter->second.m_size];
+            if(l_same_size.size() < 2)
+            {
+                continue;
+            }
+            for(const auto & l_other: l_same_size)
+            {
+                hash_file(l_other, m_files[l_other]);
+            }
+            const std::string & l_digest = l_file_iter->second.m_digest;
+            if(!l_digest.empty() && m_digests[l_digest].size() >= 2)
+            {
+                l_groups.insert(l_digest);
+            }
+        }
+        for(const auto & l_iter: l_groups)
+        {
+            const std::set<std::string> & l_names = m_digests[l_iter];
+            m_listener(l_iter, std::vector<std::string>(l_names.begin(), l_names.end()));
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    tree_watcher::get_full_name(const std::string & p_name) const
+    {
+        return p_name.empty() ? m_root : m_root + "/" + p_name;
+    }
+
+    //-------------------------------------------------------------------------
+    std::string
+    tree_watcher::join(const std::string & p_relative_dir
+                      ,const std::string & p_name
+                      )
+    {
+        return p_relative_dir.empty() ? p_name : p_relative_dir + "/" + p_name;
+    }
+
+}
+#endif // __linux__
+#endif //DUPLICATION_CHECKER_TREE_WATCHER_H
+// EOF
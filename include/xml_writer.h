@@ -0,0 +1,228 @@
+/*
+      This file is part of duplication_checker
+      Copyright (C) 2026  Julien Thevenon ( julien_thevenon at yahoo.fr )
+
+      This program is free software: you can redistribute it and/or modify
+      it under the terms of the GNU General Public License as published by
+      the Free Software Foundation, either version 3 of the License, or
+      (at your option) any later version.
+
+      This program is distributed in the hope that it will be useful,
+      but WITHOUT ANY WARRANTY; without even the implied warranty of
+      MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+      GNU General Public License for more details.
+
+      You should have received a copy of the GNU General Public License
+      along with this program.  If not, see <http://www.gnu.org/licenses/>
+*/
+
+#ifndef DUPLICATION_CHECKER_XML_WRITER_H
+#define DUPLICATION_CHECKER_XML_WRITER_H
+
+#include "quicky_exception.h"
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace duplication_checker
+{
+    /**
+     * Write XML file element by element without building a tree.
+     * Output has the same format as XMLNode::writeToFile: UTF-8 BOM and
+     * declaration, one element per line indented by tabs, elements without
+     * children are self closing
+     */
+    class xml_writer
+    {
+      public:
+
+        inline explicit
+        xml_writer(const std::string & p_file_name);
+
+        /**
+         * Start a child of current element, attributes can be added until
+         * next element is opened or closed
+         */
+        inline
+        void
+        open(const std::string & p_name);
+
+        inline
+        void
+        add_attribute(const std::string & p_name
+                     ,const std::string & p_value
+                     );
+
+        /**
+         * Close current element
+         */
+        inline
+        void
+        close();
+
+        /**
+         * Close remaining elements and write file, throw in case of error
+         */
+        inline
+        void
+        finish();
+
+      private:
+
+        /**
+         * Terminate start tag of current element if it is still open
+         */
+        inline
+        void
+        end_start_tag(bool p_has_children);
+
+        inline
+        void
+        flush();
+
+        std::string m_file_name;
+
+        std::ofstream m_file;
+
+        std::string m_buffer;
+
+        /**
+         * Names of elements being written from root
+         */
+        std::vector<std::string> m_elements;
+
+        /**
+         * Indicate that attributes of current element are being written
+         */
+        bool m_start_tag_open;
+
+        static const size_t m_buffer_size = 1024 * 1024;
+    };
+
+    //-------------------------------------------------------------------------
+    xml_writer::xml_writer(const std::string & p_file_name)
+    :m_file_name(p_file_name)
+    ,m_file(p_file_name, std::ios::binary | std::ios::trunc)
+    ,m_start_tag_open{false}
+    {
+        if(!m_file.is_open())
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error opening output file ")" + p_file_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+        m_buffer.reserve(m_buffer_size);
+        m_buffer = "\xef\xbb\xbf<?xml version=\"1.0\" encoding=\"utf-8\"?>\n";
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    xml_writer::open(const std::string & p_name)
+    {
+        end_start_tag(true);
+        if(m_buffer.size() >= m_buffer_size)
+        {
+            flush();
+        }
+        m_buffer.append(m_elements.size(), '\t');
+        m_buffer += '<';
+        m_buffer += p_name;
+        m_elements.emplace_back(p_name);
+        m_start_tag_open = true;
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    xml_writer::add_attribute(const std::string & p_name
+                             ,const std::string & p_value
+                             )
+    {
+        m_buffer += ' ';
+        m_buffer += p_name;
+        m_buffer += "=\"";
+        for(auto l_char: p_value)
+        {
+            switch(l_char)
+            {
+                case '&':
+                    m_buffer += "&amp;";
+                    break;
+                case '<':
+                    m_buffer += "&lt;";
+                    break;
+                case '>':
+                    m_buffer += "&gt;";
+                    break;
+                case '"':
+                    m_buffer += "&quot;";
+                    break;
+                case '\'':
+                    m_buffer += "&apos;";
+                    break;
+                default:
+                    m_buffer += l_char;
+            }
+        }
+        m_buffer += '"';
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    xml_writer::close()
+    {
+        if(m_start_tag_open)
+        {
+            end_start_tag(false);
+        }
+        else
+        {
+            m_buffer.append(m_elements.size() - 1, '\t');
+            m_buffer += "</";
+            m_buffer += m_elements.back();
+            m_buffer += ">\n";
+        }
+        m_elements.pop_back();
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    xml_writer::finish()
+    {
+        while(!m_elements.empty())
+        {
+            close();
+        }
+        flush();
+        m_file.close();
+        if(m_file.fail())
+        {
+            throw quicky_exception::quicky_runtime_exception(R"(Error writing ")" + m_file_name + R"(")"
+                                                            ,__LINE__
+                                                            ,__FILE__
+                                                            );
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    xml_writer::end_start_tag(bool p_has_children)
+    {
+        if(m_start_tag_open)
+        {
+            m_buffer += p_has_children ? ">\n" : "/>\n";
+            m_start_tag_open = false;
+        }
+    }
+
+    //-------------------------------------------------------------------------
+    void
+    xml_writer::flush()
+    {
+        m_file.write(m_buffer.data(), (std::streamsize)m_buffer.size());
+        m_buffer.clear();
+    }
+
+}
+#endif //DUPLICATION_CHECKER_XML_WRITER_H
+// EOF
@@ -0,0 +1,34 @@
+# Helpers shared by script tests. Each test is run by ctest with the
+# executable as first argument and works in its own temporary directory
+#
+EXE=$(realpath "$1")
+TEST_NAME=$(basename "$0" .bash)
+WORK_DIR=$(mktemp -d)
+trap 'rm -rf "$WORK_DIR"' EXIT
+cd "$WORK_DIR"
+
+# Print error and exit with failure
+fail()
+{
+    echo "[$TEST_NAME] FAILED : $*"
+    exit 1
+}
+
+# Check that file $1 is identical to file $2
+check_same()
+{
+    cmp -s "$1" "$2" || { diff "$1" "$2" | head -20; fail "$1 differs from $2"; }
+}
+
+# Check that file $1 contains string $2
+check_contains()
+{
+    grep -qF -- "$2" "$1" || { cat "$1"; fail "$1 does not contain \"$2\""; }
+}
+
+# Write a config.xml without rule in current directory
+write_empty_config()
+{
+    printf '<?xml version="1.0" encoding="UTF-8"?>\n<duplication_checker>\n</duplication_checker>\n' > config.xml
+}
+#EOF
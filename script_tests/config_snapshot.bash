@@ -0,0 +1,81 @@
+#!/bin/bash
+# --config_snapshot gives same results whether configuration is parsed or
+# loaded from snapshot, a snapshot older than config.xml is regenerated
+source "$(dirname "$0")/common.sh"
+
+# Run with snapshot, output is saved in $1_stdout.txt and outputs in $1/
+run()
+{
+    "$EXE" --config_snapshot=config.snap "${@:2}" > "$1"_stdout.txt 2>&1 || { cat "$1"_stdout.txt; fail "run $1 failed"; }
+    mkdir "$1"
+    cp duplicata.log clean_cmd.bash updated_config.xml "$1"
+}
+
+# Check that outputs of runs $1 and $2 are identical
+check_same_outputs()
+{
+    for l_file in duplicata.log clean_cmd.bash updated_config.xml
+    do
+        check_same "$1/$l_file" "$2/$l_file"
+    done
+}
+
+cat > sorted_sha1sum.log << EOL
+307d8bfc0cad9bde5ed3e65c3235a5c43ef396ac  dir1/triple1.txt
+307d8bfc0cad9bde5ed3e65c3235a5c43ef396ac  dir2/triple2.txt
+307d8bfc0cad9bde5ed3e65c3235a5c43ef396ac  triple.txt
+bd1259b7714e0402f3ca67b566a28ee31d57e698  dir1/sha1_to_ignore.txt
+bd1259b7714e0402f3ca67b566a28ee31d57e698  dir2/sha1_to_ignore.txt
+e6e8ea7465f12e4d3b5a067a4c4dc698436b3478  dir1/toto.txt
+e6e8ea7465f12e4d3b5a067a4c4dc698436b3478  dir2/toto.txt
+EOL
+cat > config.xml << EOL
+<?xml version="1.0" encoding="UTF-8"?>
+<duplication_checker>
+<sha1_ignore_list>
+<ignore sha1="bd1259b7714e0402f3ca67b566a28ee31d57e698" />
+</sha1_ignore_list>
+<rules>
+<keep_only>
+<keep_list>
+<keep path="dir2" />
+</keep_list>
+<remove_list>
+<remove path="" />
+<remove path="dir1" />
+</remove_list>
+</keep_only>
+</rules>
+</duplication_checker>
+EOL
+touch -d "2020-01-01" config.xml
+
+# Snapshot is created by first run then loaded
+run first
+check_contains first_stdout.txt 'Config snapshot "config.snap" written'
+run second
+check_contains second_stdout.txt 'Config snapshot "config.snap" loaded'
+grep -qF 'Config snapshot "config.snap" written' second_stdout.txt && fail "snapshot written again"
+check_same_outputs first second
+
+# Same size but newer modification time
+touch config.xml
+run touched
+check_contains touched_stdout.txt "modified since snapshot"
+check_contains touched_stdout.txt 'Config snapshot "config.snap" written'
+check_same_outputs first touched
+
+# Modified content is taken into account
+sed -i 's|<rules>|<rules>\n<rule cmd="RM_FIRST" file1="dir1" file2="dir2" />|' config.xml
+touch -d "2020-01-01" config.xml
+"$EXE" > reference_stdout.txt 2>&1 || fail "run without snapshot failed"
+mkdir reference
+cp duplicata.log clean_cmd.bash updated_config.xml reference
+run modified
+check_contains modified_stdout.txt "modified since snapshot"
+check_same_outputs reference modified
+run reloaded
+check_contains reloaded_stdout.txt 'Config snapshot "config.snap" loaded'
+check_same_outputs reference reloaded
+exit 0
+#EOF
@@ -0,0 +1,35 @@
+#!/bin/bash
+# Unsorted log bigger than memory budget is sorted with temporary files and
+# gives same output as sorted log, as when it is sorted in memory. Temporary files are created in TMPDIR
+# and removed
+source "$(dirname "$0")/common.sh"
+
+# About 3 MB of log with groups of 1 to 3 files of same SHA1
+awk 'BEGIN { srand(1); for(i = 0; i < 30000; ++i) { d = ""; for(j = 0; j < 5; ++j) { d = d sprintf("%08x", int(rand() * 4294967295)) } n = 1 + i % 3; for(k = 0; k < n; ++k) { printf "%s  dir%d/file_%d_%d.txt\n", d, int(rand() * 20), i, k } } }' | sort -R --random-source=<(yes) > unsorted.log
+
+mkdir sorted unsorted tmp
+write_empty_config
+cp config.xml sorted/
+cp config.xml unsorted/
+LC_ALL=C sort unsorted.log > sorted/sorted_sha1sum.log
+mv unsorted.log unsorted/sha1sum.log
+
+(cd sorted && "$EXE" > stdout.txt 2>&1) || { cat sorted/stdout.txt; fail "sorted run failed"; }
+(cd unsorted && TMPDIR="$WORK_DIR/tmp" "$EXE" --unsorted=1 --max_memory=1 --nb_threads=3 > stdout.txt 2>&1) || { cat unsorted/stdout.txt; fail "unsorted run failed"; }
+check_contains unsorted/stdout.txt "Log does not fit in memory, use external sort"
+for l_file in duplicata.log clean_cmd.bash updated_config.xml
+do
+    check_same sorted/$l_file unsorted/$l_file
+done
+# Same output when log is sorted in memory
+mkdir in_memory
+cp config.xml unsorted/sha1sum.log in_memory/
+(cd in_memory && TMPDIR="$WORK_DIR/tmp" "$EXE" --unsorted=1 > stdout.txt 2>&1) || { cat in_memory/stdout.txt; fail "in memory run failed"; }
+for l_file in duplicata.log clean_cmd.bash updated_config.xml
+do
+    check_same sorted/$l_file in_memory/$l_file
+done
+[ -z "$(ls -A tmp)" ] || fail "temporary files left in TMPDIR : $(ls -A tmp)"
+ls unsorted | grep -q "\.tmp$" && fail "temporary files created in current directory"
+exit 0
+#EOF
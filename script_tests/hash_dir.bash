@@ -0,0 +1,58 @@
+#!/bin/bash
+# --hash_dir log must list same digests as sha1sum for every file which
+# can be duplicated, sorted like "sort" does
+source "$(dirname "$0")/common.sh"
+
+mkdir -p data/dir1 data/dir2
+printf "" > data/dir1/empty
+printf "" > data/dir2/empty
+printf "abc" > data/dir1/small
+printf "abc" > data/dir2/small
+head -c 5000 /dev/urandom > data/dir1/medium
+cp data/dir1/medium data/dir2/medium
+head -c 300000 /dev/urandom > data/dir1/big
+cp data/dir1/big data/dir2/big
+cp data/dir1/big data/big
+# Same size, first and last blocks as big but different middle
+cp data/dir1/big data/dir2/big_modified
+printf "X" | dd of=data/dir2/big_modified bs=1 seek=150000 conv=notrunc 2> /dev/null
+# Same size as big but different first block, cannot be duplicated
+cp data/dir1/big data/dir2/big_other
+printf "X" | dd of=data/dir2/big_other bs=1 seek=10 conv=notrunc 2> /dev/null
+# Unique size, never hashed
+head -c 1234 /dev/urandom > data/unique
+
+(cd data && sha1sum dir1/empty dir2/empty dir1/small dir2/small dir1/medium dir2/medium dir1/big dir2/big big dir2/big_modified) | LC_ALL=C sort > expected.log
+write_empty_config
+
+"$EXE" --hash_dir=data --nb_threads=3 > stdout.txt 2>&1 || { cat stdout.txt; fail "hash_dir run failed"; }
+check_contains stdout.txt "12 files found, 11 with same size as another file"
+check_same expected.log sorted_sha1sum.log
+
+# Partial digest is not used for sizes having cached files, so once cache
+# exists big_other is fully hashed and stays in log
+(cd data && sha1sum dir2/big_other; cat ../expected.log) | LC_ALL=C sort > expected_cached.log
+"$EXE" --hash_dir=data --nb_threads=1 --hash_cache=hash.cache > stdout.txt 2>&1 || { cat stdout.txt; fail "run creating cache failed"; }
+check_same expected.log sorted_sha1sum.log
+"$EXE" --hash_dir=data --nb_threads=1 --hash_cache=hash.cache > stdout.txt 2>&1 || { cat stdout.txt; fail "run completing cache failed"; }
+check_contains stdout.txt "10 files found in cache, 1 files to hash"
+check_same expected_cached.log sorted_sha1sum.log
+"$EXE" --hash_dir=data --nb_threads=1 --hash_cache=hash.cache > stdout.txt 2>&1 || { cat stdout.txt; fail "run using cache failed"; }
+check_contains stdout.txt "11 files found in cache, 0 files to hash"
+check_same expected_cached.log sorted_sha1sum.log
+
+# Names are relative to data so removals are refused from another directory
+mkdir dir1 dir2
+printf "abc" > dir1/small
+printf "abc" > dir2/small
+"$EXE" --hash_dir=data --dry_run=1 > stdout.txt 2>&1
+check_contains stdout.txt 'Hashed directory "data" is not current directory'
+[ ! -e removal_journal.log ] || fail "removals journaled for another directory"
+"$EXE" --hash_dir=data --execute=1 > stdout.txt 2>&1
+check_contains stdout.txt 'Hashed directory "data" is not current directory'
+[ -e dir1/small -a -e dir2/small ] || fail "files removed in another directory"
+cp config.xml data
+(cd data && "$EXE" --hash_dir=. --dry_run=1 > ../stdout.txt 2>&1) || { cat stdout.txt; fail "dry run from hashed directory failed"; }
+check_contains stdout.txt "0 files would be removed"
+exit 0
+#EOF
@@ -0,0 +1,44 @@
+#!/bin/bash
+# LINK_FIRST with --execute=1 replaces files by hard links and running it
+# again on processed tree leaves files untouched without temporary file
+source "$(dirname "$0")/common.sh"
+
+mkdir dir1 dir2
+printf "abc" > dir1/a
+printf "abc" > dir2/a
+printf "def" > dir1/b
+# Already linked before first run
+ln dir1/b dir2/b
+
+cat > sorted_sha1sum.log << EOL
+a9993e364706816aba3e25717850c26c9cd0d89d  dir1/a
+a9993e364706816aba3e25717850c26c9cd0d89d  dir2/a
+1111111111111111111111111111111111111111  dir1/b
+1111111111111111111111111111111111111111  dir2/b
+EOL
+cat > config.xml << EOL
+<?xml version="1.0" encoding="UTF-8"?>
+<duplication_checker>
+<rules>
+<rule cmd="LINK_FIRST" file1="dir1" file2="dir2" />
+</rules>
+</duplication_checker>
+EOL
+
+"$EXE" --execute=1 > stdout.txt 2>&1 || { cat stdout.txt; fail "first run failed"; }
+check_contains stdout.txt "1 files linked, 1 already linked, 0 failures"
+check_contains removal_journal.log "linked dir1/a to dir2/a"
+check_contains removal_journal.log "already linked dir1/b to dir2/b"
+[ dir1/a -ef dir2/a ] || fail "dir1/a not linked to dir2/a"
+
+"$EXE" --execute=1 > stdout.txt 2>&1 || { cat stdout.txt; fail "second run failed"; }
+check_contains stdout.txt "0 files linked, 2 already linked, 0 failures"
+check_contains removal_journal.log "already linked dir1/a to dir2/a"
+[ dir1/a -ef dir2/a -a dir1/b -ef dir2/b ] || fail "links broken by second run"
+[ -z "$(ls dir1/*.dc_tmp dir2/*.dc_tmp 2> /dev/null)" ] || fail "temporary files left"
+
+# Generated script does same thing
+bash clean_cmd.bash > /dev/null 2>&1
+[ -z "$(ls dir1/*.dc_tmp dir2/*.dc_tmp 2> /dev/null)" ] || fail "temporary files left by clean_cmd.bash"
+exit 0
+#EOF
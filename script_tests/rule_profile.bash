@@ -0,0 +1,60 @@
+#!/bin/bash
+# --prune_rules only counts runs which processed all groups as runs without
+# hit and keeps remaining rules in declaration order
+source "$(dirname "$0")/common.sh"
+
+# Run with profile of previous run, extra arguments are given to executable
+run()
+{
+    "$EXE" --prune_rules=2 "$@" > stdout.txt 2>&1 || { cat stdout.txt; fail "run failed"; }
+    mv updated_rule_profile.log rule_profile.log
+}
+
+# Check rules of updated config, given as "file1:file2" in expected order
+check_rules()
+{
+    sed -n 's|.*file1="\([^"]*\)" file2="\([^"]*\)".*|\1:\2|p' updated_config.xml > rules.txt
+    printf "%s\n" "$@" > expected_rules.txt
+    check_same rules.txt expected_rules.txt
+}
+
+cat > sorted_sha1sum.log << EOL
+1111111111111111111111111111111111111111  dir1/x
+1111111111111111111111111111111111111111  dir2/x
+2222222222222222222222222222222222222222  dir3/y
+2222222222222222222222222222222222222222  dir4/y
+3333333333333333333333333333333333333333  dir5/z
+3333333333333333333333333333333333333333  dir6/z
+EOL
+cat > config.xml << EOL
+<?xml version="1.0" encoding="UTF-8"?>
+<duplication_checker>
+<rules>
+<rule cmd="RM_FIRST" file1="dir7" file2="dir8" />
+<rule cmd="RM_FIRST" file1="dir5" file2="dir6" />
+<rule cmd="RM_FIRST" file1="dir1" file2="dir2" />
+</rules>
+</duplication_checker>
+EOL
+
+# User quits on group without rule so dir5 rule is not reached
+for l_index in 1 2
+do
+    echo q | run --interactive=1
+    check_contains stdout.txt "run incomplete so rules without hit are not counted as unused"
+    check_contains stdout.txt "0 rules and 0 keep only unused for 2 runs pruned"
+    check_rules dir7:dir8 dir5:dir6 dir1:dir2
+done
+printf "2\t0\trule\tRM_FIRST\tdir1\tdir2\n" > expected_record.txt
+grep -F "dir1" rule_profile.log > record.txt
+check_same record.txt expected_record.txt
+
+# Complete runs count dir7 rule as unused, pruned after second one while
+# other rules keep their order whatever their hits
+run
+check_contains stdout.txt "0 rules and 0 keep only unused for 2 runs pruned"
+run
+check_contains stdout.txt "1 rules and 0 keep only unused for 2 runs pruned"
+check_rules dir5:dir6 dir1:dir2
+exit 0
+#EOF
@@ -0,0 +1,60 @@
+#!/bin/bash
+# --verify=1 compares real files before removal: identical files and
+# hard links are removed, files whose content or size differ or which were
+# modified after log are kept
+source "$(dirname "$0")/common.sh"
+
+mkdir dir1 dir2
+# Several chunks of comparison
+head -c 3000000 /dev/urandom > dir2/same.txt
+cp dir2/same.txt dir1/same.txt
+cp dir2/same.txt dir2/diff.txt
+cp dir2/same.txt dir1/diff.txt
+printf "X" | dd of=dir1/diff.txt bs=1 seek=2999999 conv=notrunc 2> /dev/null
+printf "abc" > dir2/size.txt
+printf "abcd" > dir1/size.txt
+printf "link" > dir2/link.txt
+ln dir2/link.txt dir1/link.txt
+printf "new" > dir2/new.txt
+printf "new" > dir1/new.txt
+
+cat > sorted_sha1sum.log << EOL
+1111111111111111111111111111111111111111  dir1/same.txt
+1111111111111111111111111111111111111111  dir2/same.txt
+2222222222222222222222222222222222222222  dir1/diff.txt
+2222222222222222222222222222222222222222  dir2/diff.txt
+3333333333333333333333333333333333333333  dir1/size.txt
+3333333333333333333333333333333333333333  dir2/size.txt
+4444444444444444444444444444444444444444  dir1/link.txt
+4444444444444444444444444444444444444444  dir2/link.txt
+5555555555555555555555555555555555555555  dir1/new.txt
+5555555555555555555555555555555555555555  dir2/new.txt
+EOL
+cat > config.xml << EOL
+<?xml version="1.0" encoding="UTF-8"?>
+<duplication_checker>
+<rules>
+<rule cmd="RM_FIRST" file1="dir1" file2="dir2" />
+</rules>
+</duplication_checker>
+EOL
+touch -d "2020-01-01" dir1/* dir2/*
+touch -d "2021-01-01" sorted_sha1sum.log
+touch -d "2022-01-01" dir1/new.txt
+
+"$EXE" --verify=1 > stdout.txt 2>&1 || { cat stdout.txt; fail "verification run failed"; }
+check_contains stdout.txt "Verification : 5 files verified, 3 rejected"
+check_contains clean_cmd.bash "rm dir1/same.txt"
+check_contains clean_cmd.bash "rm dir1/link.txt"
+check_contains clean_cmd.bash '# Verification failed, "dir1/diff.txt" is kept : contents differ'
+check_contains clean_cmd.bash '# Verification failed, "dir1/size.txt" is kept : sizes differ'
+check_contains clean_cmd.bash '# Verification failed, "dir1/new.txt" is kept : modified after log'
+
+# Same decisions when removals are executed
+"$EXE" --verify=1 --execute=1 > stdout.txt 2>&1 || { cat stdout.txt; fail "execution run failed"; }
+check_contains stdout.txt "Verification : 5 files verified, 3 rejected"
+[ ! -e dir1/same.txt -a ! -e dir1/link.txt ] || fail "verified files not removed"
+[ -e dir1/diff.txt -a -e dir1/size.txt -a -e dir1/new.txt ] || fail "rejected files removed"
+[ -e dir2/same.txt -a -e dir2/link.txt ] || fail "kept files removed"
+exit 0
+#EOF
@@ -0,0 +1,60 @@
+#!/bin/bash
+# --watch_dir reports files duplicated while watching and stops cleanly on
+# SIGTERM, it refuses to start when watched directory is not current one
+source "$(dirname "$0")/common.sh"
+
+# Wait up to 10s for file $1 to contain string $2
+wait_for()
+{
+    for l_index in $(seq 100)
+    do
+        grep -qF -- "$2" "$1" 2> /dev/null && return 0
+        sleep 0.1
+    done
+    cat "$1"
+    fail "timeout waiting for \"$2\" in $1"
+}
+
+mkdir dir1 dir2 dir3 other
+cat > config.xml << EOL
+<?xml version="1.0" encoding="UTF-8"?>
+<duplication_checker>
+<rules>
+<rule cmd="RM_FIRST" file1="dir1" file2="dir2" />
+</rules>
+</duplication_checker>
+EOL
+# Present before watch so not reported
+printf "old" > dir1/old.txt
+printf "old" > dir2/old.txt
+
+"$EXE" --watch_dir=. > ../"$TEST_NAME"_stdout.txt 2>&1 &
+l_pid=$!
+l_stdout=../"$TEST_NAME"_stdout.txt
+trap 'kill $l_pid 2> /dev/null; rm -f "$l_stdout"; rm -rf "$WORK_DIR"' EXIT
+wait_for "$l_stdout" "files indexed, watching"
+
+printf "new" > dir2/new.txt
+printf "new" > dir1/new.txt
+printf "unique" > dir1/unique.txt
+# Group not handled by any rule
+printf "norule" > dir3/a.txt
+printf "norule" > dir3/b.txt
+wait_for clean_cmd.bash "rm dir1/new.txt"
+wait_for duplicata.log "dir3/b.txt"
+
+kill -TERM $l_pid
+wait $l_pid || fail "watch exited with status $?"
+check_contains "$l_stdout" "Signal 15 received"
+check_contains "$l_stdout" "Watch stopped"
+grep -q "old.txt" duplicata.log clean_cmd.bash && fail "files present before watch reported"
+grep -q "unique.txt" duplicata.log clean_cmd.bash && fail "unique file reported"
+check_contains duplicata.log "dir3/a.txt"
+
+# Names are relative to watched directory so it has to be current directory
+cd other
+write_empty_config
+"$EXE" --watch_dir=.. --input_dir=. > stdout.txt 2>&1
+check_contains stdout.txt "is not current directory"
+exit 0
+#EOF
@@ -18,6 +18,12 @@
 
 #include "parameter_manager.h"
 #include "duplication_checker.h"
+#include "hash_engine.h"
+#include "tree_watcher.h"
+#include <cstdlib>
+#include <cstring>
+#include <memory>
+#include <thread>
 
 int main(int argc,char ** argv)
 {
@@ -29,15 +35,171 @@ int main(int argc,char ** argv)
         l_param_manager.add(l_input_dir_param);
         parameter_manager::parameter_if l_interactive_param("interactive", true);
         l_param_manager.add(l_interactive_param);
+        parameter_manager::parameter_if l_hash_dir_param("hash_dir", true);
+        l_param_manager.add(l_hash_dir_param);
+        parameter_manager::parameter_if l_nb_threads_param("nb_threads", true);
+        l_param_manager.add(l_nb_threads_param);
+        parameter_manager::parameter_if l_hash_cache_param("hash_cache", true);
+        l_param_manager.add(l_hash_cache_param);
+        parameter_manager::parameter_if l_digest_param("digest", true);
+        l_param_manager.add(l_digest_param);
+        parameter_manager::parameter_if l_unsorted_param("unsorted", true);
+        l_param_manager.add(l_unsorted_param);
+        parameter_manager::parameter_if l_max_memory_param("max_memory", true);
+        l_param_manager.add(l_max_memory_param);
+        parameter_manager::parameter_if l_execute_param("execute", true);
+        l_param_manager.add(l_execute_param);
+        parameter_manager::parameter_if l_dry_run_param("dry_run", true);
+        l_param_manager.add(l_dry_run_param);
+        parameter_manager::parameter_if l_journal_param("journal", true);
+        l_param_manager.add(l_journal_param);
+        parameter_manager::parameter_if l_link_type_param("link_type", true);
+        l_param_manager.add(l_link_type_param);
+        parameter_manager::parameter_if l_verify_param("verify", true);
+        l_param_manager.add(l_verify_param);
+        parameter_manager::parameter_if l_watch_dir_param("watch_dir", true);
+        l_param_manager.add(l_watch_dir_param);
+        parameter_manager::parameter_if l_index_param("index", true);
+        l_param_manager.add(l_index_param);
+        parameter_manager::parameter_if l_make_index_param("make_index", true);
+        l_param_manager.add(l_make_index_param);
+        parameter_manager::parameter_if l_dump_index_param("dump_index", true);
+        l_param_manager.add(l_dump_index_param);
+        parameter_manager::parameter_if l_config_snapshot_param("config_snapshot", true);
+        l_param_manager.add(l_config_snapshot_param);
+        parameter_manager::parameter_if l_stats_param("stats", true);
+        l_param_manager.add(l_stats_param);
+        parameter_manager::parameter_if l_stats_period_param("stats_period", true);
+        l_param_manager.add(l_stats_period_param);
+        parameter_manager::parameter_if l_rule_profile_param("rule_profile", true);
+        l_param_manager.add(l_rule_profile_param);
+        parameter_manager::parameter_if l_prune_rules_param("prune_rules", true);
+        l_param_manager.add(l_prune_rules_param);
 
         // Treating parameters
         l_param_manager.treat_parameters(argc,argv);
 
         std::string l_input_dir = l_input_dir_param.value_set() ? l_input_dir_param.get_value<std::string>() : ".";
         bool l_interactive = l_interactive_param.value_set() ? l_interactive_param.get_value<bool>() : false;
+        unsigned int l_nb_threads = l_nb_threads_param.value_set() ? l_nb_threads_param.get_value<unsigned int>() : std::thread::hardware_concurrency();
+        bool l_unsorted = l_unsorted_param.value_set() ? l_unsorted_param.get_value<bool>() : false;
+        size_t l_max_memory = (l_max_memory_param.value_set() ? l_max_memory_param.get_value<size_t>() : 1024) * 1024 * 1024;
+        bool l_execute = l_execute_param.value_set() ? l_execute_param.get_value<bool>() : false;
+        bool l_dry_run = l_dry_run_param.value_set() ? l_dry_run_param.get_value<bool>() : false;
+        std::string l_journal = l_journal_param.value_set() ? l_journal_param.get_value<std::string>() : "removal_journal.log";
+        bool l_verify = l_verify_param.value_set() ? l_verify_param.get_value<bool>() : false;
+        duplication_checker::digest_type l_digest_type = duplication_checker::to_digest_type(l_digest_param.value_set() ? l_digest_param.get_value<std::string>() : "sha1");
+        duplication_checker::link_type l_link_type = duplication_checker::to_link_type(l_link_type_param.value_set() ? l_link_type_param.get_value<std::string>() : "hard");
+        unsigned int l_stats_period = l_stats_period_param.value_set() ? l_stats_period_param.get_value<unsigned int>() : 0;
+        bool l_stats = (l_stats_param.value_set() && l_stats_param.get_value<bool>()) || l_stats_period;
+        unsigned int l_prune_rules = l_prune_rules_param.value_set() ? l_prune_rules_param.get_value<unsigned int>() : 0;
+        bool l_rule_profile = (l_rule_profile_param.value_set() && l_rule_profile_param.get_value<bool>()) || l_prune_rules;
 
-        duplication_checker::duplication_checker l_checker(l_input_dir, l_interactive);
-        l_checker.run();
+        // Report duplicated files as soon as they appear instead of reading
+        // log. Watcher blocks signals it handles so it is created before any
+        // thread
+#ifdef __linux__
+        std::unique_ptr<duplication_checker::tree_watcher> l_watcher;
+        if(l_watch_dir_param.value_set())
+        {
+            l_watcher.reset(new duplication_checker::tree_watcher(l_watch_dir_param.get_value<std::string>(), l_digest_type));
+        }
+#else // __linux__
+        if(l_watch_dir_param.value_set())
+        {
+            throw quicky_exception::quicky_logic_exception("Watch mode is only available on Linux"
+                                                          ,__LINE__
+                                                          ,__FILE__
+                                                          );
+        }
+#endif // __linux__
+
+        // Compute SHA1 of files in process instead of relying on cmd_all_files
+        if(l_hash_dir_param.value_set())
+        {
+            // Names of log are relative to hashed directory and removals are
+            // applied to them from current directory
+            if(l_execute || l_dry_run)
+            {
+                char * l_hash_path = realpath(l_hash_dir_param.get_value<std::string>().c_str(), nullptr);
+                char * l_current_path = realpath(".", nullptr);
+                bool l_same = l_hash_path && l_current_path && !strcmp(l_hash_path, l_current_path);
+                free(l_hash_path);
+                free(l_current_path);
+                if(!l_same)
+                {
+                    throw quicky_exception::quicky_runtime_exception(R"(Hashed directory ")" + l_hash_dir_param.get_value<std::string>() + R"(" is not current directory, run from it to execute removals)"
+                                                                    ,__LINE__
+                                                                    ,__FILE__
+                                                                    );
+                }
+            }
+            std::unique_ptr<duplication_checker::hash_cache> l_hash_cache;
+            if(l_hash_cache_param.value_set())
+            {
+                l_hash_cache.reset(new duplication_checker::hash_cache(l_hash_cache_param.get_value<std::string>(), l_digest_type));
+            }
+            duplication_checker::hash_engine l_hash_engine(l_hash_dir_param.get_value<std::string>(), l_nb_threads, l_hash_cache.get(), l_digest_type);
+            l_hash_engine.run(l_input_dir + "/sorted_sha1sum.log");
+        }
+
+        // Convert log to binary index
+        if(l_make_index_param.value_set())
+        {
+            duplication_checker::binary_index::convert(l_input_dir + (l_unsorted ? "/sha1sum.log" : "/sorted_sha1sum.log"), l_make_index_param.get_value<std::string>());
+        }
+
+        // Write content of binary index in sorted sha1sum format
+        if(l_dump_index_param.value_set())
+        {
+            duplication_checker::binary_index l_index(l_dump_index_param.get_value<std::string>());
+            l_index.dump("index_dump.log");
+        }
+
+        // Apply removals in process instead of only generating clean_cmd.bash
+        std::unique_ptr<duplication_checker::removal_executor> l_removal_executor;
+        if(l_execute || l_dry_run)
+        {
+            l_removal_executor.reset(new duplication_checker::removal_executor(l_dry_run, l_journal, l_nb_threads, l_link_type));
+        }
+
+        // Times of phases and counters written in stats.json at the end
+        std::unique_ptr<duplication_checker::run_statistics> l_statistics;
+        if(l_stats)
+        {
+            l_statistics.reset(new duplication_checker::run_statistics(l_stats_period));
+        }
+
+        // Hits of rules accumulated across runs
+        std::unique_ptr<duplication_checker::rule_profile> l_profile;
+        if(l_rule_profile)
+        {
+            l_profile.reset(new duplication_checker::rule_profile(l_input_dir + "/rule_profile.log", "updated_rule_profile.log", l_prune_rules));
+        }
+
+        duplication_checker::duplication_checker l_checker(l_input_dir, l_interactive, l_unsorted, l_max_memory, l_nb_threads, l_removal_executor.get(), l_link_type, l_verify, l_index_param.value_set() ? l_index_param.get_value<std::string>() : "", l_config_snapshot_param.value_set() ? l_config_snapshot_param.get_value<std::string>() : "", l_statistics.get(), l_profile.get());
+
+#ifdef __linux__
+        if(l_watcher)
+        {
+            l_watcher->run([&](const std::string & p_sha1, const std::vector<std::string> & p_filenames)
+                           {
+                               l_checker.process_group(p_sha1, p_filenames);
+                           }
+                          );
+            // Watch ends on a signal, not once all files were seen
+            l_checker.finish(false);
+        }
+        else
+#endif // __linux__
+        {
+            l_checker.run();
+        }
+
+        if(l_statistics)
+        {
+            l_statistics->write("stats.json");
+        }
     }
     catch(const quicky_exception::quicky_logic_exception & e)
     {
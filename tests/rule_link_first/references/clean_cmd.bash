@@ -0,0 +1,13 @@
+#!/bin/bash
+
+# Rule : LINK_FIRST "dir1" "dir2"
+if [ ! -L dir2/toto.txt -a -f dir2/toto.txt ]
+then
+    ln -f dir2/toto.txt dir1/toto.txt.dc_tmp && mv -f dir1/toto.txt.dc_tmp dir1/toto.txt || rm -f dir1/toto.txt.dc_tmp
+elif [ -L dir2/toto.txt  ]
+then
+    echo "dir2/toto.txt" is a link
+else
+    echo "dir2/toto.txt" do not exist
+fi
+#EOF
@@ -0,0 +1,5 @@
+#!/bin/bash
+
+# Rule : RM_FIRST "dir1" "dir2"
+# Verification failed, "dir1/toto.txt" is kept : cannot be read : No such file or directory
+#EOF